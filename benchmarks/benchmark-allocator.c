@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "flag_decoder.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+/* Compares the allocation heavy paths of the SDK under the system allocator
+and the built in pool. Run with the argument "pool" to use the pool. */
+
+#define FLAG_COUNT 3000
+#define PUT_ITERATIONS 50
+#define EVALUATIONS 1000
+#define FLUSH_ITERATIONS 200
+/* the largest chunk curl hands to a write callback by default */
+#define CHUNK_SIZE 16384
+
+static char *
+buildPayload(size_t *const payloadSize)
+{
+    char * payload, *cursor;
+    size_t capacity, i;
+
+    capacity = (size_t)FLAG_COUNT * 512 + 4096;
+
+    LD_ASSERT(payload = (char *)LDAlloc(capacity));
+
+    cursor = payload;
+    cursor += sprintf(cursor, "{");
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        cursor += sprintf(
+            cursor,
+            "%s\"flag-%lu\":{\"value\":%s,\"version\":%lu,\"flagVersion\":%lu,"
+            "\"variation\":%lu,\"trackEvents\":true,\"reason\":{\"kind\":"
+            "\"RULE_MATCH\",\"ruleIndex\":%lu,\"ruleId\":\"rule-%lu\"}}",
+            i ? "," : "",
+            (unsigned long)i,
+            i % 2 ? "true" : "\"variation-text\"",
+            (unsigned long)(i + 100),
+            (unsigned long)(i + 7),
+            (unsigned long)(i % 3),
+            (unsigned long)(i % 5),
+            (unsigned long)i);
+    }
+
+    cursor += sprintf(cursor, "}");
+
+    *payloadSize = cursor - payload;
+
+    LD_ASSERT(*payloadSize < capacity);
+
+    return payload;
+}
+
+static void
+put(struct LDClient *const client, const char *const payload,
+    const size_t payloadSize)
+{
+    struct LDFlagDecoder decoder;
+    struct LDFlag *      flags;
+    unsigned int         flagCount;
+    size_t               offset;
+
+    LDi_flagDecoderInitialize(&decoder);
+
+    for (offset = 0; offset < payloadSize; offset += CHUNK_SIZE) {
+        size_t chunkSize = payloadSize - offset;
+
+        if (chunkSize > CHUNK_SIZE) {
+            chunkSize = CHUNK_SIZE;
+        }
+
+        LD_ASSERT(
+            LDi_flagDecoderProcess(&decoder, payload + offset, chunkSize));
+    }
+
+    LD_ASSERT(LDi_flagDecoderFinish(&decoder, &flags, &flagCount));
+
+    LDi_flagDecoderDestroy(&decoder);
+
+    LD_ASSERT(LDi_storePut(&client->store, flags, flagCount));
+}
+
+static size_t
+flush(struct LDClient *const client)
+{
+    struct LDJSON *payload;
+    char *         serialized, key[32];
+    size_t         i, size;
+
+    for (i = 0; i < EVALUATIONS; i++) {
+        sprintf(key, "flag-%lu", (unsigned long)(i % FLAG_COUNT));
+
+        if (i % 2) {
+            LDBoolVariation(client, key, LDBooleanFalse);
+        } else {
+            LDFree(LDStringVariationAlloc(client, key, "fallback"));
+        }
+    }
+
+    LD_ASSERT(LDi_bundleEventPayload(client->eventProcessor, &payload));
+    LD_ASSERT(serialized = LDJSONSerialize(payload));
+
+    size = strlen(serialized);
+
+    LDFree(serialized);
+    LDJSONFree(payload);
+
+    return size;
+}
+
+int
+main(int argc, char **argv)
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    char *           payload;
+    size_t           payloadSize, i;
+    double           start, finish;
+    const LDBoolean  pool = argc > 1 && strcmp(argv[1], "pool") == 0;
+
+    if (pool) {
+        LDSetPoolMemoryRoutines();
+    }
+
+    LDGlobalInit();
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetEventsCapacity(config, EVALUATIONS * 2);
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    payload = buildPayload(&payloadSize);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < PUT_ITERATIONS; i++) {
+        put(client, payload, payloadSize);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf(
+        "%s put of %d flags ns/put %f\n",
+        pool ? "pool" : "system",
+        FLAG_COUNT,
+        ((finish - start) * 1000000) / PUT_ITERATIONS);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < FLUSH_ITERATIONS; i++) {
+        LD_ASSERT(flush(client));
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    printf(
+        "%s flush of %d evaluations ns/flush %f\n",
+        pool ? "pool" : "system",
+        EVALUATIONS,
+        ((finish - start) * 1000000) / FLUSH_ITERATIONS);
+
+    LDClientClose(client);
+
+    LDFree(payload);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "ldinternal.h"
+#include "utility.h"
+
+/* Measures what an evaluation hook costs: evaluations before any hook is
+installed, with a hook that does nothing, and after it is removed, which is
+the state of a client that only checks for a hook. */
+
+#define EVALUATIONS 5000000
+
+static unsigned long hookCalls;
+
+static void
+emptyHook(const struct LDEvaluationHookData *const data, void *const context)
+{
+    (void)data;
+    (void)context;
+
+    hookCalls++;
+}
+
+static double
+evaluate(struct LDClient *const client)
+{
+    double       start, finish;
+    unsigned int i;
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < EVALUATIONS; i++) {
+        LD_ASSERT(LDBoolVariation(client, "flag", LDBooleanFalse));
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    return ((finish - start) * 1000000) / EVALUATIONS;
+}
+
+int
+main(void)
+{
+    struct LDConfig *config;
+    struct LDUser *  user;
+    struct LDClient *client;
+    struct LDFlag    flag;
+    double           none, installed, removed;
+
+    LD_ASSERT(config = LDConfigNew("key"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LD_ASSERT(user = LDUserNew("user"));
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    memset(&flag, 0, sizeof(flag));
+    LD_ASSERT(flag.key = LDStrDup("flag"));
+    LD_ASSERT(flag.value = LDNewBool(LDBooleanTrue));
+    flag.version     = 1;
+    flag.flagVersion = -1;
+    LD_ASSERT(LDi_storeUpsert(&client->store, flag));
+
+    /* warm up */
+    evaluate(client);
+
+    none = evaluate(client);
+
+    LD_ASSERT(LDClientSetEvaluationHook(client, emptyHook, NULL));
+    installed = evaluate(client);
+
+    LD_ASSERT(LDClientSetEvaluationHook(client, NULL, NULL));
+    removed = evaluate(client);
+
+    LD_ASSERT(hookCalls == EVALUATIONS);
+
+    printf("no hook ns/evaluation %f\n", none);
+    printf("empty hook ns/evaluation %f\n", installed);
+    printf("removed hook ns/evaluation %f\n", removed);
+
+    LDClientClose(client);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "flag_decoder.h"
+#include "store.h"
+#include "utility.h"
+
+#define FLAG_COUNT 3000
+#define ITERATIONS 100
+/* the largest chunk curl hands to a write callback by default */
+#define CHUNK_SIZE 16384
+
+/* builds a put payload for a large environment where values are objects */
+static char *
+buildPayload(size_t *const payloadSize)
+{
+    char * payload, *cursor;
+    size_t capacity, i;
+
+    capacity = (size_t)FLAG_COUNT * 512 + 4096;
+
+    LD_ASSERT(payload = (char *)LDAlloc(capacity));
+
+    cursor = payload;
+    cursor += sprintf(cursor, "{");
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        cursor += sprintf(
+            cursor,
+            "%s\"flag-%lu\":{\"value\":{\"name\":\"variation-%lu\","
+            "\"enabled\":true,\"weights\":[10,20,30,40],\"labels\":"
+            "{\"team\":\"core\",\"tier\":\"gold\"}},\"version\":%lu,"
+            "\"flagVersion\":%lu,\"variation\":%lu,\"trackEvents\":false}",
+            i ? "," : "",
+            (unsigned long)i,
+            (unsigned long)(i % 3),
+            (unsigned long)(i + 100),
+            (unsigned long)(i + 7),
+            (unsigned long)(i % 3));
+    }
+
+    cursor += sprintf(cursor, "}");
+
+    *payloadSize = cursor - payload;
+
+    LD_ASSERT(*payloadSize < capacity);
+
+    return payload;
+}
+
+int
+main()
+{
+    struct LDStore store;
+    char *         payload;
+    size_t         payloadSize, offset, i;
+    double         start, finish, nanoseconds, megabytes;
+
+    LDGlobalInit();
+
+    payload = buildPayload(&payloadSize);
+
+    LD_ASSERT(LDi_storeInitialize(&store));
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        struct LDFlagDecoder decoder;
+        struct LDFlag *      flags;
+        unsigned int         flagCount;
+
+        LDi_flagDecoderInitialize(&decoder);
+
+        for (offset = 0; offset < payloadSize; offset += CHUNK_SIZE) {
+            size_t chunkSize = payloadSize - offset;
+
+            if (chunkSize > CHUNK_SIZE) {
+                chunkSize = CHUNK_SIZE;
+            }
+
+            LD_ASSERT(
+                LDi_flagDecoderProcess(&decoder, payload + offset, chunkSize));
+        }
+
+        LD_ASSERT(LDi_flagDecoderFinish(&decoder, &flags, &flagCount));
+        LD_ASSERT(flagCount == FLAG_COUNT);
+
+        LDi_flagDecoderDestroy(&decoder);
+
+        LD_ASSERT(LDi_storePut(&store, flags, flagCount));
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    nanoseconds = ((finish - start) * 1000000) / ITERATIONS;
+    megabytes   = ((double)payloadSize * ITERATIONS) / (1024 * 1024);
+    start /= 1000;
+    finish /= 1000;
+
+    printf(
+        "payload bytes %lu duration seconds %f ns/put %f MB/s %f\n",
+        (unsigned long)payloadSize,
+        finish - start,
+        nanoseconds,
+        megabytes / (finish - start));
+
+    LDi_storeDestroy(&store);
+
+    LDFree(payload);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "utility.h"
+
+#define EVENT_COUNT 1000
+#define ITERATIONS 200
+
+/* builds a batch shaped like a flush of feature and summary events, which is
+dominated by numbers and short strings */
+static struct LDJSON *
+buildBatch(void)
+{
+    struct LDJSON *batch;
+    unsigned int   i;
+
+    LD_ASSERT(batch = LDNewArray());
+
+    for (i = 0; i < EVENT_COUNT; i++) {
+        struct LDJSON *event, *value;
+        char           key[32];
+
+        sprintf(key, "flag-%u", i);
+
+        LD_ASSERT(event = LDNewObject());
+        LD_ASSERT(LDObjectSetKey(event, "kind", LDNewText("feature")));
+        LD_ASSERT(LDObjectSetKey(
+            event, "creationDate", LDNewNumber(1600000000000.0 + i)));
+        LD_ASSERT(LDObjectSetKey(event, "key", LDNewText(key)));
+        LD_ASSERT(LDObjectSetKey(event, "userKey", LDNewText("user-key")));
+        LD_ASSERT(LDObjectSetKey(event, "version", LDNewNumber(i + 100)));
+        LD_ASSERT(LDObjectSetKey(event, "variation", LDNewNumber(i % 3)));
+
+        LD_ASSERT(value = LDNewObject());
+        LD_ASSERT(LDObjectSetKey(value, "ratio", LDNewNumber(i / 7.0)));
+        LD_ASSERT(LDObjectSetKey(value, "scale", LDNewNumber(i * 0.25)));
+        LD_ASSERT(LDObjectSetKey(event, "value", value));
+        LD_ASSERT(LDObjectSetKey(event, "default", LDNewNumber(-1.5)));
+
+        LD_ASSERT(LDArrayPush(batch, event));
+    }
+
+    return batch;
+}
+
+int
+main()
+{
+    struct LDJSON *batch;
+    char *         serialized;
+    size_t         serializedSize, i;
+    double         start, finish, nanoseconds, megabytes;
+
+    LDGlobalInit();
+
+    batch = buildBatch();
+
+    LD_ASSERT(serialized = LDJSONSerialize(batch));
+    serializedSize = strlen(serialized);
+    LDFree(serialized);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(serialized = LDJSONSerialize(batch));
+        LDFree(serialized);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    nanoseconds = ((finish - start) * 1000000) / ITERATIONS;
+    megabytes   = ((double)serializedSize * ITERATIONS) / (1024 * 1024);
+    start /= 1000;
+    finish /= 1000;
+
+    printf(
+        "batch bytes %lu duration seconds %f ns/batch %f MB/s %f\n",
+        (unsigned long)serializedSize,
+        finish - start,
+        nanoseconds,
+        megabytes / (finish - start));
+
+    LDJSONFree(batch);
+
+    return 0;
+}
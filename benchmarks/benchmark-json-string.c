@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "utility.h"
+
+#define ENTRY_COUNT 2000
+#define ITERATIONS 100
+
+/* builds a document dominated by long strings, like flag values holding
+configuration text and users with long custom attributes */
+static char *
+buildDocument(size_t *const documentSize)
+{
+    char * document, *cursor;
+    size_t capacity, i;
+
+    capacity = (size_t)ENTRY_COUNT * 512 + 16;
+
+    LD_ASSERT(document = (char *)LDAlloc(capacity));
+
+    cursor = document;
+    cursor += sprintf(cursor, "[");
+
+    for (i = 0; i < ENTRY_COUNT; i++) {
+        cursor += sprintf(
+            cursor,
+            "%s{\"key\":\"user-key-%lu-0123456789abcdef\","
+            "\"description\":\"A moderately long description of entry %lu, "
+            "the kind of free text that appears in flag values and custom "
+            "attributes, with a single escaped \\\"quote\\\" near the end.\","
+            "\"config\":\"https://example.com/some/long/path/segment/%lu"
+            "?query=value&other=another-value-that-goes-on\"}",
+            i ? "," : "",
+            (unsigned long)i,
+            (unsigned long)i,
+            (unsigned long)i);
+    }
+
+    cursor += sprintf(cursor, "]");
+
+    *documentSize = cursor - document;
+
+    LD_ASSERT(*documentSize < capacity);
+
+    return document;
+}
+
+int
+main()
+{
+    struct LDJSON *json;
+    char *         document, *serialized;
+    size_t         documentSize, i;
+    double         start, parsed, printed, megabytes;
+
+    LDGlobalInit();
+
+    document = buildDocument(&documentSize);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(json = LDJSONDeserialize(document));
+        LDJSONFree(json);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&parsed));
+
+    LD_ASSERT(json = LDJSONDeserialize(document));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        LD_ASSERT(serialized = LDJSONSerialize(json));
+        LDFree(serialized);
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&printed));
+
+    megabytes = ((double)documentSize * ITERATIONS) / (1024 * 1024);
+
+    printf(
+        "document bytes %lu parse MB/s %f serialize MB/s %f\n",
+        (unsigned long)documentSize,
+        megabytes / ((parsed - start) / 1000),
+        megabytes / ((printed - parsed) / 1000));
+
+    LDJSONFree(json);
+    LDFree(document);
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "assertion.h"
+#include "sse.h"
+#include "utility.h"
+
+#define FLAG_COUNT 2000
+#define ITERATIONS 200
+/* the largest chunk curl hands to a write callback by default */
+#define CHUNK_SIZE 16384
+
+static size_t dispatchedBytes;
+
+static LDBoolean
+countDispatch(
+    const char *const name,
+    const size_t      nameSize,
+    const char *const body,
+    const size_t      bodySize,
+    void *const       context)
+{
+    LD_ASSERT(name);
+    LD_ASSERT(nameSize);
+    LD_ASSERT(body);
+    LD_ASSERT(context == NULL);
+
+    dispatchedBytes += bodySize;
+
+    return LDBooleanTrue;
+}
+
+/* builds a stream shaped like a captured put for a large environment, with a
+trailing patch using CRLF line endings */
+static char *
+buildStream(size_t *const streamSize)
+{
+    char * stream, *cursor;
+    size_t capacity, i;
+
+    capacity = (size_t)FLAG_COUNT * 512 + 4096;
+
+    LD_ASSERT(stream = (char *)LDAlloc(capacity));
+
+    cursor = stream;
+    cursor += sprintf(cursor, ":heartbeat\nevent: put\ndata: {");
+
+    for (i = 0; i < FLAG_COUNT; i++) {
+        cursor += sprintf(
+            cursor,
+            "%s\"flag-%lu\":{\"value\":{\"name\":\"variation-%lu\","
+            "\"enabled\":true,\"weights\":[10,20,30,40]},\"version\":%lu,"
+            "\"flagVersion\":%lu,\"variation\":%lu,\"trackEvents\":false,"
+            "\"reason\":{\"kind\":\"RULE_MATCH\",\"ruleIndex\":%lu,"
+            "\"ruleId\":\"rule-%lu\"},\"debugEventsUntilDate\":1600000000000}",
+            i ? "," : "",
+            (unsigned long)i,
+            (unsigned long)(i % 3),
+            (unsigned long)(i + 100),
+            (unsigned long)(i + 7),
+            (unsigned long)(i % 3),
+            (unsigned long)(i % 5),
+            (unsigned long)i);
+    }
+
+    cursor += sprintf(
+        cursor,
+        "}\n\nevent: patch\r\ndata: {\"key\":\"flag-1\",\"value\":false,"
+        "\"version\":5000}\r\n\r\n");
+
+    *streamSize = cursor - stream;
+
+    LD_ASSERT(*streamSize < capacity);
+
+    return stream;
+}
+
+int
+main()
+{
+    struct LDSSEParser parser;
+    char *             stream;
+    size_t             streamSize, offset, i;
+    double             start, finish, nanoseconds, megabytes;
+
+    LDGlobalInit();
+
+    stream = buildStream(&streamSize);
+
+    LDSSEParserInitialize(&parser, countDispatch, NULL);
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&start));
+
+    for (i = 0; i < ITERATIONS; i++) {
+        for (offset = 0; offset < streamSize; offset += CHUNK_SIZE) {
+            size_t chunkSize = streamSize - offset;
+
+            if (chunkSize > CHUNK_SIZE) {
+                chunkSize = CHUNK_SIZE;
+            }
+
+            LD_ASSERT(LDSSEParserProcess(&parser, stream + offset, chunkSize));
+        }
+    }
+
+    LD_ASSERT(LDi_getMonotonicMilliseconds(&finish));
+
+    LD_ASSERT(dispatchedBytes > streamSize * ITERATIONS / 2);
+
+    nanoseconds = ((finish - start) * 1000000) / ITERATIONS;
+    megabytes   = ((double)streamSize * ITERATIONS) / (1024 * 1024);
+    start /= 1000;
+    finish /= 1000;
+
+    printf(
+        "stream bytes %lu duration seconds %f ns/stream %f MB/s %f\n",
+        (unsigned long)streamSize,
+        finish - start,
+        nanoseconds,
+        megabytes / (finish - start));
+
+    LDSSEParserDestroy(&parser);
+
+    LDFree(stream);
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*!
+ * @file buffer.h
+ * @brief Public API Interface for growable text buffers
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+#include <launchdarkly/export.h>
+
+/**
+ * @struct LDBuffer
+ * @brief An opaque growable text buffer. Clearing a buffer keeps its
+ * capacity, so a buffer reused for similar content stops allocating.
+ */
+struct LDBuffer;
+
+/**
+ * @brief Allocate a new empty buffer.
+ * @return `NULL` on failure.
+ */
+LD_EXPORT(struct LDBuffer *) LDBufferNew(void);
+
+/**
+ * @brief Destroy a buffer and its contents.
+ * @param[in] buffer The buffer to free. May be `NULL`.
+ * @return Void.
+ */
+LD_EXPORT(void) LDBufferFree(struct LDBuffer *const buffer);
+
+/**
+ * @brief Empty a buffer while keeping its capacity for reuse.
+ * @param[in] buffer The buffer to clear. May not be `NULL`.
+ * @return Void.
+ */
+LD_EXPORT(void) LDBufferClear(struct LDBuffer *const buffer);
+
+/**
+ * @brief Ensure the buffer can hold additional bytes without reallocating.
+ * @param[in] buffer The buffer to grow. May not be `NULL`.
+ * @param[in] additional The number of bytes beyond the current size.
+ * @return True on success, the contents are unchanged on failure.
+ */
+LD_EXPORT(LDBoolean)
+LDBufferReserve(struct LDBuffer *const buffer, const size_t additional);
+
+/**
+ * @brief Append bytes to the end of the buffer.
+ * @param[in] buffer The buffer to append to. May not be `NULL`.
+ * @param[in] data The bytes to copy. May not be `NULL`.
+ * @param[in] dataSize The number of bytes to copy.
+ * @return True on success, the contents are unchanged on failure.
+ */
+LD_EXPORT(LDBoolean)
+LDBufferAppend(
+    struct LDBuffer *const buffer, const char *const data, const size_t dataSize);
+
+/**
+ * @brief Access the contents of the buffer.
+ * @param[in] buffer The buffer to read. May not be `NULL`.
+ * @return The null terminated contents, never `NULL`. The pointer is valid
+ * until the buffer is next modified or freed.
+ */
+LD_EXPORT(const char *) LDBufferData(const struct LDBuffer *const buffer);
+
+/**
+ * @brief Determine the length of the contents of the buffer.
+ * @param[in] buffer The buffer to measure. May not be `NULL`.
+ * @return The length excluding the null terminator.
+ */
+LD_EXPORT(size_t) LDBufferSize(const struct LDBuffer *const buffer);
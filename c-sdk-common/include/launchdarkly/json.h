@@ -6,6 +6,7 @@
 #pragma once
 
 #include <launchdarkly/boolean.h>
+#include <launchdarkly/buffer.h>
 #include <launchdarkly/export.h>
 
 /* **** Forward Declarations **** */
@@ -108,12 +109,28 @@ LDSetNumber(struct LDJSON *const node, const double number);
 LD_EXPORT(void) LDJSONFree(struct LDJSON *const json);
 
 /**
- * @brief Duplicates an existing JSON strucutre. This acts as a deep copy.
+ * @brief Duplicates an existing JSON strucutre. This acts as a deep copy, the
+ * result and every value nested in it may be modified, even when duplicating
+ * a structure frozen with `LDJSONFreeze`.
  * @param[in] json JSON to be duplicated. May not be `NULL`.
  * @return `NULL` on failure
  */
 LD_EXPORT(struct LDJSON *) LDJSONDuplicate(const struct LDJSON *const json);
 
+/**
+ * @brief Makes the contents of a JSON structure immutable and reference
+ * counted, so the SDK can share them between its internal copies in constant
+ * time. The structure may still be modified and freed like any other, the
+ * first modification gives it a private copy. Values nested inside a frozen
+ * structure, such as those returned by `LDObjectLookup`, may be read and
+ * duplicated but never modified or inserted into another structure.
+ * `LDJSONDuplicate` always makes a modifiable deep copy.
+ * @param[in] json Structure to freeze. May not be `NULL`. Structures from
+ * `LDJSONDeserializeArena` cannot be frozen.
+ * @return True on success, the structure is unchanged on failure.
+ */
+LD_EXPORT(LDBoolean) LDJSONFreeze(struct LDJSON *const json);
+
 /**
  * @brief Get the type of a JSON structure
  * @param[in] json May be not be `NULL`.
@@ -327,6 +344,19 @@ LDObjectMerge(struct LDJSON *const to, const struct LDJSON *const from);
  */
 LD_EXPORT(char *) LDJSONSerialize(const struct LDJSON *const json);
 
+/**
+ * @brief Serialize JSON structure into JSON text appended to a buffer.
+ * The buffer is grown once from an estimate of the output size, and keeps its
+ * capacity when cleared, so a buffer reused across serializations of similar
+ * structures usually does not allocate at all.
+ * @param[in] json Structure to serialize. May not be `NULL`.
+ * @param[in] buffer Buffer to append the text to. May not be `NULL`.
+ * @return True on success, the contents of `buffer` are unchanged on failure.
+ */
+LD_EXPORT(LDBoolean)
+LDJSONSerializeTo(
+    const struct LDJSON *const json, struct LDBuffer *const buffer);
+
 /**
  * @brief Deserialize JSON text into a JSON structure.
  * @param[in] text JSON text to deserialize. May not be `NULL`.
@@ -334,4 +364,17 @@ LD_EXPORT(char *) LDJSONSerialize(const struct LDJSON *const json);
  */
 LD_EXPORT(struct LDJSON *) LDJSONDeserialize(const char *const text);
 
+/**
+ * @brief Deserialize JSON text into a JSON structure allocated from an arena.
+ * Every node and string of the result is carved out of a few large blocks, so
+ * parsing and freeing is much cheaper than with `LDJSONDeserialize`. Intended
+ * for short lived documents that are inspected and then freed.
+ * @param[in] text JSON text to deserialize. May not be `NULL`.
+ * @return JSON structure on success, `NULL` on failure. Free it with
+ * `LDJSONFree`, which releases the whole arena. Values in the structure, even
+ * detached ones, may not be used after it is freed. Use `LDJSONDuplicate` to
+ * keep a value longer.
+ */
+LD_EXPORT(struct LDJSON *) LDJSONDeserializeArena(const char *const text);
+
 /*@}*/
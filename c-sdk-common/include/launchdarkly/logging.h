@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <launchdarkly/boolean.h>
 #include <launchdarkly/export.h>
 
 /** @brief The log levels compatible with the logging interface */
@@ -22,6 +23,39 @@ typedef enum
 /** @brief Internal: Used for the non macro portion */
 LD_EXPORT(void) LDi_log(const LDLogLevel level, const char *const format, ...);
 
+/**
+ * @brief Internal: The most verbose level passed to the logger, or -1 when
+ * there is no logger. Read by the logging macros so that filtered messages
+ * are not formatted.
+ */
+extern LD_EXPORT(int) LDi_logThreshold;
+
+/** @brief Internal: Function form of the check against `LDi_logThreshold` */
+LD_EXPORT(LDBoolean) LDi_logEnabled(const LDLogLevel level);
+
+/**
+ * @brief The most verbose level the logging macros are compiled for.
+ * Define it as a `LDLogLevel` when building the SDK, for example as
+ * `LD_LOG_INFO`, and the compiler removes more verbose log calls entirely.
+ * By default every level is compiled in.
+ */
+#ifndef LD_LOG_MIN_LEVEL
+#define LD_LOG_MIN_LEVEL LD_LOG_TRACE
+#endif
+
+/**
+ * @brief Internal: True if a message at level would be logged. Constant false
+ * for levels above `LD_LOG_MIN_LEVEL`.
+ */
+#ifdef _WIN32
+/* data can not be imported from a DLL through a dllexport declaration */
+#define LD_LOG_ENABLED(level)                                                  \
+    ((level) <= LD_LOG_MIN_LEVEL && LDi_logEnabled(level))
+#else
+#define LD_LOG_ENABLED(level)                                                  \
+    ((level) <= LD_LOG_MIN_LEVEL && (int)(level) <= LDi_logThreshold)
+#endif
+
 /**
  * @brief A provided logger that can be used as a convenient default.
  * @deprecated This is deprecated in favor of `LDBasicLoggerThreadSafe`.
@@ -49,6 +83,44 @@ LDBasicLoggerThreadSafe(const LDLogLevel level, const char *const text);
  */
 LD_EXPORT(void) LDBasicLoggerThreadSafeShutdown(void);
 
+/**
+ * @brief Setup routine for `LDAsyncLogger`.
+ * Starts a background thread that passes each record queued by
+ * `LDAsyncLogger` to output, in order. Call this before `LDAsyncLogger` is
+ * used.
+ * @param[in] output The logger that writes records, called only from the
+ * background thread. `LDBasicLogger` is used if `NULL`.
+ * @return True on success, False if the thread could not be started or the
+ * logger is already initialized.
+ */
+LD_EXPORT(LDBoolean)
+LDAsyncLoggerInitialize(
+    void (*const output)(const LDLogLevel level, const char *const text));
+
+/**
+ * @brief A provided logger that never waits on output.
+ * Copies each message, truncated to 511 bytes, into a bounded queue drained
+ * by the thread started with `LDAsyncLoggerInitialize`. A message is dropped
+ * if the queue is full, or if the same message was already accepted ten
+ * times in the current second. The writer reports how many messages it lost
+ * between records it writes.
+ */
+LD_EXPORT(void) LDAsyncLogger(const LDLogLevel level, const char *const text);
+
+/**
+ * @brief Shutdown routine for `LDAsyncLogger`.
+ * Writes every queued message and stops the background thread. Call this
+ * when `LDAsyncLogger` is no longer used, after all LaunchDarkly resources
+ * are destroyed.
+ */
+LD_EXPORT(void) LDAsyncLoggerShutdown(void);
+
+/**
+ * @brief The number of messages `LDAsyncLogger` did not write because the
+ * queue was full or they repeated too often, since it was initialized.
+ */
+LD_EXPORT(unsigned long) LDAsyncLoggerDropped(void);
+
 /**
  * @brief Set the logger, and the log level to use. This routine should only be
  * used before any other LD routine. After any other routine has been used
@@ -63,9 +135,14 @@ LDConfigureGlobalLogger(
     const LDLogLevel level,
     void (*logger)(const LDLogLevel level, const char *const text));
 
-/** @brief A macro interface that allows convenient logging of line numbers */
+/**
+ * @brief A macro interface that allows convenient logging of line numbers.
+ * The text is not evaluated unless the message will be logged.
+ */
 #define LD_LOG(level, text)                                                    \
-    LDi_log(level, "[%s, %d] %s", __FILE__, __LINE__, text)
+    (LD_LOG_ENABLED(level)                                                     \
+         ? LDi_log(level, "[%s, %d] %s", __FILE__, __LINE__, text)             \
+         : (void)0)
 
 /**
  * @brief Convert a verbosity level Enum value to an equivalent static string.
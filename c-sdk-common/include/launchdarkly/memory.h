@@ -32,5 +32,31 @@ LDSetMemoryRoutines(
     void *(*const newCalloc)(const size_t, const size_t),
     char *(*const newStrNDup)(const char *const, const size_t));
 
+/** @brief Built in allocator equivalent to `malloc`, see
+ * LDSetPoolMemoryRoutines */
+LD_EXPORT(void *) LDPoolAlloc(const size_t bytes);
+/** @brief Built in allocator equivalent to `free`, only for blocks from the
+ * built in allocator */
+LD_EXPORT(void) LDPoolFree(void *const buffer);
+/** @brief Built in allocator equivalent to `realloc` */
+LD_EXPORT(void *) LDPoolRealloc(void *const buffer, const size_t bytes);
+/** @brief Built in allocator equivalent to `calloc` */
+LD_EXPORT(void *) LDPoolCalloc(const size_t nmemb, const size_t size);
+/** @brief Built in allocator equivalent to `strdup` */
+LD_EXPORT(char *) LDPoolStrDup(const char *const string);
+/** @brief Built in allocator equivalent to `strndup` */
+LD_EXPORT(char *) LDPoolStrNDup(const char *const str, const size_t n);
+
+/**
+ * @brief Use the built in allocator for all memory used by the SDK.
+ *
+ * Small blocks are served from size classes cached per thread, which is
+ * faster than most system allocators for the many small JSON nodes and
+ * strings the SDK allocates. Memory for small blocks is kept for reuse rather
+ * than returned to the system. Like LDSetMemoryRoutines this must be called
+ * before LDGlobalInit or any other allocation by the SDK.
+ */
+LD_EXPORT(void) LDSetPoolMemoryRoutines(void);
+
 /** @brief Must be called once before any other API function */
 LD_EXPORT(void) LDGlobalInit(void);
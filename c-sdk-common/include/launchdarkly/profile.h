@@ -0,0 +1,20 @@
+/*!
+ * @file profile.h
+ * @brief Public API. Diagnostics for builds with profiling enabled.
+ */
+
+#pragma once
+
+#include <launchdarkly/export.h>
+
+/** @brief Describe the most contended locks of the SDK, one per line.
+ *
+ * Only available when the SDK is built with the `LOCK_PROFILING` CMake
+ * option, otherwise returns `NULL`. Locks are ordered by the total time
+ * threads waited to acquire them. Each line gives the label of the lock,
+ * acquisitions, contended acquisitions, the total and maximum wait, and the
+ * total and maximum hold time in microseconds. Hold times cover exclusive
+ * acquisitions only. At most `limit` locks are described.
+ *
+ * The result must be freed with `LDFree`. */
+LD_EXPORT(char *) LDLockProfileReport(const unsigned int limit);
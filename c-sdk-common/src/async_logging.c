@@ -0,0 +1,368 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/logging.h>
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "atomic.h"
+#include "concurrency.h"
+#include "utility.h"
+
+/* Logger that hands records to a background writer, so that a thread logging
+under a lock never waits on output or on other logging threads. Records are
+copied into a bounded ring of preallocated slots, the bounded MPMC queue
+described by Dmitry Vyukov, where each slot carries a sequence number telling
+producers and the consumer whose turn it is. A full ring drops the record.
+Identical messages beyond a burst per second are suppressed before they reach
+the ring, so a failure logged in a loop cannot crowd out everything else. */
+
+/* a power of two */
+#define LD_ASYNC_LOG_CAPACITY 256
+/* longer messages are truncated */
+#define LD_ASYNC_LOG_TEXT_SIZE 512
+/* a power of two */
+#define LD_ASYNC_LOG_LIMIT_SLOTS 64
+/* identical messages accepted per second */
+#define LD_ASYNC_LOG_BURST 10
+/* longest the writer sleeps before checking for a record it was not woken
+for */
+#define LD_ASYNC_LOG_IDLE_MILLISECONDS 100
+
+struct LDAsyncLogRecord
+{
+    /* equal to the position of the slot when it is free for a producer at
+    that position, one past it when it holds a record for the consumer */
+    ld_atomic_t sequence;
+    LDLogLevel  level;
+    char        text[LD_ASYNC_LOG_TEXT_SIZE];
+};
+
+/* a message recently accepted, updated without a lock so the limit is
+approximate when threads log at once */
+struct LDAsyncLogLimit
+{
+    ld_atomic_t hash;
+    ld_atomic_t second;
+    ld_atomic_t count;
+};
+
+static struct LDAsyncLogRecord *ring;
+static ld_atomic_t              enqueuePosition;
+/* only touched by the writer */
+static unsigned long dequeuePosition;
+
+static struct LDAsyncLogLimit limits[LD_ASYNC_LOG_LIMIT_SLOTS];
+
+static ld_atomic_t dropped;
+static ld_atomic_t suppressed;
+
+static void (*writer)(const LDLogLevel level, const char *const text);
+static ld_thread_t writerThread;
+static ld_mutex_t  writerLock;
+static ld_cond_t   writerCondition;
+static ld_atomic_t writerSleeping;
+static ld_atomic_t writerStopping;
+
+/* set on threads that must not enqueue: the writer, and a producer already
+inside the logger, which concurrency tracing would otherwise recurse into */
+static LD_THREAD_LOCAL int insideLogger;
+
+static long
+LDi_asyncLogHash(const char *text)
+{
+    unsigned long hash;
+
+    /* FNV-1a */
+    for (hash = 2166136261UL; *text; text++) {
+        hash = (hash ^ (unsigned char)*text) * 16777619UL;
+    }
+
+    /* zero marks an unused slot */
+    return (long)(hash & 0x7FFFFFFFUL) | 1;
+}
+
+static LDBoolean
+LDi_asyncLogAllowed(const char *const text)
+{
+    struct LDAsyncLogLimit *limit;
+    long                    hash, second;
+
+    hash   = LDi_asyncLogHash(text);
+    second = (long)(LDi_getMonotonicNanoseconds() / 1000000000.0);
+    limit  = &limits[hash & (LD_ASYNC_LOG_LIMIT_SLOTS - 1)];
+
+    if (LDi_atomicLoad(&limit->hash) != hash ||
+        LDi_atomicLoad(&limit->second) != second)
+    {
+        LDi_atomicStore(&limit->count, 1);
+        LDi_atomicStore(&limit->second, second);
+        LDi_atomicStore(&limit->hash, hash);
+
+        return LDBooleanTrue;
+    }
+
+    return LDi_atomicIncrement(&limit->count) <= LD_ASYNC_LOG_BURST;
+}
+
+/* claims the slot at the next position, NULL if the ring is full */
+static struct LDAsyncLogRecord *
+LDi_asyncLogClaim(long *const position)
+{
+    struct LDAsyncLogRecord *record;
+    long                     current, difference;
+
+    current = LDi_atomicLoad(&enqueuePosition);
+
+    for (;;) {
+        record = &ring[(unsigned long)current & (LD_ASYNC_LOG_CAPACITY - 1)];
+
+        difference = (long)((unsigned long)LDi_atomicLoad(&record->sequence) -
+                            (unsigned long)current);
+
+        if (difference == 0) {
+            if (LDi_atomicCompareExchange(
+                    &enqueuePosition, current, (long)((unsigned long)current + 1)))
+            {
+                *position = current;
+
+                return record;
+            }
+        } else if (difference < 0) {
+            /* the consumer has not freed the slot from a lap ago */
+            return NULL;
+        }
+
+        /* another producer took the position */
+        current = LDi_atomicLoad(&enqueuePosition);
+    }
+}
+
+/* the record at the front of the ring, NULL if it is empty */
+static struct LDAsyncLogRecord *
+LDi_asyncLogFront(void)
+{
+    struct LDAsyncLogRecord *const record =
+        &ring[dequeuePosition & (LD_ASYNC_LOG_CAPACITY - 1)];
+
+    if ((unsigned long)LDi_atomicLoad(&record->sequence) !=
+        dequeuePosition + 1)
+    {
+        return NULL;
+    }
+
+    return record;
+}
+
+static void
+LDi_asyncLogRelease(struct LDAsyncLogRecord *const record)
+{
+    LDi_atomicStore(
+        &record->sequence, (long)(dequeuePosition + LD_ASYNC_LOG_CAPACITY));
+
+    dequeuePosition++;
+}
+
+/* writes every queued record, then a note of any lost since the last note */
+static void
+LDi_asyncLogDrain(
+    unsigned long *const reportedDropped,
+    unsigned long *const reportedSuppressed)
+{
+    struct LDAsyncLogRecord *record;
+    unsigned long            droppedNow, suppressedNow;
+
+    while ((record = LDi_asyncLogFront())) {
+        writer(record->level, record->text);
+
+        LDi_asyncLogRelease(record);
+    }
+
+    droppedNow    = (unsigned long)LDi_atomicLoad(&dropped);
+    suppressedNow = (unsigned long)LDi_atomicLoad(&suppressed);
+
+    if (droppedNow != *reportedDropped ||
+        suppressedNow != *reportedSuppressed)
+    {
+        char note[128];
+
+        snprintf(
+            note,
+            sizeof(note),
+            "async logger: %lu messages dropped, %lu repeated messages "
+            "suppressed",
+            droppedNow - *reportedDropped,
+            suppressedNow - *reportedSuppressed);
+
+        writer(LD_LOG_WARNING, note);
+
+        *reportedDropped    = droppedNow;
+        *reportedSuppressed = suppressedNow;
+    }
+}
+
+static THREAD_RETURN
+LDi_asyncLogWriter(void *const argument)
+{
+    unsigned long reportedDropped, reportedSuppressed;
+
+    (void)argument;
+
+    insideLogger       = 1;
+    reportedDropped    = 0;
+    reportedSuppressed = 0;
+
+    while (!LDi_atomicLoad(&writerStopping)) {
+        LDi_asyncLogDrain(&reportedDropped, &reportedSuppressed);
+
+        LDi_mutex_nl_lock(&writerLock);
+
+        LDi_atomicStore(&writerSleeping, 1);
+
+        /* a producer that published before seeing the flag did not signal */
+        if (!LDi_asyncLogFront() && !LDi_atomicLoad(&writerStopping)) {
+            LDi_cond_wait(
+                &writerCondition, &writerLock, LD_ASYNC_LOG_IDLE_MILLISECONDS);
+        }
+
+        LDi_atomicStore(&writerSleeping, 0);
+
+        LDi_mutex_nl_unlock(&writerLock);
+    }
+
+    LDi_asyncLogDrain(&reportedDropped, &reportedSuppressed);
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+LDBoolean
+LDAsyncLoggerInitialize(
+    void (*const output)(const LDLogLevel level, const char *const text))
+{
+    unsigned int i;
+
+    LD_ASSERT_API(!ring);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (ring) {
+        return LDBooleanFalse;
+    }
+#endif
+
+    if (!(ring = (struct LDAsyncLogRecord *)LDAlloc(
+              sizeof(struct LDAsyncLogRecord) * LD_ASYNC_LOG_CAPACITY)))
+    {
+        return LDBooleanFalse;
+    }
+
+    for (i = 0; i < LD_ASYNC_LOG_CAPACITY; i++) {
+        ring[i].sequence = (long)i;
+    }
+
+    memset(limits, 0, sizeof(limits));
+
+    enqueuePosition = 0;
+    dequeuePosition = 0;
+    dropped         = 0;
+    suppressed      = 0;
+    writerSleeping  = 0;
+    writerStopping  = 0;
+    writer          = output ? output : LDBasicLogger;
+
+    LDi_mutex_nl_init(&writerLock);
+    LDi_cond_init(&writerCondition);
+
+    insideLogger = 1;
+
+    if (!LDi_thread_create(&writerThread, LDi_asyncLogWriter, NULL)) {
+        insideLogger = 0;
+
+        LDi_cond_destroy(&writerCondition);
+        LDi_mutex_nl_destroy(&writerLock);
+
+        LDFree(ring);
+        ring = NULL;
+
+        return LDBooleanFalse;
+    }
+
+    insideLogger = 0;
+
+    return LDBooleanTrue;
+}
+
+void
+LDAsyncLogger(const LDLogLevel level, const char *const text)
+{
+    struct LDAsyncLogRecord *record;
+    long                     position;
+    size_t                   length;
+
+    if (!text || !ring || insideLogger) {
+        return;
+    }
+
+    insideLogger = 1;
+
+    if (!LDi_asyncLogAllowed(text)) {
+        LDi_atomicIncrement(&suppressed);
+
+        goto done;
+    }
+
+    if (!(record = LDi_asyncLogClaim(&position))) {
+        LDi_atomicIncrement(&dropped);
+
+        goto done;
+    }
+
+    if ((length = strlen(text)) >= LD_ASYNC_LOG_TEXT_SIZE) {
+        length = LD_ASYNC_LOG_TEXT_SIZE - 1;
+    }
+
+    memcpy(record->text, text, length);
+    record->text[length] = '\0';
+    record->level        = level;
+
+    LDi_atomicStore(&record->sequence, (long)((unsigned long)position + 1));
+
+    if (LDi_atomicLoad(&writerSleeping)) {
+        LDi_cond_signal(&writerCondition);
+    }
+
+done:
+    insideLogger = 0;
+}
+
+void
+LDAsyncLoggerShutdown(void)
+{
+    if (!ring) {
+        return;
+    }
+
+    insideLogger = 1;
+
+    LDi_atomicStore(&writerStopping, 1);
+
+    LDi_mutex_nl_lock(&writerLock);
+    LDi_cond_signal(&writerCondition);
+    LDi_mutex_nl_unlock(&writerLock);
+
+    LDi_thread_join(&writerThread);
+
+    LDi_cond_destroy(&writerCondition);
+    LDi_mutex_nl_destroy(&writerLock);
+
+    insideLogger = 0;
+
+    LDFree(ring);
+    ring = NULL;
+}
+
+unsigned long
+LDAsyncLoggerDropped(void)
+{
+    return (unsigned long)LDi_atomicLoad(&dropped) +
+           (unsigned long)LDi_atomicLoad(&suppressed);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Lock free integer operations for counters touched on hot paths, where a
+mutex per counter would cost more than the work it protects. Every operation
+is a full barrier unless noted, so they may also publish other writes. */
+
+#ifdef _WIN32
+#include <windows.h>
+
+typedef LONG volatile ld_atomic_t;
+
+/* these return the new value */
+#define LDi_atomicIncrement(value) InterlockedIncrement(value)
+#define LDi_atomicDecrement(value) InterlockedDecrement(value)
+#define LDi_atomicAdd(value, amount)                                           \
+    (InterlockedExchangeAdd(value, amount) + (amount))
+#define LDi_atomicLoad(value) InterlockedCompareExchange(value, 0, 0)
+#define LDi_atomicStore(value, desired) InterlockedExchange(value, desired)
+
+/* true if value held expected and now holds desired */
+#define LDi_atomicCompareExchange(value, expected, desired)                    \
+    (InterlockedCompareExchange(value, desired, expected) == (expected))
+
+#define LDi_atomicLoadPointer(value)                                           \
+    InterlockedCompareExchangePointer((PVOID volatile *)(value), NULL, NULL)
+/* true if the pointer held expected and now holds desired */
+#define LDi_atomicCompareExchangePointer(value, expected, desired)             \
+    (InterlockedCompareExchangePointer(                                        \
+         (PVOID volatile *)(value), (desired), (expected)) == (expected))
+
+/* for totals that may exceed 32 bits, LONG is 32 bits even on 64 bit
+Windows */
+typedef LONGLONG volatile ld_atomic64_t;
+
+#define LDi_atomicAdd64(value, amount)                                         \
+    (InterlockedExchangeAdd64(value, amount) + (amount))
+#define LDi_atomicLoad64(value) InterlockedCompareExchange64(value, 0, 0)
+#define LDi_atomicStore64(value, desired) InterlockedExchange64(value, desired)
+#define LDi_atomicCompareExchange64(value, expected, desired)                  \
+    (InterlockedCompareExchange64(value, desired, expected) == (expected))
+#else
+typedef long ld_atomic_t;
+
+/* these return the new value */
+#define LDi_atomicIncrement(value) __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST)
+#define LDi_atomicDecrement(value) __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST)
+#define LDi_atomicAdd(value, amount)                                           \
+    __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST)
+#define LDi_atomicLoad(value) __atomic_load_n(value, __ATOMIC_SEQ_CST)
+#define LDi_atomicStore(value, desired)                                        \
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST)
+
+/* true if value held expected and now holds desired */
+#define LDi_atomicCompareExchange(value, expected, desired)                    \
+    __sync_bool_compare_and_swap(value, expected, desired)
+
+#define LDi_atomicLoadPointer(value) __atomic_load_n(value, __ATOMIC_SEQ_CST)
+/* true if the pointer held expected and now holds desired */
+#define LDi_atomicCompareExchangePointer(value, expected, desired)             \
+    __sync_bool_compare_and_swap(value, expected, desired)
+
+/* for totals that may exceed 32 bits */
+typedef int64_t ld_atomic64_t;
+
+#define LDi_atomicAdd64(value, amount)                                         \
+    __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST)
+#define LDi_atomicLoad64(value) __atomic_load_n(value, __ATOMIC_SEQ_CST)
+#define LDi_atomicStore64(value, desired)                                      \
+    __atomic_store_n(value, desired, __ATOMIC_SEQ_CST)
+#define LDi_atomicCompareExchange64(value, expected, desired)                  \
+    __sync_bool_compare_and_swap(value, expected, desired)
+#endif
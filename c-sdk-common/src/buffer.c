@@ -0,0 +1,188 @@
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "buffer.h"
+
+/* smallest allocation, avoids many tiny reallocations when appending */
+#define LD_BUFFER_MINIMUM_CAPACITY 64
+
+struct LDBuffer *
+LDBufferNew(void)
+{
+    struct LDBuffer *buffer;
+
+    if (!(buffer = (struct LDBuffer *)LDAlloc(sizeof(struct LDBuffer)))) {
+        return NULL;
+    }
+
+    buffer->data     = NULL;
+    buffer->size     = 0;
+    buffer->capacity = 0;
+
+    return buffer;
+}
+
+void
+LDBufferFree(struct LDBuffer *const buffer)
+{
+    if (buffer) {
+        LDFree(buffer->data);
+        LDFree(buffer);
+    }
+}
+
+void
+LDBufferClear(struct LDBuffer *const buffer)
+{
+    LD_ASSERT_API(buffer);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (buffer == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDBufferClear NULL buffer");
+
+        return;
+    }
+#endif
+
+    buffer->size = 0;
+
+    if (buffer->data) {
+        buffer->data[0] = '\0';
+    }
+}
+
+LDBoolean
+LDBufferReserve(struct LDBuffer *const buffer, const size_t additional)
+{
+    char * data;
+    size_t capacity;
+
+    LD_ASSERT_API(buffer);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (buffer == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDBufferReserve NULL buffer");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    if (additional >= (size_t)-1 - buffer->size) {
+        return LDBooleanFalse;
+    }
+
+    if (buffer->size + additional < buffer->capacity) {
+        return LDBooleanTrue;
+    }
+
+    capacity = buffer->capacity ? buffer->capacity : LD_BUFFER_MINIMUM_CAPACITY;
+
+    while (capacity <= buffer->size + additional) {
+        if (capacity > (size_t)-1 / 2) {
+            capacity = buffer->size + additional + 1;
+
+            break;
+        }
+
+        capacity *= 2;
+    }
+
+    if (!(data = (char *)LDRealloc(buffer->data, capacity))) {
+        return LDBooleanFalse;
+    }
+
+    if (!buffer->data) {
+        data[0] = '\0';
+    }
+
+    buffer->data     = data;
+    buffer->capacity = capacity;
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDBufferAppend(
+    struct LDBuffer *const buffer, const char *const data, const size_t dataSize)
+{
+    LD_ASSERT_API(buffer);
+    LD_ASSERT_API(data);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (buffer == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDBufferAppend NULL buffer");
+
+        return LDBooleanFalse;
+    }
+
+    if (data == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDBufferAppend NULL data");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    if (!LDBufferReserve(buffer, dataSize)) {
+        return LDBooleanFalse;
+    }
+
+    memcpy(buffer->data + buffer->size, data, dataSize);
+    buffer->size += dataSize;
+    buffer->data[buffer->size] = '\0';
+
+    return LDBooleanTrue;
+}
+
+const char *
+LDBufferData(const struct LDBuffer *const buffer)
+{
+    LD_ASSERT_API(buffer);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (buffer == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDBufferData NULL buffer");
+
+        return NULL;
+    }
+#endif
+
+    return buffer->data ? buffer->data : "";
+}
+
+size_t
+LDBufferSize(const struct LDBuffer *const buffer)
+{
+    LD_ASSERT_API(buffer);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (buffer == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDBufferSize NULL buffer");
+
+        return 0;
+    }
+#endif
+
+    return buffer->size;
+}
+
+char *
+LDi_bufferDetach(struct LDBuffer *const buffer)
+{
+    char *result;
+
+    LD_ASSERT(buffer);
+
+    if (buffer->data) {
+        result = buffer->data;
+    } else if (!(result = LDStrDup(""))) {
+        return NULL;
+    }
+
+    buffer->data     = NULL;
+    buffer->size     = 0;
+    buffer->capacity = 0;
+
+    return result;
+}
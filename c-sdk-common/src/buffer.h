@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/buffer.h>
+
+struct LDBuffer
+{
+    /* allocated with LDAlloc, NULL until content is first added */
+    char * data;
+    size_t size;
+    /* bytes allocated, always greater than size when data is allocated */
+    size_t capacity;
+};
+
+/* Takes ownership of the contents as a null terminated string to be released
+with LDFree, leaving the buffer empty with no capacity. Returns NULL on
+failure. */
+char *
+LDi_bufferDetach(struct LDBuffer *const buffer);
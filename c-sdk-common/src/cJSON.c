@@ -55,7 +55,10 @@
 #pragma GCC visibility pop
 #endif
 
+#include "atomic.h"
 #include "cJSON.h"
+#include "number_format.h"
+#include "scan.h"
 
 /* define our own boolean type */
 #ifdef true
@@ -229,22 +232,439 @@ cJSON_New_Item(const internal_hooks *const hooks)
     return node;
 }
 
+/* Bump allocator for cJSON_ParseArena. The first block starts with the
+ * root item of the document, so deleting the root can find and release every
+ * block. */
+typedef struct arena_block
+{
+    struct arena_block *next;
+    size_t              used;
+    size_t              capacity;
+} arena_block;
+
+typedef struct
+{
+    arena_block *first;
+    arena_block *current;
+} arena;
+
+#define arena_align(size) (((size) + 7) & ~(size_t)7)
+#define arena_header_size arena_align(sizeof(arena_block))
+
+static arena_block *
+arena_new_block(const size_t capacity)
+{
+    arena_block *const block =
+        (arena_block *)global_hooks.allocate(arena_header_size + capacity);
+
+    if (block != NULL) {
+        block->next     = NULL;
+        block->used     = 0;
+        block->capacity = capacity;
+    }
+
+    return block;
+}
+
+static void *
+arena_allocate(arena *const allocator, size_t size)
+{
+    arena_block *block = allocator->current;
+
+    size = arena_align(size);
+
+    if (block->capacity - block->used < size) {
+        size_t capacity = block->capacity * 2;
+
+        if (capacity < size) {
+            capacity = size;
+        }
+
+        if ((block = arena_new_block(capacity)) == NULL) {
+            return NULL;
+        }
+
+        allocator->current->next = block;
+        allocator->current       = block;
+    }
+
+    block->used += size;
+
+    return (unsigned char *)block + arena_header_size + block->used - size;
+}
+
+/* the root is the first allocation of the first block */
+static void
+arena_free(cJSON *const root)
+{
+    arena_block *block =
+        (arena_block *)(void *)((unsigned char *)root - arena_header_size);
+
+    while (block != NULL) {
+        arena_block *const next = block->next;
+
+        global_hooks.deallocate(block);
+        block = next;
+    }
+}
+
+/* Open addressing hash table with linear probing over the members of an
+ * object. Members with the same key probe from the same slot, and removal
+ * shifts later entries back rather than leaving tombstones, so entries with
+ * the same key stay in member order and a lookup finds the first member with
+ * that key, exactly as the linear search does. */
+typedef struct
+{
+    size_t hash;
+    cJSON *item;
+} index_slot;
+
+struct cJSON_Index
+{
+    index_slot *slots;
+    /* always a power of two */
+    size_t capacity;
+    size_t count;
+    /* last member, so appending does not walk the member list */
+    cJSON *tail;
+};
+
+/* Arrays and objects have no use for valuestring, so it holds this record
+ * instead when they are indexed or shared, keeping both out of every node. */
+struct cJSON_Extra
+{
+    /* built when an object is parsed or grown past CJSON_INDEX_THRESHOLD
+     * members, never by lookups, so concurrent readers are safe */
+    struct cJSON_Index *index;
+    /* holders of the children, 0 unless shared by cJSON_Freeze */
+    ld_atomic_t references;
+};
+
+static struct cJSON_Extra *
+extra_get(const cJSON *const item)
+{
+    if (!(item->type & (cJSON_Array | cJSON_Object))) {
+        return NULL;
+    }
+
+    return (struct cJSON_Extra *)(void *)item->valuestring;
+}
+
+/* returns the record of an array or object, allocating it if needed */
+static struct cJSON_Extra *
+extra_acquire(cJSON *const item)
+{
+    struct cJSON_Extra *extra = extra_get(item);
+
+    if (extra == NULL) {
+        extra = (struct cJSON_Extra *)global_hooks.allocate(sizeof(*extra));
+
+        if (extra == NULL) {
+            return NULL;
+        }
+
+        extra->index = NULL;
+        LDi_atomicStore(&extra->references, 0);
+
+        item->valuestring = (char *)(void *)extra;
+    }
+
+    return extra;
+}
+
+static struct cJSON_Index *
+index_get(const cJSON *const object)
+{
+    const struct cJSON_Extra *const extra = extra_get(object);
+
+    return extra != NULL ? extra->index : NULL;
+}
+
+static cJSON_bool
+is_shared(const cJSON *const item)
+{
+    struct cJSON_Extra *const extra = extra_get(item);
+
+    return extra != NULL && LDi_atomicLoad(&extra->references) != 0;
+}
+
+/* FNV-1a */
+static size_t
+index_hash(const char *key)
+{
+    size_t hash = (size_t)2166136261u;
+
+    for (; *key; key++) {
+        hash ^= (unsigned char)*key;
+        hash *= (size_t)16777619u;
+    }
+
+    return hash;
+}
+
+static void
+index_free(cJSON *const object)
+{
+    struct cJSON_Extra *const extra = extra_get(object);
+
+    if (extra != NULL && extra->index != NULL) {
+        global_hooks.deallocate(extra->index->slots);
+        global_hooks.deallocate(extra->index);
+        extra->index = NULL;
+    }
+}
+
+static void
+extra_free(cJSON *const item)
+{
+    if (extra_get(item) != NULL) {
+        index_free(item);
+        global_hooks.deallocate(item->valuestring);
+        item->valuestring = NULL;
+    }
+}
+
+static void
+index_place(struct cJSON_Index *const index, const size_t hash, cJSON *item)
+{
+    size_t slot = hash & (index->capacity - 1);
+
+    while (index->slots[slot].item != NULL) {
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    index->slots[slot].hash = hash;
+    index->slots[slot].item = item;
+    index->count++;
+}
+
+static cJSON_bool
+index_resize(struct cJSON_Index *const index, const size_t capacity)
+{
+    index_slot *const previous         = index->slots;
+    const size_t      previousCapacity = index->capacity;
+    size_t            i;
+
+    index->slots =
+        (index_slot *)global_hooks.allocate(sizeof(index_slot) * capacity);
+
+    if (index->slots == NULL) {
+        index->slots = previous;
+        return false;
+    }
+
+    memset(index->slots, 0, sizeof(index_slot) * capacity);
+    index->capacity = capacity;
+    index->count    = 0;
+
+    for (i = 0; i < previousCapacity; i++) {
+        if (previous[i].item != NULL) {
+            index_place(index, previous[i].hash, previous[i].item);
+        }
+    }
+
+    global_hooks.deallocate(previous);
+
+    return true;
+}
+
+/* drops the index on allocation failure, lookups fall back to searching */
+static void
+index_insert(cJSON *const object, cJSON *const item)
+{
+    struct cJSON_Index *const index = index_get(object);
+
+    if (item->string == NULL) {
+        return;
+    }
+
+    if ((index->count + 1) * 2 > index->capacity) {
+        if (!index_resize(index, index->capacity * 2)) {
+            index_free(object);
+            return;
+        }
+    }
+
+    index_place(index, index_hash(item->string), item);
+}
+
+static size_t
+index_find_slot(const struct cJSON_Index *const index, const cJSON *const item)
+{
+    size_t slot = index_hash(item->string) & (index->capacity - 1);
+
+    while (index->slots[slot].item != item) {
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    return slot;
+}
+
+static void
+index_remove(struct cJSON_Index *const index, const cJSON *const item)
+{
+    size_t hole, next;
+
+    if (item->string == NULL) {
+        return;
+    }
+
+    hole = index_find_slot(index, item);
+    next = hole;
+
+    /* move back any later entry in the run that may probe through the hole */
+    for (;;) {
+        size_t home;
+
+        next = (next + 1) & (index->capacity - 1);
+
+        if (index->slots[next].item == NULL) {
+            break;
+        }
+
+        home = index->slots[next].hash & (index->capacity - 1);
+
+        if (((next - home) & (index->capacity - 1)) >=
+            ((next - hole) & (index->capacity - 1)))
+        {
+            index->slots[hole] = index->slots[next];
+            hole               = next;
+        }
+    }
+
+    index->slots[hole].item = NULL;
+    index->count--;
+}
+
+static cJSON *
+index_lookup(const struct cJSON_Index *const index, const char *const name)
+{
+    const size_t hash = index_hash(name);
+    size_t       slot = hash & (index->capacity - 1);
+
+    for (; index->slots[slot].item != NULL;
+         slot = (slot + 1) & (index->capacity - 1))
+    {
+        if (index->slots[slot].hash == hash &&
+            strcmp(name, index->slots[slot].item->string) == 0)
+        {
+            return index->slots[slot].item;
+        }
+    }
+
+    return NULL;
+}
+
+/* indexes an object with at least CJSON_INDEX_THRESHOLD members, leaves it
+ * unindexed on allocation failure */
+static void
+index_build(cJSON *const object)
+{
+    struct cJSON_Extra *extra;
+    struct cJSON_Index *index;
+    cJSON *             child;
+    size_t              count, capacity;
+
+    if ((object->type & 0xFF) != cJSON_Object || index_get(object) != NULL ||
+        (object->type & cJSON_IsReference))
+    {
+        return;
+    }
+
+    for (count = 0, child = object->child; child != NULL; child = child->next) {
+        count++;
+    }
+
+    if (count < CJSON_INDEX_THRESHOLD) {
+        return;
+    }
+
+    for (capacity = 64; capacity < count * 2; capacity *= 2) {
+    }
+
+    if ((extra = extra_acquire(object)) == NULL) {
+        return;
+    }
+
+    index = (struct cJSON_Index *)global_hooks.allocate(sizeof(*index));
+
+    if (index == NULL) {
+        return;
+    }
+
+    index->slots =
+        (index_slot *)global_hooks.allocate(sizeof(index_slot) * capacity);
+
+    if (index->slots == NULL) {
+        global_hooks.deallocate(index);
+        return;
+    }
+
+    memset(index->slots, 0, sizeof(index_slot) * capacity);
+    index->capacity = capacity;
+    index->count    = 0;
+    index->tail     = NULL;
+
+    for (child = object->child; child != NULL; child = child->next) {
+        if (child->string != NULL) {
+            index_place(index, index_hash(child->string), child);
+        }
+
+        index->tail = child;
+    }
+
+    extra->index = index;
+}
+
+/* drops the contents of an item without freeing them */
+static void
+forget_contents(cJSON *const item)
+{
+    item->child       = NULL;
+    item->valuestring = NULL;
+}
+
+/* releases a reference to shared contents, returns true if the item now owns
+ * them */
+static cJSON_bool
+shared_release(cJSON *const item)
+{
+    if (LDi_atomicDecrement(&extra_get(item)->references) == 0) {
+        return true;
+    }
+
+    forget_contents(item);
+
+    return false;
+}
+
 /* Delete a cJSON structure. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
 {
     cJSON *next = NULL;
     while (item != NULL) {
         next = item->next;
+        if (is_shared(item)) {
+            shared_release(item);
+        }
         if (!(item->type & cJSON_IsReference) && (item->child != NULL)) {
             cJSON_Delete(item->child);
         }
-        if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL)) {
+        if (extra_get(item) != NULL) {
+            extra_free(item);
+        } else if (!(item->type & (cJSON_IsReference | cJSON_IsArena)) &&
+                   (item->valuestring != NULL))
+        {
             global_hooks.deallocate(item->valuestring);
         }
         if (!(item->type & cJSON_StringIsConst) && (item->string != NULL)) {
             global_hooks.deallocate(item->string);
         }
-        global_hooks.deallocate(item);
+        if (item->type & cJSON_ArenaRoot) {
+            arena_free(item);
+        } else if (!(item->type & cJSON_IsArena)) {
+            global_hooks.deallocate(item);
+        }
         item = next;
     }
 }
@@ -269,8 +689,49 @@ typedef struct
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the
                      current offset. */
     internal_hooks hooks;
+    /* allocate from here instead of hooks when not NULL */
+    arena *arena;
 } parse_buffer;
 
+/* flags of an item that parsing a value into it must keep */
+#define parse_flags(item)                                                      \
+    ((item)->type & (cJSON_IsArena | cJSON_ArenaRoot | cJSON_StringIsConst))
+
+static void *
+parse_allocate(parse_buffer *const input_buffer, const size_t size)
+{
+    if (input_buffer->arena != NULL) {
+        return arena_allocate(input_buffer->arena, size);
+    }
+
+    return input_buffer->hooks.allocate(size);
+}
+
+static void
+parse_deallocate(parse_buffer *const input_buffer, void *const pointer)
+{
+    if (input_buffer->arena == NULL) {
+        input_buffer->hooks.deallocate(pointer);
+    }
+}
+
+static cJSON *
+parse_new_item(parse_buffer *const input_buffer)
+{
+    cJSON *const node =
+        (cJSON *)parse_allocate(input_buffer, sizeof(cJSON));
+
+    if (node) {
+        memset(node, '\0', sizeof(cJSON));
+
+        if (input_buffer->arena != NULL) {
+            node->type = cJSON_IsArena;
+        }
+    }
+
+    return node;
+}
+
 /* check if the given size is left to read in a given parse buffer (starting
  * with 1) */
 #define can_read(buffer, size)                                                 \
@@ -351,7 +812,7 @@ loop_end:
         item->valueint = (int)number;
     }
 
-    item->type = cJSON_Number;
+    item->type = parse_flags(item) | cJSON_Number;
 
     input_buffer->offset += (size_t)(after_end - number_c_string);
     return true;
@@ -425,29 +886,21 @@ ensure(printbuffer *const p, size_t needed)
         newsize = needed * 2;
     }
 
+    /* on failure the existing buffer is left in place for the caller to
+     * release, it may be owned by the caller of cJSON_PrintAppend */
     if (p->hooks.reallocate != NULL) {
         /* reallocate with realloc if available */
         newbuffer = (unsigned char *)p->hooks.reallocate(p->buffer, newsize);
         if (newbuffer == NULL) {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
-
             return NULL;
         }
     } else {
         /* otherwise reallocate manually */
         newbuffer = (unsigned char *)p->hooks.allocate(newsize);
         if (!newbuffer) {
-            p->hooks.deallocate(p->buffer);
-            p->length = 0;
-            p->buffer = NULL;
-
             return NULL;
         }
-        if (newbuffer) {
-            memcpy(newbuffer, p->buffer, p->offset + 1);
-        }
+        memcpy(newbuffer, p->buffer, p->offset + 1);
         p->hooks.deallocate(p->buffer);
     }
     p->length = newsize;
@@ -476,12 +929,9 @@ print_number(const cJSON *const item, printbuffer *const output_buffer)
 {
     unsigned char *output_pointer = NULL;
     double         d              = item->valuedouble;
-    int            length         = 0;
-    size_t         i              = 0;
-    unsigned char
-        number_buffer[26]; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
-    double        test;
+    size_t         length         = 0;
+    /* temporary buffer to print the number into */
+    char number_buffer[LD_NUMBER_FORMAT_SIZE];
 
     if (output_buffer == NULL) {
         return false;
@@ -489,44 +939,22 @@ print_number(const cJSON *const item, printbuffer *const output_buffer)
 
     /* This checks for NaN and Infinity */
     if ((d * 0) != 0) {
-        length = sprintf((char *)number_buffer, "null");
+        length = sizeof("null") - 1;
+        memcpy(number_buffer, "null", sizeof("null"));
     } else {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero
-         * digits */
-        length = sprintf((char *)number_buffer, "%1.15g", d);
-
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char *)number_buffer, "%lg", &test) != 1) ||
-            ((double)test != d)) {
-            /* If not, print with 17 decimal places of precision */
-            length = sprintf((char *)number_buffer, "%1.17g", d);
-        }
-    }
-
-    /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1))) {
-        return false;
+        /* shortest roundtrip digits, always with '.' as the decimal point */
+        length = LDi_formatNumber(d, number_buffer);
     }
 
     /* reserve appropriate space in the output */
-    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
+    output_pointer = ensure(output_buffer, length + sizeof(""));
     if (output_pointer == NULL) {
         return false;
     }
 
-    /* copy the printed number to the output and replace locale
-     * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++) {
-        if (number_buffer[i] == decimal_point) {
-            output_pointer[i] = '.';
-            continue;
-        }
-
-        output_pointer[i] = number_buffer[i];
-    }
-    output_pointer[i] = '\0';
+    memcpy(output_pointer, number_buffer, length + sizeof(""));
 
-    output_buffer->offset += (size_t)length;
+    output_buffer->offset += length;
 
     return true;
 }
@@ -690,6 +1118,19 @@ parse_string(cJSON *const item, parse_buffer *const input_buffer)
                 input_buffer->length) &&
                (*input_end != '\"'))
         {
+            /* skip ahead to the next quote, backslash or control character */
+            input_end += LDi_scanJSONString(
+                (const char *)input_end,
+                input_buffer->length -
+                    (size_t)(input_end - input_buffer->content));
+
+            if (((size_t)(input_end - input_buffer->content) >=
+                 input_buffer->length) ||
+                (*input_end == '\"'))
+            {
+                break;
+            }
+
             /* is escape sequence */
             if (input_end[0] == '\\') {
                 if ((size_t)(input_end + 1 - input_buffer->content) >=
@@ -714,8 +1155,8 @@ parse_string(cJSON *const item, parse_buffer *const input_buffer)
         allocation_length =
             (size_t)(input_end - buffer_at_offset(input_buffer)) -
             skipped_bytes;
-        output = (unsigned char *)input_buffer->hooks.allocate(
-            allocation_length + sizeof(""));
+        output = (unsigned char *)parse_allocate(
+            input_buffer, allocation_length + sizeof(""));
         if (output == NULL) {
             goto fail; /* allocation failure */
         }
@@ -724,6 +1165,19 @@ parse_string(cJSON *const item, parse_buffer *const input_buffer)
     output_pointer = output;
     /* loop through the string literal */
     while (input_pointer < input_end) {
+        /* copy everything up to the next escape sequence at once */
+        const size_t run = LDi_scanJSONString(
+            (const char *)input_pointer, (size_t)(input_end - input_pointer));
+
+        memcpy(output_pointer, input_pointer, run);
+        output_pointer += run;
+        input_pointer += run;
+
+        if (input_pointer == input_end) {
+            break;
+        }
+
+        /* control characters are passed through */
         if (*input_pointer != '\\') {
             *output_pointer++ = *input_pointer++;
         }
@@ -777,7 +1231,7 @@ parse_string(cJSON *const item, parse_buffer *const input_buffer)
     /* zero terminate the output */
     *output_pointer = '\0';
 
-    item->type        = cJSON_String;
+    item->type        = parse_flags(item) | cJSON_String;
     item->valuestring = (char *)output;
 
     input_buffer->offset = (size_t)(input_end - input_buffer->content);
@@ -787,7 +1241,7 @@ parse_string(cJSON *const item, parse_buffer *const input_buffer)
 
 fail:
     if (output != NULL) {
-        input_buffer->hooks.deallocate(output);
+        parse_deallocate(input_buffer, output);
     }
 
     if (input_pointer != NULL) {
@@ -806,6 +1260,8 @@ print_string_ptr(
     unsigned char *      output         = NULL;
     unsigned char *      output_pointer = NULL;
     size_t               output_length  = 0;
+    size_t               input_length   = 0;
+    size_t               offset         = 0;
     /* numbers of additional characters needed for escaping */
     size_t escape_characters = 0;
 
@@ -824,9 +1280,18 @@ print_string_ptr(
         return true;
     }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++) {
-        switch (*input_pointer) {
+    input_length = strlen((const char *)input);
+
+    /* count the additional characters needed for escaping */
+    for (offset = 0;; offset++) {
+        offset += LDi_scanJSONString(
+            (const char *)input + offset, input_length - offset);
+
+        if (offset == input_length) {
+            break;
+        }
+
+        switch (input[offset]) {
         case '\"':
         case '\\':
         case '\b':
@@ -838,14 +1303,12 @@ print_string_ptr(
             escape_characters++;
             break;
         default:
-            if (*input_pointer < 32) {
-                /* UTF-16 escape sequence uXXXX */
-                escape_characters += 5;
-            }
+            /* UTF-16 escape sequence uXXXX */
+            escape_characters += 5;
             break;
         }
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
+    output_length = input_length + escape_characters;
 
     output = ensure(output_buffer, output_length + sizeof("\"\""));
     if (output == NULL) {
@@ -865,45 +1328,49 @@ print_string_ptr(
     output[0]      = '\"';
     output_pointer = output + 1;
     /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0';
-         (void)input_pointer++, output_pointer++)
-    {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') &&
-            (*input_pointer != '\\'))
-        {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
-        } else {
-            /* character needs to be escaped */
+    for (input_pointer = input;; input_pointer++) {
+        /* copy everything up to the next character to escape at once */
+        const size_t run = LDi_scanJSONString(
+            (const char *)input_pointer,
+            input_length - (size_t)(input_pointer - input));
+
+        memcpy(output_pointer, input_pointer, run);
+        output_pointer += run;
+        input_pointer += run;
+
+        if (*input_pointer == '\0') {
+            break;
+        }
+
+        /* character needs to be escaped */
+        *output_pointer++ = '\\';
+        switch (*input_pointer) {
+        case '\\':
             *output_pointer++ = '\\';
-            switch (*input_pointer) {
-            case '\\':
-                *output_pointer = '\\';
-                break;
-            case '\"':
-                *output_pointer = '\"';
-                break;
-            case '\b':
-                *output_pointer = 'b';
-                break;
-            case '\f':
-                *output_pointer = 'f';
-                break;
-            case '\n':
-                *output_pointer = 'n';
-                break;
-            case '\r':
-                *output_pointer = 'r';
-                break;
-            case '\t':
-                *output_pointer = 't';
-                break;
-            default:
-                /* escape and print as unicode codepoint */
-                sprintf((char *)output_pointer, "u%04x", *input_pointer);
-                output_pointer += 4;
-                break;
-            }
+            break;
+        case '\"':
+            *output_pointer++ = '\"';
+            break;
+        case '\b':
+            *output_pointer++ = 'b';
+            break;
+        case '\f':
+            *output_pointer++ = 'f';
+            break;
+        case '\n':
+            *output_pointer++ = 'n';
+            break;
+        case '\r':
+            *output_pointer++ = 'r';
+            break;
+        case '\t':
+            *output_pointer++ = 't';
+            break;
+        default:
+            /* escape and print as unicode codepoint */
+            sprintf((char *)output_pointer, "u%04x", *input_pointer);
+            output_pointer += 5;
+            break;
         }
     }
     output[output_length + 1] = '\"';
@@ -973,14 +1440,16 @@ skip_utf8_bom(parse_buffer *const buffer)
 }
 
 /* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *)
-cJSON_ParseWithOpts(
+static cJSON *
+parse_with_opts(
     const char * value,
     const char **return_parse_end,
-    cJSON_bool   require_null_terminated)
+    cJSON_bool   require_null_terminated,
+    cJSON_bool   use_arena)
 {
-    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}};
+    parse_buffer buffer = {0, 0, 0, 0, {0, 0, 0}, 0};
     cJSON *      item   = NULL;
+    arena        document_arena;
 
     /* reset error position */
     global_error.json     = NULL;
@@ -995,11 +1464,29 @@ cJSON_ParseWithOpts(
     buffer.offset  = 0;
     buffer.hooks   = global_hooks;
 
-    item = cJSON_New_Item(&global_hooks);
+    if (use_arena) {
+        /* most documents fit in the first block */
+        document_arena.first = arena_new_block(
+            arena_align(sizeof(cJSON)) + buffer.length * 4 + 1024);
+        if (document_arena.first == NULL) {
+            goto fail;
+        }
+        document_arena.current = document_arena.first;
+        buffer.arena           = &document_arena;
+    }
+
+    item = parse_new_item(&buffer);
     if (item == NULL) /* memory fail */ {
+        if (use_arena) {
+            global_hooks.deallocate(document_arena.first);
+        }
         goto fail;
     }
 
+    if (use_arena) {
+        item->type |= cJSON_ArenaRoot;
+    }
+
     if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer)))) {
         /* parse failure. ep is set. */
         goto fail;
@@ -1047,6 +1534,21 @@ fail:
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *)
+cJSON_ParseWithOpts(
+    const char * value,
+    const char **return_parse_end,
+    cJSON_bool   require_null_terminated)
+{
+    return parse_with_opts(
+        value, return_parse_end, require_null_terminated, false);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseArena(const char *value)
+{
+    return parse_with_opts(value, 0, 0, true);
+}
+
 /* Default options for cJSON_Parse */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
 {
@@ -1178,6 +1680,107 @@ cJSON_PrintPreallocated(
     return print_value(item, &p);
 }
 
+CJSON_PUBLIC(cJSON_bool)
+cJSON_PrintAppend(
+    const cJSON *    item,
+    char **          buffer,
+    size_t *         length,
+    size_t *         capacity,
+    const cJSON_bool format)
+{
+    printbuffer p = {0, 0, 0, 0, 0, 0, {0, 0, 0}};
+    cJSON_bool  printed;
+
+    if ((item == NULL) || (buffer == NULL) || (*buffer == NULL) ||
+        (length == NULL) || (capacity == NULL) || (*length >= *capacity))
+    {
+        return false;
+    }
+
+    p.buffer  = (unsigned char *)*buffer;
+    p.length  = *capacity;
+    p.offset  = *length;
+    p.noalloc = false;
+    p.format  = format;
+    p.hooks   = global_hooks;
+
+    printed = print_value(item, &p);
+
+    *buffer   = (char *)p.buffer;
+    *capacity = p.length;
+
+    if (printed) {
+        update_offset(&p);
+        *length = p.offset;
+    } else {
+        /* drop any partial output */
+        (*buffer)[*length] = '\0';
+    }
+
+    return printed;
+}
+
+/* whole numbers print as plain digits, anything else is at most this long */
+#define ESTIMATE_NUMBER_LENGTH 24
+
+static size_t
+estimate_number(const double number)
+{
+    double magnitude = fabs(number);
+    size_t length    = number < 0 ? 2 : 1;
+
+    if ((magnitude >= 1e15) || (magnitude != floor(magnitude))) {
+        return ESTIMATE_NUMBER_LENGTH;
+    }
+
+    while (magnitude >= 10) {
+        magnitude /= 10;
+        length++;
+    }
+
+    return length;
+}
+
+CJSON_PUBLIC(size_t) cJSON_EstimatePrintedLength(const cJSON *item)
+{
+    const cJSON *child;
+    size_t       length;
+
+    if (item == NULL) {
+        return 0;
+    }
+
+    switch (item->type & 0xFF) {
+    case cJSON_NULL:
+    case cJSON_True: return sizeof("null") - 1;
+    case cJSON_False: return sizeof("false") - 1;
+    case cJSON_Number: return estimate_number(item->valuedouble);
+    case cJSON_Raw:
+        return item->valuestring ? strlen(item->valuestring) : 0;
+    case cJSON_String:
+        /* escapes are rare, ensure absorbs them when they occur */
+        return (item->valuestring ? strlen(item->valuestring) : 0) + 2;
+    case cJSON_Array:
+    case cJSON_Object:
+        length = 2;
+
+        for (child = item->child; child; child = child->next) {
+            length += cJSON_EstimatePrintedLength(child);
+
+            if (child->next) {
+                length++;
+            }
+
+            if ((item->type & 0xFF) == cJSON_Object) {
+                length += (child->string ? strlen(child->string) : 0) + 3;
+            }
+        }
+
+        return length;
+    default: return 0;
+    }
+}
+
 /* Parser core - when encountering text, process appropriately. */
 static cJSON_bool
 parse_value(cJSON *const item, parse_buffer *const input_buffer)
@@ -1191,7 +1794,7 @@ parse_value(cJSON *const item, parse_buffer *const input_buffer)
     if (can_read(input_buffer, 4) &&
         (strncmp((const char *)buffer_at_offset(input_buffer), "null", 4) == 0))
     {
-        item->type = cJSON_NULL;
+        item->type = parse_flags(item) | cJSON_NULL;
         input_buffer->offset += 4;
         return true;
     }
@@ -1200,7 +1803,7 @@ parse_value(cJSON *const item, parse_buffer *const input_buffer)
         (strncmp((const char *)buffer_at_offset(input_buffer), "false", 5) ==
          0))
     {
-        item->type = cJSON_False;
+        item->type = parse_flags(item) | cJSON_False;
         input_buffer->offset += 5;
         return true;
     }
@@ -1208,7 +1811,7 @@ parse_value(cJSON *const item, parse_buffer *const input_buffer)
     if (can_read(input_buffer, 4) &&
         (strncmp((const char *)buffer_at_offset(input_buffer), "true", 4) == 0))
     {
-        item->type     = cJSON_True;
+        item->type     = parse_flags(item) | cJSON_True;
         item->valueint = 1;
         input_buffer->offset += 4;
         return true;
@@ -1347,7 +1950,7 @@ parse_array(cJSON *const item, parse_buffer *const input_buffer)
     /* loop through the comma separated array elements */
     do {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_new_item(input_buffer);
         if (new_item == NULL) {
             goto fail; /* allocation failure */
         }
@@ -1382,7 +1985,7 @@ parse_array(cJSON *const item, parse_buffer *const input_buffer)
 success:
     input_buffer->depth--;
 
-    item->type  = cJSON_Array;
+    item->type  = parse_flags(item) | cJSON_Array;
     item->child = head;
 
     input_buffer->offset++;
@@ -1489,7 +2092,7 @@ parse_object(cJSON *const item, parse_buffer *const input_buffer)
     /* loop through the comma separated array elements */
     do {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_new_item(input_buffer);
         if (new_item == NULL) {
             goto fail; /* allocation failure */
         }
@@ -1517,6 +2120,11 @@ parse_object(cJSON *const item, parse_buffer *const input_buffer)
         current_item->string      = current_item->valuestring;
         current_item->valuestring = NULL;
 
+        /* arena strings must never be freed on their own */
+        if (input_buffer->arena != NULL) {
+            current_item->type |= cJSON_StringIsConst;
+        }
+
         if (cannot_access_at_index(input_buffer, 0) ||
             (buffer_at_offset(input_buffer)[0] != ':'))
         {
@@ -1542,9 +2150,11 @@ parse_object(cJSON *const item, parse_buffer *const input_buffer)
 success:
     input_buffer->depth--;
 
-    item->type  = cJSON_Object;
+    item->type  = parse_flags(item) | cJSON_Object;
     item->child = head;
 
+    index_build(item);
+
     input_buffer->offset++;
     return true;
 
@@ -1719,6 +2329,10 @@ get_object_item(
         return NULL;
     }
 
+    if (case_sensitive && (index_get(object) != NULL)) {
+        return index_lookup(index_get(object), name);
+    }
+
     current_element = object->child;
     if (case_sensitive) {
         while ((current_element != NULL) && (current_element->string != NULL) &&
@@ -1786,6 +2400,10 @@ create_reference(const cJSON *item, const internal_hooks *const hooks)
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
+    if (extra_get(item) != NULL) {
+        /* the record belongs to the item */
+        reference->valuestring = NULL;
+    }
     reference->type |= cJSON_IsReference;
     reference->next = reference->prev = NULL;
     return reference;
@@ -1794,23 +2412,44 @@ create_reference(const cJSON *item, const internal_hooks *const hooks)
 static cJSON_bool
 add_item_to_array(cJSON *array, cJSON *item)
 {
-    cJSON *child = NULL;
+    cJSON *             child = NULL;
+    struct cJSON_Index *index;
 
     if ((item == NULL) || (array == NULL)) {
         return false;
     }
 
+    if ((index = index_get(array)) != NULL) {
+        if (array->child == NULL) {
+            /* every member was detached */
+            array->child = item;
+        } else {
+            suffix_object(index->tail, item);
+        }
+        index->tail = item;
+        index_insert(array, item);
+
+        return true;
+    }
+
     child = array->child;
 
     if (child == NULL) {
         /* list is empty, start new one */
         array->child = item;
     } else {
+        size_t count = 1;
+
         /* append to the end */
         while (child->next) {
             child = child->next;
+            count++;
         }
         suffix_object(child, item);
+
+        if (count + 1 >= CJSON_INDEX_THRESHOLD) {
+            index_build(array);
+        }
     }
 
     return true;
@@ -2031,10 +2670,20 @@ cJSON_AddArrayToObject(cJSON *const object, const char *const name)
 CJSON_PUBLIC(cJSON *)
 cJSON_DetachItemViaPointer(cJSON *parent, cJSON *const item)
 {
+    struct cJSON_Index *index;
+
     if ((parent == NULL) || (item == NULL)) {
         return NULL;
     }
 
+    if ((index = index_get(parent)) != NULL) {
+        if (index->tail == item) {
+            index->tail = item->prev;
+        }
+
+        index_remove(index, item);
+    }
+
     if (item->prev != NULL) {
         /* not the first element */
         item->prev->next = item->next;
@@ -2113,6 +2762,9 @@ cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem)
         return;
     }
 
+    /* the index only supports appending members */
+    index_free(array);
+
     newitem->next        = after_inserted;
     newitem->prev        = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2127,6 +2779,8 @@ CJSON_PUBLIC(cJSON_bool)
 cJSON_ReplaceItemViaPointer(
     cJSON *const parent, cJSON *const item, cJSON *replacement)
 {
+    struct cJSON_Index *index;
+
     if ((parent == NULL) || (replacement == NULL) || (item == NULL)) {
         return false;
     }
@@ -2135,6 +2789,21 @@ cJSON_ReplaceItemViaPointer(
         return true;
     }
 
+    if ((index = index_get(parent)) != NULL) {
+        if ((item->string != NULL) && (replacement->string != NULL) &&
+            (strcmp(item->string, replacement->string) == 0))
+        {
+            /* same key so the replacement takes over the same slot */
+            index->slots[index_find_slot(index, item)].item = replacement;
+
+            if (index->tail == item) {
+                index->tail = replacement;
+            }
+        } else {
+            index_free(parent);
+        }
+    }
+
     replacement->next = item->next;
     replacement->prev = item->prev;
 
@@ -2471,13 +3140,16 @@ CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char **strings, int count)
     return a;
 }
 
-/* Duplication */
-CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+/* Duplication, when share is set the contents of frozen items are shared
+ * rather than copied */
+static cJSON *
+duplicate(const cJSON *item, const cJSON_bool recurse, const cJSON_bool share)
 {
-    cJSON *newitem  = NULL;
-    cJSON *child    = NULL;
-    cJSON *next     = NULL;
-    cJSON *newchild = NULL;
+    cJSON *    newitem  = NULL;
+    cJSON *    child    = NULL;
+    cJSON *    next     = NULL;
+    cJSON *    newchild = NULL;
+    cJSON_bool shared   = false;
 
     /* Bail on bad ptr */
     if (!item) {
@@ -2489,10 +3161,18 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
         goto fail;
     }
     /* Copy over all vars */
-    newitem->type        = item->type & (~cJSON_IsReference);
+    newitem->type = item->type & ~(cJSON_IsReference | cJSON_IsArena |
+                                   cJSON_ArenaRoot | cJSON_IsFrozen);
     newitem->valueint    = item->valueint;
     newitem->valuedouble = item->valuedouble;
-    if (item->valuestring) {
+    if (recurse && share && is_shared(item)) {
+        /* share the contents rather than copying them */
+        LDi_atomicIncrement(&extra_get(item)->references);
+
+        newitem->child       = item->child;
+        newitem->valuestring = item->valuestring;
+        shared               = true;
+    } else if (item->valuestring && extra_get(item) == NULL) {
         newitem->valuestring = (char *)cJSON_strdup(
             (unsigned char *)item->valuestring, &global_hooks);
         if (!newitem->valuestring) {
@@ -2500,8 +3180,12 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
         }
     }
     if (item->string) {
+        /* arena keys are marked constant but only live as long as the arena */
+        if (item->type & cJSON_IsArena) {
+            newitem->type &= ~cJSON_StringIsConst;
+        }
         newitem->string =
-            (item->type & cJSON_StringIsConst)
+            (newitem->type & cJSON_StringIsConst)
                 ? item->string
                 : (char *)cJSON_strdup(
                       (unsigned char *)item->string, &global_hooks);
@@ -2510,15 +3194,16 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
         }
     }
     /* If non-recursive, then we're done! */
-    if (!recurse) {
+    if (!recurse || shared) {
         return newitem;
     }
     /* Walk the ->next chain for the child. */
     child = item->child;
     while (child != NULL) {
-        newchild = cJSON_Duplicate(
+        newchild = duplicate(
             child,
-            true); /* Duplicate (with recurse) each item in the ->next chain */
+            true,
+            share); /* Duplicate (with recurse) each item in the ->next chain */
         if (!newchild) {
             goto fail;
         }
@@ -2536,6 +3221,8 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
         child = child->next;
     }
 
+    index_build(newitem);
+
     return newitem;
 
 fail:
@@ -2546,6 +3233,115 @@ fail:
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+{
+    return duplicate(item, recurse, false);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_Share(const cJSON *item)
+{
+    return duplicate(item, true, true);
+}
+
+/* sets or clears cJSON_IsFrozen on the descendants of an item, stopping at
+ * shared items which are already frozen */
+static void
+mark_frozen(cJSON *const item, const cJSON_bool frozen)
+{
+    cJSON *child;
+
+    for (child = item->child; child != NULL; child = child->next) {
+        if (frozen) {
+            child->type |= cJSON_IsFrozen;
+        } else {
+            child->type &= ~cJSON_IsFrozen;
+        }
+
+        if (!is_shared(child)) {
+            mark_frozen(child, frozen);
+        }
+    }
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Freeze(cJSON *item)
+{
+    struct cJSON_Extra *extra;
+
+    if ((item == NULL) ||
+        (item->type & (cJSON_IsReference | cJSON_IsArena | cJSON_IsFrozen)))
+    {
+        return false;
+    }
+
+    /* scalars and text are as cheap to copy as to share */
+    if ((item->child == NULL) || is_shared(item)) {
+        return true;
+    }
+
+    if ((extra = extra_acquire(item)) == NULL) {
+        return false;
+    }
+
+    LDi_atomicStore(&extra->references, 1);
+
+    mark_frozen(item, true);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Unshare(cJSON *item)
+{
+    cJSON *children, *child, *newchild, *last;
+
+    if ((item == NULL) || (item->type & cJSON_IsFrozen)) {
+        return false;
+    }
+
+    if (!is_shared(item)) {
+        return true;
+    }
+
+    /* nobody else can acquire a reference while this is the only holder */
+    if (LDi_atomicLoad(&extra_get(item)->references) == 1) {
+        LDi_atomicStore(&extra_get(item)->references, 0);
+
+        mark_frozen(item, false);
+
+        return true;
+    }
+
+    children = NULL;
+
+    for (last = NULL, child = item->child; child != NULL; child = child->next) {
+        if ((newchild = cJSON_Duplicate(child, true)) == NULL) {
+            cJSON_Delete(children);
+
+            return false;
+        }
+
+        if (last == NULL) {
+            children = newchild;
+        } else {
+            last->next     = newchild;
+            newchild->prev = last;
+        }
+
+        last = newchild;
+    }
+
+    /* the last reference may have been released since it was checked */
+    if (shared_release(item)) {
+        cJSON_Delete(item->child);
+        extra_free(item);
+    }
+
+    item->child = children;
+
+    index_build(item);
+
+    return true;
+}
+
 static void
 skip_oneline_comment(char **input)
 {
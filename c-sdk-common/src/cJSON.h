@@ -106,6 +106,12 @@ CJSON_EXPORT_SYMBOLS does
 
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+/* allocated from the arena of a document parsed with cJSON_ParseArena, freed
+ * when the root of the document is deleted */
+#define cJSON_IsArena 1024
+#define cJSON_ArenaRoot 2048
+/* a descendant of a shared item, see cJSON_Freeze */
+#define cJSON_IsFrozen 4096
 
 /* The cJSON structure: */
 typedef struct cJSON
@@ -121,7 +127,9 @@ typedef struct cJSON
     /* The type of the item, as above. */
     int type;
 
-    /* The item's string, if type==cJSON_String  and type == cJSON_Raw */
+    /* The item's string, if type==cJSON_String  and type == cJSON_Raw. Arrays
+     * and objects keep their hash index and sharing state here, so it is
+     * private to cJSON for them. */
     char *valuestring;
     /* writing to valueint is DEPRECATED, use cJSON_SetNumberValue instead */
     int valueint;
@@ -150,6 +158,12 @@ typedef int cJSON_bool;
 #define CJSON_NESTING_LIMIT 1000
 #endif
 
+/* Objects with at least this many members are given a hash index, smaller
+ * objects are searched linearly. */
+#ifndef CJSON_INDEX_THRESHOLD
+#define CJSON_INDEX_THRESHOLD 32
+#endif
+
 /* returns the version of cJSON as a string */
 CJSON_PUBLIC(const char *) cJSON_Version(void);
 
@@ -164,6 +178,11 @@ CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks *hooks);
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate.
  */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value);
+/* Like cJSON_Parse, but every item and string of the document is allocated
+ * from a few large blocks that are released together when the root is
+ * deleted. Items of the document must not be used after the root is deleted,
+ * duplicate them to keep them longer. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseArena(const char *value);
 /* ParseWithOpts allows you to require (and check) that the JSON is null
  * terminated, and to retrieve the pointer to the final byte parsed. */
 /* If you supply a ptr in return_parse_end and parsing fails, then
@@ -191,8 +210,32 @@ cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt);
 CJSON_PUBLIC(cJSON_bool)
 cJSON_PrintPreallocated(
     cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* Render a cJSON entity to text at offset *length of a buffer allocated with
+ * the cJSON hooks, growing it and updating *buffer and *capacity as required.
+ * On success *length is advanced past the output, on failure the original text
+ * is kept. Either way the text remains null terminated. */
+CJSON_PUBLIC(cJSON_bool)
+cJSON_PrintAppend(
+    const cJSON *    item,
+    char **          buffer,
+    size_t *         length,
+    size_t *         capacity,
+    const cJSON_bool format);
+/* Cheaply estimates the length of the unformatted text of a cJSON entity,
+ * usually exact or slightly over, to size a buffer before printing. */
+CJSON_PUBLIC(size_t) cJSON_EstimatePrintedLength(const cJSON *item);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *c);
+/* Makes the children of an array or object immutable and reference counted,
+ * so that cJSON_Share shares them rather than copying. The item itself, and any
+ * share of it, remains a private node that may be modified after a call to
+ * cJSON_Unshare. Descendants are marked cJSON_IsFrozen and may never be
+ * modified. Returns false for arena, reference, and frozen items. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Freeze(cJSON *item);
+/* Gives a shared item private contents before it is modified, copying them if
+ * they are still shared with another item. Returns false for frozen items or
+ * when out of memory, in which case the item is unchanged. */
+CJSON_PUBLIC(cJSON_bool) cJSON_Unshare(cJSON *item);
 
 /* Returns the number of items in an array (or object). */
 CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array);
@@ -307,6 +350,10 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse);
 memory that will need to be released. With recurse!=0, it will duplicate any
 children connected to the item. The item->next and ->prev pointers are always
 zero on return from Duplicate. */
+/* As a recursive cJSON_Duplicate, except the contents of frozen items are
+ * shared in constant time. The values nested in the result stay frozen until
+ * it is unshared, so it suits copies that are only read. */
+CJSON_PUBLIC(cJSON *) cJSON_Share(const cJSON *item);
 /* Recursively compare two cJSON items for equality. If either a or b is NULL or
  * invalid, they will be considered unequal.
  * case_sensitive determines if object keys are treated case sensitive (1) or
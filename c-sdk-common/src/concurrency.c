@@ -6,6 +6,21 @@
 #include "logging.h"
 #include "utility.h"
 
+#ifndef _WIN32
+/* adaptive mutexes spin briefly before sleeping, which suits the short
+critical sections of the SDK, glibc marks their availability with the
+initializer macro */
+#if defined(LAUNCHDARKLY_FAST_LOCKS) &&                                        \
+    defined(PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP)
+#define LD_MUTEX_KIND PTHREAD_MUTEX_ADAPTIVE_NP
+#elif defined(LAUNCHDARKLY_FAST_LOCKS) ||                                      \
+    defined(LAUNCHDARKLY_CONCURRENCY_UNSAFE)
+#define LD_MUTEX_KIND PTHREAD_MUTEX_NORMAL
+#else
+#define LD_MUTEX_KIND PTHREAD_MUTEX_ERRORCHECK
+#endif
+#endif
+
 static LDBoolean
 LDi_thread_join_imp(ld_thread_t *const thread)
 {
@@ -116,11 +131,7 @@ LDi_mutex_init_imp(ld_mutex_t *const mutex)
         goto done;
     }
 
-#ifdef LAUNCHDARKLY_CONCURRENCY_UNSAFE
-    kind = PTHREAD_MUTEX_NORMAL;
-#else
-    kind = PTHREAD_MUTEX_ERRORCHECK;
-#endif
+    kind = LD_MUTEX_KIND;
 
     if ((status = pthread_mutexattr_settype(&attributes, kind)) != 0) {
         LD_LOG_1(
@@ -182,11 +193,7 @@ LDi_mutex_init_nl_imp(ld_mutex_t *const mutex)
         goto done;
     }
 
-#ifdef LAUNCHDARKLY_CONCURRENCY_UNSAFE
-    kind = PTHREAD_MUTEX_NORMAL;
-#else
-    kind = PTHREAD_MUTEX_ERRORCHECK;
-#endif
+    kind = LD_MUTEX_KIND;
 
     if ((status = pthread_mutexattr_settype(&attributes, kind)) != 0) {
         goto done;
@@ -617,7 +624,8 @@ LDi_cond_wait_imp(
     LD_ASSERT(mutex);
 
 #ifdef _WIN32
-    status = SleepConditionVariableCS(cond, mutex, milliseconds);
+    status = SleepConditionVariableCS(
+        cond, mutex, milliseconds == LD_WAIT_FOREVER ? INFINITE : milliseconds);
 
     if (status == 0) {
         if (GetLastError() != ERROR_TIMEOUT) {
@@ -627,6 +635,17 @@ LDi_cond_wait_imp(
         status = 0;
     }
 #else
+    if (milliseconds == LD_WAIT_FOREVER) {
+        if ((status = pthread_cond_wait(cond, mutex)) != 0) {
+            LD_LOG_1(
+                LD_LOG_CRITICAL,
+                "pthread_cond_wait failed: %s",
+                strerror(status));
+        }
+
+        goto done;
+    }
+
     if ((status = LDi_clockGetTime(&ts, LD_CLOCK_REALTIME) == LDBooleanFalse)) {
         goto done;
     }
@@ -774,10 +793,144 @@ LDi_cond_init_imp(ld_cond_t *const cond)
     return status == 0;
 }
 
-ld_mutex_unary_t LDi_mutex_init    = LDi_mutex_init_imp;
+#ifdef LAUNCHDARKLY_LOCK_PROFILE
+/* Acquisitions are attempted without blocking first, so only those that had
+to wait are counted as contended and timed as waiting. */
+
+static LDBoolean
+LDi_mutex_destroy_profiled(ld_mutex_t *const mutex)
+{
+    LDi_lockProfileDestroyed(mutex);
+
+    return LDi_mutex_destroy_imp(mutex);
+}
+
+static LDBoolean
+LDi_mutex_lock_profiled(ld_mutex_t *const mutex)
+{
+    const double requested = LDi_getMonotonicNanoseconds();
+    LDBoolean    contended;
+
+#ifdef _WIN32
+    contended = !TryEnterCriticalSection(mutex);
+#else
+    contended = pthread_mutex_trylock(mutex) != 0;
+#endif
+
+    if (contended && !LDi_mutex_lock_imp(mutex)) {
+        return LDBooleanFalse;
+    }
+
+    LDi_lockProfileAcquired(mutex, LDBooleanTrue, contended, requested);
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_mutex_unlock_profiled(ld_mutex_t *const mutex)
+{
+    LDi_lockProfileReleased(mutex, LDBooleanTrue);
+
+    return LDi_mutex_unlock_imp(mutex);
+}
+
+/* the mutex is released for the duration of the wait */
+static LDBoolean
+LDi_cond_wait_profiled(
+    ld_cond_t *const cond, ld_mutex_t *const mutex, const int milliseconds)
+{
+    LDBoolean status;
+
+    LDi_lockProfileReleased(mutex, LDBooleanTrue);
+
+    status = LDi_cond_wait_imp(cond, mutex, milliseconds);
+
+    LDi_lockProfileAcquired(
+        mutex, LDBooleanTrue, LDBooleanFalse, LDi_getMonotonicNanoseconds());
+
+    return status;
+}
+
+/* with LAUNCHDARKLY_MUTEX_ONLY read write locks are profiled as mutexes */
+#ifndef LAUNCHDARKLY_MUTEX_ONLY
+static LDBoolean
+LDi_rwlock_destroy_profiled(ld_rwlock_t *const lock)
+{
+    LDi_lockProfileDestroyed(lock);
+
+    return LDi_rwlock_destroy_imp(lock);
+}
+
+static LDBoolean
+LDi_rwlock_rdlock_profiled(ld_rwlock_t *const lock)
+{
+    const double requested = LDi_getMonotonicNanoseconds();
+    LDBoolean    contended;
+
+#ifdef _WIN32
+    contended = !TryAcquireSRWLockShared(lock);
+#else
+    contended = pthread_rwlock_tryrdlock(lock) != 0;
+#endif
+
+    if (contended && !LDi_rwlock_rdlock_imp(lock)) {
+        return LDBooleanFalse;
+    }
+
+    LDi_lockProfileAcquired(lock, LDBooleanFalse, contended, requested);
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_rwlock_wrlock_profiled(ld_rwlock_t *const lock)
+{
+    const double requested = LDi_getMonotonicNanoseconds();
+    LDBoolean    contended;
+
+#ifdef _WIN32
+    contended = !TryAcquireSRWLockExclusive(lock);
+#else
+    contended = pthread_rwlock_trywrlock(lock) != 0;
+#endif
+
+    if (contended && !LDi_rwlock_wrlock_imp(lock)) {
+        return LDBooleanFalse;
+    }
+
+    LDi_lockProfileAcquired(lock, LDBooleanTrue, contended, requested);
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_rwlock_rdunlock_profiled(ld_rwlock_t *const lock)
+{
+    LDi_lockProfileReleased(lock, LDBooleanFalse);
+
+    return LDi_rwlock_rdunlock_imp(lock);
+}
+
+static LDBoolean
+LDi_rwlock_wrunlock_profiled(ld_rwlock_t *const lock)
+{
+    LDi_lockProfileReleased(lock, LDBooleanTrue);
+
+    return LDi_rwlock_wrunlock_imp(lock);
+}
+#endif
+#endif
+
+ld_mutex_unary_t LDi_mutex_init = LDi_mutex_init_imp;
+#ifdef LAUNCHDARKLY_LOCK_PROFILE
+ld_mutex_unary_t LDi_mutex_destroy = LDi_mutex_destroy_profiled;
+ld_mutex_unary_t LDi_mutex_lock    = LDi_mutex_lock_profiled;
+ld_mutex_unary_t LDi_mutex_unlock  = LDi_mutex_unlock_profiled;
+#else
 ld_mutex_unary_t LDi_mutex_destroy = LDi_mutex_destroy_imp;
 ld_mutex_unary_t LDi_mutex_lock    = LDi_mutex_lock_imp;
 ld_mutex_unary_t LDi_mutex_unlock  = LDi_mutex_unlock_imp;
+#endif
 
 ld_mutex_unary_t LDi_mutex_nl_init    = LDi_mutex_init_nl_imp;
 ld_mutex_unary_t LDi_mutex_nl_destroy = LDi_mutex_destroy_nl_imp;
@@ -787,14 +940,26 @@ ld_mutex_unary_t LDi_mutex_nl_unlock  = LDi_mutex_unlock_nl_imp;
 ld_thread_join_t   LDi_thread_join   = LDi_thread_join_imp;
 ld_thread_create_t LDi_thread_create = LDi_thread_create_imp;
 
-ld_rwlock_unary_t LDi_rwlock_init     = LDi_rwlock_init_imp;
+ld_rwlock_unary_t LDi_rwlock_init = LDi_rwlock_init_imp;
+#if defined(LAUNCHDARKLY_LOCK_PROFILE) && !defined(LAUNCHDARKLY_MUTEX_ONLY)
+ld_rwlock_unary_t LDi_rwlock_destroy  = LDi_rwlock_destroy_profiled;
+ld_rwlock_unary_t LDi_rwlock_rdlock   = LDi_rwlock_rdlock_profiled;
+ld_rwlock_unary_t LDi_rwlock_wrlock   = LDi_rwlock_wrlock_profiled;
+ld_rwlock_unary_t LDi_rwlock_rdunlock = LDi_rwlock_rdunlock_profiled;
+ld_rwlock_unary_t LDi_rwlock_wrunlock = LDi_rwlock_wrunlock_profiled;
+#else
 ld_rwlock_unary_t LDi_rwlock_destroy  = LDi_rwlock_destroy_imp;
 ld_rwlock_unary_t LDi_rwlock_rdlock   = LDi_rwlock_rdlock_imp;
 ld_rwlock_unary_t LDi_rwlock_wrlock   = LDi_rwlock_wrlock_imp;
 ld_rwlock_unary_t LDi_rwlock_rdunlock = LDi_rwlock_rdunlock_imp;
 ld_rwlock_unary_t LDi_rwlock_wrunlock = LDi_rwlock_wrunlock_imp;
+#endif
 
 ld_cond_unary_t LDi_cond_init    = LDi_cond_init_imp;
-ld_cond_wait_t  LDi_cond_wait    = LDi_cond_wait_imp;
 ld_cond_unary_t LDi_cond_signal  = LDi_cond_signal_imp;
 ld_cond_unary_t LDi_cond_destroy = LDi_cond_destroy_imp;
+#ifdef LAUNCHDARKLY_LOCK_PROFILE
+ld_cond_wait_t LDi_cond_wait = LDi_cond_wait_profiled;
+#else
+ld_cond_wait_t LDi_cond_wait = LDi_cond_wait_imp;
+#endif
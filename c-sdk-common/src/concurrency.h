@@ -2,12 +2,22 @@
 
 #include <launchdarkly/boolean.h>
 
+#include "lock_profile.h"
+
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <pthread.h>
 #endif
 
+/* for small per thread state on hot paths, the initial exec model avoids a
+call to locate the variable on every access from a shared library */
+#ifdef _WIN32
+#define LD_THREAD_LOCAL __declspec(thread)
+#else
+#define LD_THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+#endif
+
 #ifdef _WIN32
 #define THREAD_RETURN DWORD
 #define THREAD_RETURN_DEFAULT 0
@@ -54,6 +64,9 @@ typedef LDBoolean (*ld_cond_unary_t)(ld_cond_t *const cond);
 typedef LDBoolean (*ld_cond_wait_t)(
     ld_cond_t *const cond, ld_mutex_t *const mutex, const int milliseconds);
 
+/* milliseconds for LDi_cond_wait to wait until signaled, however long */
+#define LD_WAIT_FOREVER -1
+
 extern ld_mutex_unary_t LDi_mutex_init;
 extern ld_mutex_unary_t LDi_mutex_destroy;
 extern ld_mutex_unary_t LDi_mutex_lock;
@@ -78,3 +91,102 @@ extern ld_cond_unary_t LDi_cond_init;
 extern ld_cond_wait_t  LDi_cond_wait;
 extern ld_cond_unary_t LDi_cond_signal;
 extern ld_cond_unary_t LDi_cond_destroy;
+
+/* With LAUNCHDARKLY_FAST_LOCKS the hot lock operations are inlined calls to
+the platform rather than calls through the function pointers above, skipping
+tracing and error checks. The pointers remain defined for code built without
+it. Lock profiling needs the wrappers, so it takes precedence. */
+#if defined(LAUNCHDARKLY_FAST_LOCKS) && !defined(LAUNCHDARKLY_LOCK_PROFILE)
+#ifdef _MSC_VER
+#define LD_INLINE __inline
+#else
+#define LD_INLINE __inline__
+#endif
+
+static LD_INLINE LDBoolean
+LDi_mutex_lock_fast(ld_mutex_t *const mutex)
+{
+#ifdef _WIN32
+    EnterCriticalSection(mutex);
+
+    return LDBooleanTrue;
+#else
+    return pthread_mutex_lock(mutex) == 0;
+#endif
+}
+
+static LD_INLINE LDBoolean
+LDi_mutex_unlock_fast(ld_mutex_t *const mutex)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(mutex);
+
+    return LDBooleanTrue;
+#else
+    return pthread_mutex_unlock(mutex) == 0;
+#endif
+}
+
+#define LDi_mutex_lock(mutex) LDi_mutex_lock_fast(mutex)
+#define LDi_mutex_unlock(mutex) LDi_mutex_unlock_fast(mutex)
+
+#ifdef LAUNCHDARKLY_MUTEX_ONLY
+#define LDi_rwlock_rdlock(lock) LDi_mutex_lock_fast(lock)
+#define LDi_rwlock_wrlock(lock) LDi_mutex_lock_fast(lock)
+#define LDi_rwlock_rdunlock(lock) LDi_mutex_unlock_fast(lock)
+#define LDi_rwlock_wrunlock(lock) LDi_mutex_unlock_fast(lock)
+#else
+static LD_INLINE LDBoolean
+LDi_rwlock_rdlock_fast(ld_rwlock_t *const lock)
+{
+#ifdef _WIN32
+    AcquireSRWLockShared(lock);
+
+    return LDBooleanTrue;
+#else
+    return pthread_rwlock_rdlock(lock) == 0;
+#endif
+}
+
+static LD_INLINE LDBoolean
+LDi_rwlock_wrlock_fast(ld_rwlock_t *const lock)
+{
+#ifdef _WIN32
+    AcquireSRWLockExclusive(lock);
+
+    return LDBooleanTrue;
+#else
+    return pthread_rwlock_wrlock(lock) == 0;
+#endif
+}
+
+static LD_INLINE LDBoolean
+LDi_rwlock_rdunlock_fast(ld_rwlock_t *const lock)
+{
+#ifdef _WIN32
+    ReleaseSRWLockShared(lock);
+
+    return LDBooleanTrue;
+#else
+    return pthread_rwlock_unlock(lock) == 0;
+#endif
+}
+
+static LD_INLINE LDBoolean
+LDi_rwlock_wrunlock_fast(ld_rwlock_t *const lock)
+{
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(lock);
+
+    return LDBooleanTrue;
+#else
+    return pthread_rwlock_unlock(lock) == 0;
+#endif
+}
+
+#define LDi_rwlock_rdlock(lock) LDi_rwlock_rdlock_fast(lock)
+#define LDi_rwlock_wrlock(lock) LDi_rwlock_wrlock_fast(lock)
+#define LDi_rwlock_rdunlock(lock) LDi_rwlock_rdunlock_fast(lock)
+#define LDi_rwlock_wrunlock(lock) LDi_rwlock_wrunlock_fast(lock)
+#endif
+#endif
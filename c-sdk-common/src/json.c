@@ -3,6 +3,41 @@
 #include <launchdarkly/json.h>
 
 #include "assertion.h"
+#include "buffer.h"
+#include "json_internal.h"
+
+/* prepares a node for modification, copying contents shared by
+LDJSONFreeze if needed */
+static LDBoolean
+LDi_makeWritable(cJSON *const node)
+{
+    if (node->type & cJSON_IsFrozen) {
+        LD_LOG(LD_LOG_ERROR, "attempted to modify frozen JSON");
+
+        return LDBooleanFalse;
+    }
+
+    if (!cJSON_Unshare(node)) {
+        LD_LOG(LD_LOG_ERROR, "failed to copy shared JSON");
+
+        return LDBooleanFalse;
+    }
+
+    return LDBooleanTrue;
+}
+
+/* a frozen node belongs to a shared structure and cannot be inserted */
+static LDBoolean
+LDi_isInsertable(const cJSON *const node)
+{
+    if (node->type & cJSON_IsFrozen) {
+        LD_LOG(LD_LOG_ERROR, "attempted to insert frozen JSON");
+
+        return LDBooleanFalse;
+    }
+
+    return LDBooleanTrue;
+}
 
 struct LDJSON *
 LDNewNull(void)
@@ -72,6 +107,10 @@ LDSetNumber(struct LDJSON *const rawNode, const double number)
     }
 #endif
 
+    if (!LDi_makeWritable(node)) {
+        return LDBooleanFalse;
+    }
+
     node->valuedouble = number;
 
     return LDBooleanTrue;
@@ -99,6 +138,30 @@ LDJSONDuplicate(const struct LDJSON *const input)
     return (struct LDJSON *)cJSON_Duplicate((cJSON *)input, LDBooleanTrue);
 }
 
+struct LDJSON *
+LDi_JSONShare(const struct LDJSON *const input)
+{
+    LD_ASSERT(input);
+
+    return (struct LDJSON *)cJSON_Share((const cJSON *)input);
+}
+
+LDBoolean
+LDJSONFreeze(struct LDJSON *const json)
+{
+    LD_ASSERT_API(json);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (json == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONFreeze NULL json");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    return cJSON_Freeze((cJSON *)json);
+}
+
 LDJSONType
 LDJSONGetType(const struct LDJSON *const inputRaw)
 {
@@ -339,6 +402,38 @@ LDCollectionDetachIter(
     }
 #endif
 
+    if (iter->type & cJSON_IsFrozen) {
+        /* the iterator refers to shared contents, find its position in the
+        private copy */
+        cJSON *      position;
+        unsigned int index;
+
+        for (index = 0, position = collection->child; position != iter;
+             position = position->next)
+        {
+            if (!position) {
+                return NULL;
+            }
+
+            index++;
+        }
+
+        if (!LDi_makeWritable(collection)) {
+            return NULL;
+        }
+
+        for (position = collection->child; index; index--) {
+            position = position->next;
+        }
+
+        return (struct LDJSON *)cJSON_DetachItemViaPointer(
+            collection, position);
+    }
+
+    if (!LDi_makeWritable(collection)) {
+        return NULL;
+    }
+
     return (struct LDJSON *)cJSON_DetachItemViaPointer(collection, iter);
 }
 
@@ -396,6 +491,10 @@ LDArrayPush(struct LDJSON *const rawArray, struct LDJSON *const item)
     }
 #endif
 
+    if (!LDi_makeWritable(array) || !LDi_isInsertable((cJSON *)item)) {
+        return LDBooleanFalse;
+    }
+
     cJSON_AddItemToArray(array, (cJSON *)item);
 
     return LDBooleanTrue;
@@ -440,6 +539,10 @@ LDArrayAppend(
     }
 #endif
 
+    if (!LDi_makeWritable(prefix)) {
+        return LDBooleanFalse;
+    }
+
     for (iter = suffix->child; iter; iter = iter->next) {
         cJSON *dupe;
 
@@ -524,6 +627,10 @@ LDObjectSetKey(
     }
 #endif
 
+    if (!LDi_makeWritable(object) || !LDi_isInsertable((cJSON *)item)) {
+        return LDBooleanFalse;
+    }
+
     cJSON_DeleteItemFromObjectCaseSensitive(object, key);
 
     cJSON_AddItemToObject(object, key, (cJSON *)item);
@@ -560,6 +667,10 @@ LDObjectDeleteKey(struct LDJSON *const rawObject, const char *const key)
     }
 #endif
 
+    if (!LDi_makeWritable(object)) {
+        return;
+    }
+
     cJSON_DeleteItemFromObjectCaseSensitive(object, key);
 }
 
@@ -592,6 +703,10 @@ LDObjectDetachKey(struct LDJSON *const rawObject, const char *const key)
     }
 #endif
 
+    if (!LDi_makeWritable(object)) {
+        return NULL;
+    }
+
     return (struct LDJSON *)cJSON_DetachItemFromObjectCaseSensitive(
         object, key);
 }
@@ -632,6 +747,10 @@ LDObjectMerge(struct LDJSON *const to, const struct LDJSON *const from)
     }
 #endif
 
+    if (!LDi_makeWritable((cJSON *)to)) {
+        return LDBooleanFalse;
+    }
+
     for (iter = LDGetIter(from); iter; iter = LDIterNext(iter)) {
         struct LDJSON *duplicate;
 
@@ -661,6 +780,41 @@ LDJSONSerialize(const struct LDJSON *const json)
     return cJSON_PrintUnformatted((cJSON *)json);
 }
 
+LDBoolean
+LDJSONSerializeTo(
+    const struct LDJSON *const json, struct LDBuffer *const buffer)
+{
+    LD_ASSERT_API(json);
+    LD_ASSERT_API(buffer);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (json == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONSerializeTo NULL json");
+
+        return LDBooleanFalse;
+    }
+
+    if (buffer == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONSerializeTo NULL buffer");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    if (!LDBufferReserve(
+            buffer, cJSON_EstimatePrintedLength((const cJSON *)json)))
+    {
+        return LDBooleanFalse;
+    }
+
+    return cJSON_PrintAppend(
+        (const cJSON *)json,
+        &buffer->data,
+        &buffer->size,
+        &buffer->capacity,
+        LDBooleanFalse);
+}
+
 struct LDJSON *
 LDJSONDeserialize(const char *const text)
 {
@@ -676,3 +830,19 @@ LDJSONDeserialize(const char *const text)
 
     return (struct LDJSON *)cJSON_Parse(text);
 }
+
+struct LDJSON *
+LDJSONDeserializeArena(const char *const text)
+{
+    LD_ASSERT_API(text);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (text == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDJSONDeserializeArena NULL text");
+
+        return NULL;
+    }
+#endif
+
+    return (struct LDJSON *)cJSON_ParseArena(text);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <launchdarkly/json.h>
+
+/* as LDJSONDuplicate, except the contents of a structure frozen with
+LDJSONFreeze are shared in constant time. Values nested in the result are
+frozen, so it is for copies the SDK only reads or changes at the top level. */
+struct LDJSON *
+LDi_JSONShare(const struct LDJSON *const json);
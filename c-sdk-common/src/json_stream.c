@@ -0,0 +1,719 @@
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "json_stream.h"
+
+/* same nesting limit as the tree parser */
+#define LD_JSON_STREAM_NESTING_LIMIT 1000
+#define LD_JSON_STREAM_MIN_CAPACITY 64
+
+enum
+{
+    LD_JSON_STREAM_VALUE,
+    LD_JSON_STREAM_VALUE_OR_ARRAY_END,
+    LD_JSON_STREAM_KEY_OR_OBJECT_END,
+    LD_JSON_STREAM_KEY,
+    LD_JSON_STREAM_COLON,
+    LD_JSON_STREAM_COMMA_OR_END,
+    LD_JSON_STREAM_STRING,
+    LD_JSON_STREAM_NUMBER,
+    LD_JSON_STREAM_LITERAL,
+    LD_JSON_STREAM_DONE
+};
+
+void
+LDJSONStreamParserInitialize(
+    struct LDJSONStreamParser *const parser,
+    ld_json_stream_handler           handler,
+    void *const                      context)
+{
+    LD_ASSERT(parser);
+    LD_ASSERT(handler);
+
+    parser->handler         = handler;
+    parser->context         = context;
+    parser->stack           = NULL;
+    parser->depth           = 0;
+    parser->stackCapacity   = 0;
+    parser->state           = LD_JSON_STREAM_VALUE;
+    parser->token           = NULL;
+    parser->tokenSize       = 0;
+    parser->tokenCapacity   = 0;
+    parser->tokenIsKey      = LDBooleanFalse;
+    parser->literal         = NULL;
+    parser->escape          = 0;
+    parser->codepoint       = 0;
+    parser->highSurrogate   = 0;
+    parser->failed          = LDBooleanFalse;
+    parser->cursor          = NULL;
+    parser->capturing       = LDBooleanFalse;
+    parser->captureFrom     = NULL;
+    parser->capture         = NULL;
+    parser->captureSize     = 0;
+    parser->captureCapacity = 0;
+}
+
+void
+LDJSONStreamParserDestroy(struct LDJSONStreamParser *const parser)
+{
+    if (parser) {
+        LDFree(parser->stack);
+        LDFree(parser->token);
+        LDFree(parser->capture);
+
+        parser->stack   = NULL;
+        parser->token   = NULL;
+        parser->capture = NULL;
+    }
+}
+
+static LDBoolean
+LDi_reserve(
+    char **const  buffer,
+    size_t *const capacity,
+    const size_t  required)
+{
+    char * bufferTmp;
+    size_t newCapacity;
+
+    if (required <= *capacity) {
+        return LDBooleanTrue;
+    }
+
+    newCapacity = *capacity * 2;
+
+    if (newCapacity < LD_JSON_STREAM_MIN_CAPACITY) {
+        newCapacity = LD_JSON_STREAM_MIN_CAPACITY;
+    }
+
+    if (newCapacity < required) {
+        newCapacity = required;
+    }
+
+    if (!(bufferTmp = (char *)LDRealloc(*buffer, newCapacity))) {
+        return LDBooleanFalse;
+    }
+
+    *buffer   = bufferTmp;
+    *capacity = newCapacity;
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_tokenAppend(
+    struct LDJSONStreamParser *const parser,
+    const char *const                data,
+    const size_t                     size)
+{
+    if (!LDi_reserve(
+            &parser->token,
+            &parser->tokenCapacity,
+            parser->tokenSize + size + 1))
+    {
+        return LDBooleanFalse;
+    }
+
+    memcpy(parser->token + parser->tokenSize, data, size);
+
+    parser->tokenSize += size;
+    parser->token[parser->tokenSize] = '\0';
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_tokenAppendCodepoint(
+    struct LDJSONStreamParser *const parser, const unsigned long codepoint)
+{
+    char   encoded[4];
+    size_t size;
+
+    if (codepoint < 0x80) {
+        encoded[0] = (char)codepoint;
+        size       = 1;
+    } else if (codepoint < 0x800) {
+        encoded[0] = (char)(0xC0 | (codepoint >> 6));
+        encoded[1] = (char)(0x80 | (codepoint & 0x3F));
+        size       = 2;
+    } else if (codepoint < 0x10000) {
+        encoded[0] = (char)(0xE0 | (codepoint >> 12));
+        encoded[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        encoded[2] = (char)(0x80 | (codepoint & 0x3F));
+        size       = 3;
+    } else {
+        encoded[0] = (char)(0xF0 | (codepoint >> 18));
+        encoded[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        encoded[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        encoded[3] = (char)(0x80 | (codepoint & 0x3F));
+        size       = 4;
+    }
+
+    return LDi_tokenAppend(parser, encoded, size);
+}
+
+static void
+LDi_emit(
+    struct LDJSONStreamParser *const parser,
+    const enum LDJSONStreamToken     token,
+    const double                     number)
+{
+    const char *text;
+    size_t      textSize;
+
+    text     = "";
+    textSize = 0;
+
+    if (token == LDJSONStreamKey || token == LDJSONStreamText) {
+        if (parser->token) {
+            text     = parser->token;
+            textSize = parser->tokenSize;
+        }
+    }
+
+    if (!parser->handler(token, text, textSize, number, parser->context)) {
+        parser->failed = LDBooleanTrue;
+    }
+}
+
+static void
+LDi_afterValue(struct LDJSONStreamParser *const parser)
+{
+    if (parser->depth) {
+        parser->state = LD_JSON_STREAM_COMMA_OR_END;
+    } else {
+        parser->state = LD_JSON_STREAM_DONE;
+    }
+}
+
+static void
+LDi_openContainer(struct LDJSONStreamParser *const parser, const char kind)
+{
+    if (parser->depth >= LD_JSON_STREAM_NESTING_LIMIT) {
+        LD_LOG(LD_LOG_ERROR, "JSON stream nesting limit exceeded");
+
+        parser->failed = LDBooleanTrue;
+
+        return;
+    }
+
+    if (!LDi_reserve(
+            &parser->stack, &parser->stackCapacity, parser->depth + 1))
+    {
+        parser->failed = LDBooleanTrue;
+
+        return;
+    }
+
+    parser->stack[parser->depth++] = kind;
+
+    if (kind == '{') {
+        parser->state = LD_JSON_STREAM_KEY_OR_OBJECT_END;
+
+        LDi_emit(parser, LDJSONStreamObjectStart, 0);
+    } else {
+        parser->state = LD_JSON_STREAM_VALUE_OR_ARRAY_END;
+
+        LDi_emit(parser, LDJSONStreamArrayStart, 0);
+    }
+}
+
+/* appends the captured bytes of the current chunk up to end */
+static LDBoolean
+LDi_captureAppend(struct LDJSONStreamParser *const parser, const char *const end)
+{
+    const size_t size = end - parser->captureFrom;
+
+    if (!LDi_reserve(
+            &parser->capture,
+            &parser->captureCapacity,
+            parser->captureSize + size))
+    {
+        return LDBooleanFalse;
+    }
+
+    memcpy(parser->capture + parser->captureSize, parser->captureFrom, size);
+
+    parser->captureSize += size;
+    parser->captureFrom = end;
+
+    return LDBooleanTrue;
+}
+
+static void
+LDi_closeContainer(struct LDJSONStreamParser *const parser, const char kind)
+{
+    if (parser->depth == 0 || parser->stack[parser->depth - 1] != kind) {
+        parser->failed = LDBooleanTrue;
+
+        return;
+    }
+
+    parser->depth--;
+
+    LDi_afterValue(parser);
+
+    if (kind == '{') {
+        LDi_emit(parser, LDJSONStreamObjectEnd, 0);
+    } else {
+        LDi_emit(parser, LDJSONStreamArrayEnd, 0);
+    }
+}
+
+static void
+LDi_startString(struct LDJSONStreamParser *const parser, const LDBoolean isKey)
+{
+    parser->state         = LD_JSON_STREAM_STRING;
+    parser->tokenSize     = 0;
+    parser->tokenIsKey    = isKey;
+    parser->escape        = 0;
+    parser->highSurrogate = 0;
+
+    if (parser->token) {
+        parser->token[0] = '\0';
+    }
+}
+
+static void
+LDi_startValue(struct LDJSONStreamParser *const parser, const char c)
+{
+    switch (c) {
+    case '{':
+        LDi_openContainer(parser, '{');
+        break;
+    case '[':
+        LDi_openContainer(parser, '[');
+        break;
+    case '"':
+        LDi_startString(parser, LDBooleanFalse);
+        break;
+    case 't':
+        parser->literal = "true";
+        break;
+    case 'f':
+        parser->literal = "false";
+        break;
+    case 'n':
+        parser->literal = "null";
+        break;
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            parser->state     = LD_JSON_STREAM_NUMBER;
+            parser->tokenSize = 0;
+
+            if (!LDi_tokenAppend(parser, &c, 1)) {
+                parser->failed = LDBooleanTrue;
+            }
+        } else {
+            parser->failed = LDBooleanTrue;
+        }
+
+        return;
+    }
+
+    if (c == 't' || c == 'f' || c == 'n') {
+        parser->state     = LD_JSON_STREAM_LITERAL;
+        parser->tokenSize = 1;
+    }
+}
+
+static void
+LDi_finishNumber(struct LDJSONStreamParser *const parser)
+{
+    char * end, *point;
+    double number;
+
+    LD_ASSERT(parser->token);
+
+    /* strtod expects the decimal point of the current locale, the token is
+    discarded afterwards so it is changed in place */
+    if ((point = strchr(parser->token, '.'))) {
+        *point = localeconv()->decimal_point[0];
+    }
+
+    number = strtod(parser->token, &end);
+
+    if (end != parser->token + parser->tokenSize) {
+        parser->failed = LDBooleanTrue;
+
+        return;
+    }
+
+    LDi_afterValue(parser);
+
+    LDi_emit(parser, LDJSONStreamNumber, number);
+}
+
+static void
+LDi_finishLiteral(struct LDJSONStreamParser *const parser)
+{
+    enum LDJSONStreamToken token;
+
+    switch (parser->literal[0]) {
+    case 't':
+        token = LDJSONStreamTrue;
+        break;
+    case 'f':
+        token = LDJSONStreamFalse;
+        break;
+    default:
+        token = LDJSONStreamNull;
+        break;
+    }
+
+    LDi_afterValue(parser);
+
+    LDi_emit(parser, token, 0);
+}
+
+static int
+LDi_hexValue(const char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+static void
+LDi_finishCodepoint(struct LDJSONStreamParser *const parser)
+{
+    unsigned long codepoint;
+
+    codepoint = parser->codepoint;
+
+    if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+        if (parser->highSurrogate) {
+            parser->failed = LDBooleanTrue;
+        } else {
+            parser->highSurrogate = codepoint;
+        }
+
+        return;
+    }
+
+    if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+        if (!parser->highSurrogate) {
+            parser->failed = LDBooleanTrue;
+
+            return;
+        }
+
+        codepoint = 0x10000 + ((parser->highSurrogate - 0xD800) << 10) +
+            (codepoint - 0xDC00);
+
+        parser->highSurrogate = 0;
+    } else if (parser->highSurrogate) {
+        parser->failed = LDBooleanTrue;
+
+        return;
+    }
+
+    if (!LDi_tokenAppendCodepoint(parser, codepoint)) {
+        parser->failed = LDBooleanTrue;
+    }
+}
+
+/* returns the number of bytes consumed */
+static size_t
+LDi_processString(
+    struct LDJSONStreamParser *const parser,
+    const char *const                buffer,
+    const size_t                     bufferSize)
+{
+    const char c = buffer[0];
+
+    if (parser->escape == 0) {
+        size_t run;
+
+        if (parser->highSurrogate && c != '\\') {
+            parser->failed = LDBooleanTrue;
+
+            return 0;
+        }
+
+        /* copy a run of plain bytes at once */
+        for (run = 0; run < bufferSize; run++) {
+            const unsigned char current = (unsigned char)buffer[run];
+
+            if (current == '"' || current == '\\' || current < 0x20) {
+                break;
+            }
+        }
+
+        if (run) {
+            if (!LDi_tokenAppend(parser, buffer, run)) {
+                parser->failed = LDBooleanTrue;
+            }
+
+            return run;
+        }
+
+        if (c == '"') {
+            if (parser->tokenIsKey) {
+                parser->state = LD_JSON_STREAM_COLON;
+
+                LDi_emit(parser, LDJSONStreamKey, 0);
+            } else {
+                LDi_afterValue(parser);
+
+                LDi_emit(parser, LDJSONStreamText, 0);
+            }
+        } else if (c == '\\') {
+            parser->escape = 1;
+        } else {
+            /* unescaped control character */
+            parser->failed = LDBooleanTrue;
+        }
+    } else if (parser->escape == 1) {
+        char unescaped;
+
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            unescaped = c;
+            break;
+        case 'b':
+            unescaped = '\b';
+            break;
+        case 'f':
+            unescaped = '\f';
+            break;
+        case 'n':
+            unescaped = '\n';
+            break;
+        case 'r':
+            unescaped = '\r';
+            break;
+        case 't':
+            unescaped = '\t';
+            break;
+        case 'u':
+            parser->escape    = 2;
+            parser->codepoint = 0;
+
+            return 1;
+        default:
+            parser->failed = LDBooleanTrue;
+
+            return 0;
+        }
+
+        parser->escape = 0;
+
+        if (parser->highSurrogate || !LDi_tokenAppend(parser, &unescaped, 1)) {
+            parser->failed = LDBooleanTrue;
+        }
+    } else {
+        const int digit = LDi_hexValue(c);
+
+        if (digit < 0) {
+            parser->failed = LDBooleanTrue;
+
+            return 0;
+        }
+
+        parser->codepoint = parser->codepoint * 16 + digit;
+
+        /* four digits follow the u */
+        if (++parser->escape == 6) {
+            parser->escape = 0;
+
+            LDi_finishCodepoint(parser);
+        }
+    }
+
+    return 1;
+}
+
+LDBoolean
+LDJSONStreamParserProcess(
+    struct LDJSONStreamParser *const parser,
+    const char *const                buffer,
+    const size_t                     bufferSize)
+{
+    size_t i;
+
+    LD_ASSERT(parser);
+    LD_ASSERT(buffer || bufferSize == 0);
+
+    i = 0;
+
+    if (parser->capturing) {
+        parser->captureFrom = buffer;
+    }
+
+    while (i < bufferSize && !parser->failed) {
+        const char c = buffer[i];
+
+        if (parser->state == LD_JSON_STREAM_STRING) {
+            i += LDi_processString(parser, buffer + i, bufferSize - i);
+
+            continue;
+        }
+
+        if (parser->state == LD_JSON_STREAM_NUMBER) {
+            if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' ||
+                c == '+' || c == '-')
+            {
+                if (!LDi_tokenAppend(parser, &c, 1)) {
+                    parser->failed = LDBooleanTrue;
+                }
+
+                i++;
+            } else {
+                /* the terminating byte is processed in the next state */
+                LDi_finishNumber(parser);
+            }
+
+            continue;
+        }
+
+        if (parser->state == LD_JSON_STREAM_LITERAL) {
+            if (c != parser->literal[parser->tokenSize]) {
+                parser->failed = LDBooleanTrue;
+            } else if (parser->literal[++parser->tokenSize] == '\0') {
+                LDi_finishLiteral(parser);
+            }
+
+            i++;
+
+            continue;
+        }
+
+        i++;
+
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            continue;
+        }
+
+        parser->cursor = buffer + i;
+
+        switch (parser->state) {
+        case LD_JSON_STREAM_VALUE_OR_ARRAY_END:
+            if (c == ']') {
+                LDi_closeContainer(parser, '[');
+
+                break;
+            }
+            /* fallthrough */
+        case LD_JSON_STREAM_VALUE:
+            LDi_startValue(parser, c);
+            break;
+        case LD_JSON_STREAM_KEY_OR_OBJECT_END:
+            if (c == '}') {
+                LDi_closeContainer(parser, '{');
+
+                break;
+            }
+            /* fallthrough */
+        case LD_JSON_STREAM_KEY:
+            if (c == '"') {
+                LDi_startString(parser, LDBooleanTrue);
+            } else {
+                parser->failed = LDBooleanTrue;
+            }
+            break;
+        case LD_JSON_STREAM_COLON:
+            if (c == ':') {
+                parser->state = LD_JSON_STREAM_VALUE;
+            } else {
+                parser->failed = LDBooleanTrue;
+            }
+            break;
+        case LD_JSON_STREAM_COMMA_OR_END:
+            if (c == ',') {
+                if (parser->stack[parser->depth - 1] == '{') {
+                    parser->state = LD_JSON_STREAM_KEY;
+                } else {
+                    parser->state = LD_JSON_STREAM_VALUE;
+                }
+            } else if (c == '}') {
+                LDi_closeContainer(parser, '{');
+            } else if (c == ']') {
+                LDi_closeContainer(parser, '[');
+            } else {
+                parser->failed = LDBooleanTrue;
+            }
+            break;
+        default:
+            /* trailing data after the document */
+            parser->failed = LDBooleanTrue;
+            break;
+        }
+    }
+
+    /* the rest of the chunk belongs to a capture that continues in the next */
+    if (parser->capturing && !parser->failed) {
+        if (!LDi_captureAppend(parser, buffer + bufferSize)) {
+            parser->failed = LDBooleanTrue;
+        }
+    }
+
+    return !parser->failed;
+}
+
+void
+LDJSONStreamParserBeginCapture(struct LDJSONStreamParser *const parser)
+{
+    LD_ASSERT(parser);
+    LD_ASSERT(parser->cursor);
+    LD_ASSERT(!parser->capturing);
+
+    /* the cursor is just past the opening bracket */
+    parser->capturing   = LDBooleanTrue;
+    parser->captureFrom = parser->cursor - 1;
+    parser->captureSize = 0;
+}
+
+char *
+LDJSONStreamParserEndCapture(
+    struct LDJSONStreamParser *const parser, size_t *const size)
+{
+    char *result;
+
+    LD_ASSERT(parser);
+    LD_ASSERT(size);
+    LD_ASSERT(parser->capturing);
+
+    parser->capturing = LDBooleanFalse;
+
+    if (!LDi_captureAppend(parser, parser->cursor)) {
+        return NULL;
+    }
+
+    /* exactly sized, the capture buffer itself is reused */
+    if (!(result = (char *)LDAlloc(parser->captureSize + 1))) {
+        return NULL;
+    }
+
+    memcpy(result, parser->capture, parser->captureSize);
+    result[parser->captureSize] = '\0';
+
+    *size = parser->captureSize;
+
+    return result;
+}
+
+LDBoolean
+LDJSONStreamParserFinish(struct LDJSONStreamParser *const parser)
+{
+    LD_ASSERT(parser);
+
+    /* a top level number has no terminator */
+    if (!parser->failed && parser->state == LD_JSON_STREAM_NUMBER) {
+        LDi_finishNumber(parser);
+    }
+
+    return !parser->failed && parser->state == LD_JSON_STREAM_DONE;
+}
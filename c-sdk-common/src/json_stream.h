@@ -0,0 +1,99 @@
+/*!
+ * @file json_stream.h
+ * @brief Internal incremental JSON tokenizer.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+
+enum LDJSONStreamToken
+{
+    LDJSONStreamObjectStart,
+    LDJSONStreamObjectEnd,
+    LDJSONStreamArrayStart,
+    LDJSONStreamArrayEnd,
+    LDJSONStreamKey,
+    LDJSONStreamText,
+    LDJSONStreamNumber,
+    LDJSONStreamTrue,
+    LDJSONStreamFalse,
+    LDJSONStreamNull
+};
+
+/* Text is only provided for keys and text, is NUL terminated, and is only
+valid for the duration of the call. Number is only meaningful for numbers.
+Returning false stops the parser. */
+typedef LDBoolean (*ld_json_stream_handler)(
+    const enum LDJSONStreamToken token,
+    const char *const            text,
+    const size_t                 textSize,
+    const double                 number,
+    void *const                  context);
+
+/* Tokenizes a single JSON document delivered in arbitrarily split chunks.
+Tokens are reported as soon as they are complete, so neither the document text
+nor a tree is ever held in memory. Only the token currently being read is
+buffered. */
+struct LDJSONStreamParser
+{
+    ld_json_stream_handler handler;
+    void *                 context;
+    /* one byte per open container, '{' or '[' */
+    char *                 stack;
+    size_t                 depth;
+    size_t                 stackCapacity;
+    int                    state;
+    /* partially read key, text, number, or literal */
+    char *                 token;
+    size_t                 tokenSize;
+    size_t                 tokenCapacity;
+    LDBoolean              tokenIsKey;
+    const char *           literal;
+    /* escape sequence progress within a string */
+    int                    escape;
+    unsigned long          codepoint;
+    unsigned long          highSurrogate;
+    LDBoolean              failed;
+    /* just past the byte being processed */
+    const char *           cursor;
+    /* raw text of a container being captured */
+    LDBoolean              capturing;
+    const char *           captureFrom;
+    char *                 capture;
+    size_t                 captureSize;
+    size_t                 captureCapacity;
+};
+
+void
+LDJSONStreamParserInitialize(
+    struct LDJSONStreamParser *const parser,
+    ld_json_stream_handler           handler,
+    void *const                      context);
+
+void
+LDJSONStreamParserDestroy(struct LDJSONStreamParser *const parser);
+
+LDBoolean
+LDJSONStreamParserProcess(
+    struct LDJSONStreamParser *const parser,
+    const char *const                buffer,
+    const size_t                     bufferSize);
+
+/* Called from the handler of an object or array start to collect the raw text
+of that container, whitespace included, as it is read. The handler of the
+matching end must call LDJSONStreamParserEndCapture. */
+void
+LDJSONStreamParserBeginCapture(struct LDJSONStreamParser *const parser);
+
+/* returns the captured text as a null terminated string to be released with
+LDFree, or NULL on failure */
+char *
+LDJSONStreamParserEndCapture(
+    struct LDJSONStreamParser *const parser, size_t *const size);
+
+/* call after the last chunk, fails if the document is incomplete */
+LDBoolean
+LDJSONStreamParserFinish(struct LDJSONStreamParser *const parser);
@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+#include <launchdarkly/profile.h>
+
+#ifdef LAUNCHDARKLY_LOCK_PROFILE
+#include "assertion.h"
+#include "atomic.h"
+#include "buffer.h"
+#include "lock_profile.h"
+#include "utility.h"
+
+/* larger than the number of locks the SDK holds at once, locks beyond it are
+not profiled */
+#define LD_LOCK_PROFILE_SLOTS 1024
+
+struct LDLockProfile
+{
+    /* claimed with a compare and swap, a slot of a destroyed lock is kept for
+    the report until the table has no free slot for a new lock */
+    void *      lock;
+    const char *label;
+    /* labeled and not yet destroyed, memory of a destroyed lock may be
+    reused by an unlabeled one */
+    ld_atomic_t active;
+    ld_atomic_t acquisitions;
+    ld_atomic_t contended;
+    /* nanoseconds, 64 bits as 32 overflow in about two seconds */
+    ld_atomic64_t waitTotal;
+    ld_atomic64_t waitMax;
+    ld_atomic64_t holdTotal;
+    ld_atomic64_t holdMax;
+    /* written and read only by the exclusive holder */
+    double acquired;
+};
+
+static struct LDLockProfile profiles[LD_LOCK_PROFILE_SLOTS];
+
+/* finds the slot of a lock, claiming one if requested, NULL if the lock has
+no slot or every slot belongs to a lock that is not destroyed */
+static struct LDLockProfile *
+LDi_lockProfileFind(const void *const lock, const LDBoolean claim)
+{
+    struct LDLockProfile *destroyed;
+    void *                destroyedLock;
+    unsigned long         index, probes;
+
+    /* locks are aligned, the low bits carry no information */
+    index = ((unsigned long)(size_t)lock >> 4) * 2654435761UL;
+
+    destroyed     = NULL;
+    destroyedLock = NULL;
+
+    for (probes = 0; probes < LD_LOCK_PROFILE_SLOTS; probes++, index++) {
+        struct LDLockProfile *const profile =
+            &profiles[index % LD_LOCK_PROFILE_SLOTS];
+        void *const current = LDi_atomicLoadPointer(&profile->lock);
+
+        if (current == lock) {
+            return profile;
+        }
+
+        if (current == NULL) {
+            if (!claim) {
+                return NULL;
+            }
+
+            if (LDi_atomicCompareExchangePointer(
+                    &profile->lock, NULL, (void *)lock) ||
+                LDi_atomicLoadPointer(&profile->lock) == lock)
+            {
+                return profile;
+            }
+        } else if (!destroyed && !LDi_atomicLoad(&profile->active)) {
+            destroyed     = profile;
+            destroyedLock = current;
+        }
+    }
+
+    /* the table is full, take over the slot of a destroyed lock */
+    if (claim && destroyed &&
+        LDi_atomicCompareExchangePointer(
+            &destroyed->lock, destroyedLock, (void *)lock))
+    {
+        return destroyed;
+    }
+
+    return NULL;
+}
+
+/* the slot of a labeled lock that has not been destroyed */
+static struct LDLockProfile *
+LDi_lockProfileActive(const void *const lock)
+{
+    struct LDLockProfile *const profile =
+        LDi_lockProfileFind(lock, LDBooleanFalse);
+
+    if (profile && LDi_atomicLoad(&profile->active)) {
+        return profile;
+    }
+
+    return NULL;
+}
+
+static void
+LDi_lockProfileMax(ld_atomic64_t *const max, const int64_t value)
+{
+    int64_t current;
+
+    while ((current = LDi_atomicLoad64(max)) < value) {
+        if (LDi_atomicCompareExchange64(max, current, value)) {
+            break;
+        }
+    }
+}
+
+void
+LDi_lockProfileLabel(const void *const lock, const char *const label)
+{
+    struct LDLockProfile *profile;
+
+    LD_ASSERT(lock);
+    LD_ASSERT(label);
+
+    if ((profile = LDi_lockProfileFind(lock, LDBooleanTrue))) {
+        profile->label = label;
+
+        /* the slot may hold statistics of a destroyed lock */
+        LDi_atomicStore(&profile->acquisitions, 0);
+        LDi_atomicStore(&profile->contended, 0);
+        LDi_atomicStore64(&profile->waitTotal, 0);
+        LDi_atomicStore64(&profile->waitMax, 0);
+        LDi_atomicStore64(&profile->holdTotal, 0);
+        LDi_atomicStore64(&profile->holdMax, 0);
+
+        LDi_atomicStore(&profile->active, 1);
+    }
+}
+
+void
+LDi_lockProfileDestroyed(const void *const lock)
+{
+    struct LDLockProfile *profile;
+
+    if ((profile = LDi_lockProfileActive(lock))) {
+        LDi_atomicStore(&profile->active, 0);
+    }
+}
+
+void
+LDi_lockProfileAcquired(
+    const void *const lock,
+    const LDBoolean   exclusive,
+    const LDBoolean   contended,
+    const double      requested)
+{
+    struct LDLockProfile *profile;
+    double                now;
+
+    if (!(profile = LDi_lockProfileActive(lock))) {
+        return;
+    }
+
+    now = LDi_getMonotonicNanoseconds();
+
+    LDi_atomicIncrement(&profile->acquisitions);
+
+    if (contended) {
+        const int64_t waited = (int64_t)(now - requested);
+
+        LDi_atomicIncrement(&profile->contended);
+        LDi_atomicAdd64(&profile->waitTotal, waited);
+        LDi_lockProfileMax(&profile->waitMax, waited);
+    }
+
+    if (exclusive) {
+        profile->acquired = now;
+    }
+}
+
+void
+LDi_lockProfileReleased(const void *const lock, const LDBoolean exclusive)
+{
+    struct LDLockProfile *profile;
+    int64_t               held;
+
+    if (!exclusive || !(profile = LDi_lockProfileActive(lock))) {
+        return;
+    }
+
+    held = (int64_t)(LDi_getMonotonicNanoseconds() - profile->acquired);
+
+    LDi_atomicAdd64(&profile->holdTotal, held);
+    LDi_lockProfileMax(&profile->holdMax, held);
+}
+
+/* orders by total wait, most first */
+static int
+LDi_lockProfileCompare(const void *const left, const void *const right)
+{
+    const int64_t leftWait =
+        LDi_atomicLoad64(&(*(struct LDLockProfile *const *)left)->waitTotal);
+    const int64_t rightWait =
+        LDi_atomicLoad64(&(*(struct LDLockProfile *const *)right)->waitTotal);
+
+    return (leftWait < rightWait) - (leftWait > rightWait);
+}
+
+char *
+LDLockProfileReport(const unsigned int limit)
+{
+    struct LDLockProfile **sorted;
+    struct LDBuffer        report;
+    unsigned int           count, i;
+    char *                 result;
+
+    if (!(sorted = (struct LDLockProfile **)LDAlloc(
+              sizeof(struct LDLockProfile *) * LD_LOCK_PROFILE_SLOTS)))
+    {
+        return NULL;
+    }
+
+    for (i = 0, count = 0; i < LD_LOCK_PROFILE_SLOTS; i++) {
+        if (LDi_atomicLoad(&profiles[i].acquisitions)) {
+            sorted[count++] = &profiles[i];
+        }
+    }
+
+    qsort(sorted, count, sizeof(*sorted), LDi_lockProfileCompare);
+
+    memset(&report, 0, sizeof(report));
+
+    for (i = 0; i < count && i < limit; i++) {
+        const struct LDLockProfile *const profile = sorted[i];
+        char                              line[256];
+        int                               length;
+
+        length = snprintf(
+            line,
+            sizeof(line),
+            "%s %p acquisitions=%ld contended=%ld wait_total_us=%.1f "
+            "wait_max_us=%.1f hold_total_us=%.1f hold_max_us=%.1f\n",
+            profile->label ? profile->label : "unlabeled",
+            profile->lock,
+            LDi_atomicLoad(&profile->acquisitions),
+            LDi_atomicLoad(&profile->contended),
+            LDi_atomicLoad64(&profile->waitTotal) / 1000.0,
+            LDi_atomicLoad64(&profile->waitMax) / 1000.0,
+            LDi_atomicLoad64(&profile->holdTotal) / 1000.0,
+            LDi_atomicLoad64(&profile->holdMax) / 1000.0);
+
+        if (length < 0 || (size_t)length >= sizeof(line) ||
+            !LDBufferAppend(&report, line, length))
+        {
+            LDFree(report.data);
+            LDFree(sorted);
+
+            return NULL;
+        }
+    }
+
+    LDFree(sorted);
+
+    if (!(result = LDi_bufferDetach(&report))) {
+        LDFree(report.data);
+    }
+
+    return result;
+}
+#else
+char *
+LDLockProfileReport(const unsigned int limit)
+{
+    (void)limit;
+
+    return NULL;
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <launchdarkly/boolean.h>
+
+/* Records acquisition statistics per lock instance when the SDK is built
+with LAUNCHDARKLY_LOCK_PROFILE. Statistics are kept in a fixed table keyed by
+the address of the lock so that lock types are unchanged. Only labeled locks
+are profiled, which leaves out the many short lived locks of reference counts.
+The concurrency wrappers call the recording functions, other code only labels
+locks after initializing them. */
+
+#ifdef LAUNCHDARKLY_LOCK_PROFILE
+/* label must outlive the lock, normally a literal */
+void
+LDi_lockProfileLabel(const void *const lock, const char *const label);
+
+void
+LDi_lockProfileDestroyed(const void *const lock);
+
+void
+LDi_lockProfileAcquired(
+    const void *const lock,
+    const LDBoolean   exclusive,
+    const LDBoolean   contended,
+    const double      requested);
+
+void
+LDi_lockProfileReleased(const void *const lock, const LDBoolean exclusive);
+#else
+#define LDi_lockProfileLabel(lock, label)
+#endif
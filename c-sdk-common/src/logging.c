@@ -10,6 +10,8 @@ static LDLogLevel sdkloggerlevel = LD_LOG_INFO;
 static void (*sdklogger)(const LDLogLevel level, const char *const text) = NULL;
 static ld_mutex_t basicLoggerLock;
 
+int LDi_logThreshold = -1;
+
 const char *
 LDLogLevelToString(const LDLogLevel level)
 {
@@ -75,8 +77,15 @@ LDConfigureGlobalLogger(
     const LDLogLevel level,
     void (*logger)(const LDLogLevel level, const char *const text))
 {
-    sdklogger      = logger;
-    sdkloggerlevel = level;
+    sdklogger        = logger;
+    sdkloggerlevel   = level;
+    LDi_logThreshold = logger ? (int)level : -1;
+}
+
+LDBoolean
+LDi_logEnabled(const LDLogLevel level)
+{
+    return (int)level <= LDi_logThreshold;
 }
 
 void
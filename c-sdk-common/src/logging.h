@@ -3,10 +3,16 @@
 #include <launchdarkly/logging.h>
 
 #define LD_LOG_1(level, format, x)                                             \
-    LDi_log(level, "[%s, %d] " format, __FILE__, __LINE__, x)
+    (LD_LOG_ENABLED(level)                                                     \
+         ? LDi_log(level, "[%s, %d] " format, __FILE__, __LINE__, x)           \
+         : (void)0)
 
 #define LD_LOG_2(level, format, x, y)                                          \
-    LDi_log(level, "[%s, %d] " format, __FILE__, __LINE__, x, y)
+    (LD_LOG_ENABLED(level)                                                     \
+         ? LDi_log(level, "[%s, %d] " format, __FILE__, __LINE__, x, y)        \
+         : (void)0)
 
 #define LD_LOG_3(level, format, x, y, z)                                       \
-    LDi_log(level, "[%s, %d] " format, __FILE__, __LINE__, x, y, z)
+    (LD_LOG_ENABLED(level)                                                     \
+         ? LDi_log(level, "[%s, %d] " format, __FILE__, __LINE__, x, y, z)     \
+         : (void)0)
@@ -125,7 +125,11 @@ LDGlobalInit(void)
             LDStrDup,
             LDCalloc);
 
-        LD_ASSERT(!status);
+        if (status != CURLE_OK) {
+            LD_LOG(LD_LOG_CRITICAL, "curl_global_init_mem failed");
+
+            LD_ASSERT(LDBooleanFalse);
+        }
 
         hooks.malloc_fn = LDAlloc;
         hooks.free_fn   = LDFree;
@@ -0,0 +1,468 @@
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "number_format.h"
+
+/* Grisu2 by Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+Accurately with Integers". Produces the shortest digit string that reads back
+as the same double in all but a tiny fraction of cases, and a correct but
+slightly longer one otherwise. 64 bit constants are assembled from 32 bit
+halves because C89 has no 64 bit literals. */
+
+#define LD_U64(high, low) (((uint64_t)(high) << 32) | (uint64_t)(low))
+
+#define LD_DOUBLE_HIDDEN_BIT LD_U64(0x00100000UL, 0x00000000UL)
+#define LD_DOUBLE_FRACTION_MASK LD_U64(0x000FFFFFUL, 0xFFFFFFFFUL)
+#define LD_DOUBLE_EXPONENT_BIAS 1075
+
+/* whole numbers below this print identically as plain digits and with
+"%1.15g" */
+#define LD_INTEGER_LIMIT 1e15
+
+struct LDDiyFP
+{
+    uint64_t f;
+    int      e;
+};
+
+/* normalized 10^k for k = -348, -340, ..., 340 */
+static const struct
+{
+    unsigned long high;
+    unsigned long low;
+    int           e;
+} cachedPowers[] = {
+    {0xfa8fd5a0UL, 0x081c0288UL, -1220},
+    {0xbaaee17fUL, 0xa23ebf76UL, -1193},
+    {0x8b16fb20UL, 0x3055ac76UL, -1166},
+    {0xcf42894aUL, 0x5dce35eaUL, -1140},
+    {0x9a6bb0aaUL, 0x55653b2dUL, -1113},
+    {0xe61acf03UL, 0x3d1a45dfUL, -1087},
+    {0xab70fe17UL, 0xc79ac6caUL, -1060},
+    {0xff77b1fcUL, 0xbebcdc4fUL, -1034},
+    {0xbe5691efUL, 0x416bd60cUL, -1007},
+    {0x8dd01fadUL, 0x907ffc3cUL, -980},
+    {0xd3515c28UL, 0x31559a83UL, -954},
+    {0x9d71ac8fUL, 0xada6c9b5UL, -927},
+    {0xea9c2277UL, 0x23ee8bcbUL, -901},
+    {0xaecc4991UL, 0x4078536dUL, -874},
+    {0x823c1279UL, 0x5db6ce57UL, -847},
+    {0xc2109436UL, 0x4dfb5637UL, -821},
+    {0x9096ea6fUL, 0x3848984fUL, -794},
+    {0xd77485cbUL, 0x25823ac7UL, -768},
+    {0xa086cfcdUL, 0x97bf97f4UL, -741},
+    {0xef340a98UL, 0x172aace5UL, -715},
+    {0xb23867fbUL, 0x2a35b28eUL, -688},
+    {0x84c8d4dfUL, 0xd2c63f3bUL, -661},
+    {0xc5dd4427UL, 0x1ad3cdbaUL, -635},
+    {0x936b9fceUL, 0xbb25c996UL, -608},
+    {0xdbac6c24UL, 0x7d62a584UL, -582},
+    {0xa3ab6658UL, 0x0d5fdaf6UL, -555},
+    {0xf3e2f893UL, 0xdec3f126UL, -529},
+    {0xb5b5ada8UL, 0xaaff80b8UL, -502},
+    {0x87625f05UL, 0x6c7c4a8bUL, -475},
+    {0xc9bcff60UL, 0x34c13053UL, -449},
+    {0x964e858cUL, 0x91ba2655UL, -422},
+    {0xdff97724UL, 0x70297ebdUL, -396},
+    {0xa6dfbd9fUL, 0xb8e5b88fUL, -369},
+    {0xf8a95fcfUL, 0x88747d94UL, -343},
+    {0xb9447093UL, 0x8fa89bcfUL, -316},
+    {0x8a08f0f8UL, 0xbf0f156bUL, -289},
+    {0xcdb02555UL, 0x653131b6UL, -263},
+    {0x993fe2c6UL, 0xd07b7facUL, -236},
+    {0xe45c10c4UL, 0x2a2b3b06UL, -210},
+    {0xaa242499UL, 0x697392d3UL, -183},
+    {0xfd87b5f2UL, 0x8300ca0eUL, -157},
+    {0xbce50864UL, 0x92111aebUL, -130},
+    {0x8cbccc09UL, 0x6f5088ccUL, -103},
+    {0xd1b71758UL, 0xe219652cUL, -77},
+    {0x9c400000UL, 0x00000000UL, -50},
+    {0xe8d4a510UL, 0x00000000UL, -24},
+    {0xad78ebc5UL, 0xac620000UL, 3},
+    {0x813f3978UL, 0xf8940984UL, 30},
+    {0xc097ce7bUL, 0xc90715b3UL, 56},
+    {0x8f7e32ceUL, 0x7bea5c70UL, 83},
+    {0xd5d238a4UL, 0xabe98068UL, 109},
+    {0x9f4f2726UL, 0x179a2245UL, 136},
+    {0xed63a231UL, 0xd4c4fb27UL, 162},
+    {0xb0de6538UL, 0x8cc8ada8UL, 189},
+    {0x83c7088eUL, 0x1aab65dbUL, 216},
+    {0xc45d1df9UL, 0x42711d9aUL, 242},
+    {0x924d692cUL, 0xa61be758UL, 269},
+    {0xda01ee64UL, 0x1a708deaUL, 295},
+    {0xa26da399UL, 0x9aef774aUL, 322},
+    {0xf209787bUL, 0xb47d6b85UL, 348},
+    {0xb454e4a1UL, 0x79dd1877UL, 375},
+    {0x865b8692UL, 0x5b9bc5c2UL, 402},
+    {0xc83553c5UL, 0xc8965d3dUL, 428},
+    {0x952ab45cUL, 0xfa97a0b3UL, 455},
+    {0xde469fbdUL, 0x99a05fe3UL, 481},
+    {0xa59bc234UL, 0xdb398c25UL, 508},
+    {0xf6c69a72UL, 0xa3989f5cUL, 534},
+    {0xb7dcbf53UL, 0x54e9beceUL, 561},
+    {0x88fcf317UL, 0xf22241e2UL, 588},
+    {0xcc20ce9bUL, 0xd35c78a5UL, 614},
+    {0x98165af3UL, 0x7b2153dfUL, 641},
+    {0xe2a0b5dcUL, 0x971f303aUL, 667},
+    {0xa8d9d153UL, 0x5ce3b396UL, 694},
+    {0xfb9b7cd9UL, 0xa4a7443cUL, 720},
+    {0xbb764c4cUL, 0xa7a44410UL, 747},
+    {0x8bab8eefUL, 0xb6409c1aUL, 774},
+    {0xd01fef10UL, 0xa657842cUL, 800},
+    {0x9b10a4e5UL, 0xe9913129UL, 827},
+    {0xe7109bfbUL, 0xa19c0c9dUL, 853},
+    {0xac2820d9UL, 0x623bf429UL, 880},
+    {0x80444b5eUL, 0x7aa7cf85UL, 907},
+    {0xbf21e440UL, 0x03acdd2dUL, 933},
+    {0x8e679c2fUL, 0x5e44ff8fUL, 960},
+    {0xd433179dUL, 0x9c8cb841UL, 986},
+    {0x9e19db92UL, 0xb4e31ba9UL, 1013},
+    {0xeb96bf6eUL, 0xbadf77d9UL, 1039},
+    {0xaf87023bUL, 0x9bf0ee6bUL, 1066}
+};
+
+static const uint32_t powersOfTen[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+static struct LDDiyFP
+LDi_diyMultiply(const struct LDDiyFP x, const struct LDDiyFP y)
+{
+    struct LDDiyFP result;
+    uint64_t       mask32, a, b, c, d, ac, bc, ad, bd, middle;
+
+    mask32 = LD_U64(0, 0xFFFFFFFFUL);
+
+    a = x.f >> 32;
+    b = x.f & mask32;
+    c = y.f >> 32;
+    d = y.f & mask32;
+
+    ac = a * c;
+    bc = b * c;
+    ad = a * d;
+    bd = b * d;
+
+    middle = (bd >> 32) + (ad & mask32) + (bc & mask32);
+    /* round the discarded low half */
+    middle += (uint64_t)1 << 31;
+
+    result.f = ac + (ad >> 32) + (bc >> 32) + (middle >> 32);
+    result.e = x.e + y.e + 64;
+
+    return result;
+}
+
+static struct LDDiyFP
+LDi_diyNormalize(struct LDDiyFP value, const uint64_t topBit)
+{
+    while (!(value.f & topBit)) {
+        value.f <<= 1;
+        value.e--;
+    }
+
+    return value;
+}
+
+static struct LDDiyFP
+LDi_cachedPower(const int e, int *const k)
+{
+    struct LDDiyFP result;
+    double         dk;
+    int            ik;
+    unsigned int   index;
+
+    /* the power that brings the exponent of the product into [-60, -32] */
+    dk = (-61 - e) * 0.30102999566398114 + 347;
+    ik = (int)dk;
+
+    if (dk - ik > 0.0) {
+        ik++;
+    }
+
+    index = (unsigned int)((ik >> 3) + 1);
+    *k    = -(-348 + (int)(index << 3));
+
+    result.f = LD_U64(cachedPowers[index].high, cachedPowers[index].low);
+    result.e = cachedPowers[index].e;
+
+    return result;
+}
+
+static int
+LDi_countDigits(const uint32_t n)
+{
+    int digits;
+
+    for (digits = 1; digits < 10; digits++) {
+        if (n < powersOfTen[digits]) {
+            break;
+        }
+    }
+
+    return digits;
+}
+
+/* moves the last digit closer to the exact value while staying in range */
+static void
+LDi_grisuRound(
+    char *const    buffer,
+    const int      length,
+    const uint64_t delta,
+    uint64_t       rest,
+    const uint64_t tenKappa,
+    const uint64_t distance)
+{
+    while (rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance ||
+            distance - rest > rest + tenKappa - distance))
+    {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static int
+LDi_digitGen(
+    const struct LDDiyFP w,
+    const struct LDDiyFP upper,
+    uint64_t             delta,
+    char *const          buffer,
+    int *const           k)
+{
+    struct LDDiyFP one;
+    uint64_t       distance, fractional;
+    uint32_t       integral;
+    int            kappa, length;
+
+    one.f = (uint64_t)1 << -upper.e;
+    one.e = upper.e;
+
+    distance   = upper.f - w.f;
+    integral   = (uint32_t)(upper.f >> -one.e);
+    fractional = upper.f & (one.f - 1);
+    kappa      = LDi_countDigits(integral);
+    length     = 0;
+
+    while (kappa > 0) {
+        const uint32_t digit = integral / powersOfTen[kappa - 1];
+        uint64_t       rest;
+
+        integral %= powersOfTen[kappa - 1];
+
+        if (digit || length) {
+            buffer[length++] = (char)('0' + digit);
+        }
+
+        kappa--;
+
+        rest = ((uint64_t)integral << -one.e) + fractional;
+
+        if (rest <= delta) {
+            *k += kappa;
+
+            LDi_grisuRound(
+                buffer,
+                length,
+                delta,
+                rest,
+                (uint64_t)powersOfTen[kappa] << -one.e,
+                distance);
+
+            return length;
+        }
+    }
+
+    for (;;) {
+        char digit;
+
+        fractional *= 10;
+        delta *= 10;
+
+        digit = (char)(fractional >> -one.e);
+
+        if (digit || length) {
+            buffer[length++] = (char)('0' + digit);
+        }
+
+        fractional &= one.f - 1;
+        kappa--;
+
+        if (fractional < delta) {
+            const int index = -kappa;
+
+            *k += kappa;
+
+            LDi_grisuRound(
+                buffer,
+                length,
+                delta,
+                fractional,
+                one.f,
+                index < 10 ? distance * powersOfTen[index] : 0);
+
+            return length;
+        }
+    }
+}
+
+/* writes the digits of a positive finite value, which is the digits times
+10^k */
+static int
+LDi_grisu2(const uint64_t bits, char *const buffer, int *const k)
+{
+    struct LDDiyFP v, upper, lower, cached, w, wUpper, wLower;
+    const int      biasedExponent = (int)((bits >> 52) & 0x7FF);
+
+    if (biasedExponent) {
+        v.f = (bits & LD_DOUBLE_FRACTION_MASK) + LD_DOUBLE_HIDDEN_BIT;
+        v.e = biasedExponent - LD_DOUBLE_EXPONENT_BIAS;
+    } else {
+        v.f = bits & LD_DOUBLE_FRACTION_MASK;
+        v.e = 1 - LD_DOUBLE_EXPONENT_BIAS;
+    }
+
+    /* boundaries halfway to the neighbouring doubles */
+    upper.f = (v.f << 1) + 1;
+    upper.e = v.e - 1;
+    upper   = LDi_diyNormalize(upper, LD_DOUBLE_HIDDEN_BIT << 1);
+    upper.f <<= 10;
+    upper.e -= 10;
+
+    if (v.f == LD_DOUBLE_HIDDEN_BIT) {
+        lower.f = (v.f << 2) - 1;
+        lower.e = v.e - 2;
+    } else {
+        lower.f = (v.f << 1) - 1;
+        lower.e = v.e - 1;
+    }
+
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    cached = LDi_cachedPower(upper.e, k);
+
+    w      = LDi_diyMultiply(LDi_diyNormalize(v, (uint64_t)1 << 63), cached);
+    wUpper = LDi_diyMultiply(upper, cached);
+    wLower = LDi_diyMultiply(lower, cached);
+
+    /* stay strictly inside the boundaries to allow for rounding */
+    wLower.f++;
+    wUpper.f--;
+
+    return LDi_digitGen(w, wUpper, wUpper.f - wLower.f, buffer, k);
+}
+
+static size_t
+LDi_formatInteger(uint64_t value, char *const buffer)
+{
+    char   digits[20];
+    size_t length, i;
+
+    length = 0;
+
+    do {
+        digits[length++] = (char)('0' + (int)(value % 10));
+        value /= 10;
+    } while (value);
+
+    for (i = 0; i < length; i++) {
+        buffer[i] = digits[length - 1 - i];
+    }
+
+    return length;
+}
+
+/* lays out digits like printf "%g", exponent is that of the first digit */
+static size_t
+LDi_formatDigits(
+    const char *const digits,
+    const int         length,
+    const int         exponent,
+    char *const       buffer)
+{
+    const int precision = length <= 15 ? 15 : 17;
+    char *    cursor    = buffer;
+    int       i;
+
+    if (exponent < -4 || exponent >= precision) {
+        int magnitude;
+
+        *cursor++ = digits[0];
+
+        if (length > 1) {
+            *cursor++ = '.';
+            memcpy(cursor, digits + 1, length - 1);
+            cursor += length - 1;
+        }
+
+        *cursor++ = 'e';
+        *cursor++ = exponent < 0 ? '-' : '+';
+
+        magnitude = exponent < 0 ? -exponent : exponent;
+
+        if (magnitude >= 100) {
+            *cursor++ = (char)('0' + magnitude / 100);
+        }
+
+        *cursor++ = (char)('0' + magnitude / 10 % 10);
+        *cursor++ = (char)('0' + magnitude % 10);
+    } else if (exponent < 0) {
+        *cursor++ = '0';
+        *cursor++ = '.';
+
+        for (i = -1; i > exponent; i--) {
+            *cursor++ = '0';
+        }
+
+        memcpy(cursor, digits, length);
+        cursor += length;
+    } else {
+        for (i = 0; i < length || i <= exponent; i++) {
+            if (i == exponent + 1) {
+                *cursor++ = '.';
+            }
+
+            *cursor++ = i < length ? digits[i] : '0';
+        }
+    }
+
+    return cursor - buffer;
+}
+
+size_t
+LDi_formatNumber(const double value, char *const buffer)
+{
+    uint64_t bits;
+    char *   cursor;
+    double   magnitude;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    cursor    = buffer;
+    magnitude = fabs(value);
+
+    if (bits >> 63) {
+        *cursor++ = '-';
+    }
+
+    if (magnitude < LD_INTEGER_LIMIT && magnitude == floor(magnitude)) {
+        cursor += LDi_formatInteger((uint64_t)magnitude, cursor);
+    } else {
+        char digits[20];
+        int  length, k;
+
+        length = LDi_grisu2(bits & ~((uint64_t)1 << 63), digits, &k);
+
+        while (length > 1 && digits[length - 1] == '0') {
+            length--;
+            k++;
+        }
+
+        cursor += LDi_formatDigits(digits, length, length + k - 1, cursor);
+    }
+
+    *cursor = '\0';
+
+    return cursor - buffer;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+
+/* room for the longest output, such as -2.2250738585072014e-308 */
+#define LD_NUMBER_FORMAT_SIZE 32
+
+/* Writes the shortest text that reads back as exactly value, laid out like
+printf "%1.15g" so whole numbers below 10^15 print identically. The decimal
+point is always '.' regardless of locale. The value must be finite. Returns
+the length excluding the terminator. */
+size_t
+LDi_formatNumber(const double value, char *const buffer);
@@ -0,0 +1,453 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/boolean.h>
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "atomic.h"
+#include "concurrency.h"
+
+/* Size class allocator for the small, short lived blocks that dominate SDK
+allocation: JSON nodes, keys, and short strings. Blocks of each class are
+carved from slabs as needed and recycled through a per thread cache, so that
+most allocations and frees touch no shared state. A thread returns half of its
+cache to a shared list once it holds too many blocks of a class, and refills
+from that list before carving a new slab. When a thread exits its cache and
+the rest of its slabs are shared. Slabs are never returned to the system.
+Larger requests are passed to malloc. */
+
+/* precedes every block, a multiple of the alignment malloc provides */
+#define LD_POOL_HEADER_SIZE 16
+#define LD_POOL_SLAB_SIZE 65536
+/* cached blocks per class and thread before half are shared */
+#define LD_POOL_CACHE_LIMIT 256
+#define LD_POOL_CLASS_COUNT 12
+#define LD_POOL_MAX_SIZE 1024
+
+union LDPoolHeader
+{
+    /* bytes usable by the caller, larger than LD_POOL_MAX_SIZE if the block
+    came from malloc */
+    size_t size;
+    char   padding[LD_POOL_HEADER_SIZE];
+};
+
+/* free blocks are linked through their first bytes after the header, the
+smallest class has room for both links */
+struct LDPoolBlock
+{
+    union LDPoolHeader  header;
+    struct LDPoolBlock *next;
+    /* in the first block of a batch on a shared list, the next batch */
+    struct LDPoolBlock *nextBatch;
+};
+
+/* blocks move between threads in batches of up to half a cache, so that
+neither side walks a list of blocks that are likely out of cache. The first
+block of a batch holds the length of the batch in place of its size. */
+struct LDPoolShared
+{
+    ld_atomic_t         lock;
+    struct LDPoolBlock *batches;
+};
+
+static const size_t classSizes[LD_POOL_CLASS_COUNT] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+
+/* class of a request by its size in 16 byte units, rounded up */
+static const unsigned char unitClasses[LD_POOL_MAX_SIZE / 16 + 1] = {
+     0,  0,  1,  2,  3,  4,  4,  5,  5,  6,  6,  6,  6,
+     7,  7,  7,  7,  8,  8,  8,  8,  8,  8,  8,  8,  9,
+     9,  9,  9,  9,  9,  9,  9, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 11, 11, 11,
+    11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11};
+
+static struct LDPoolShared shared[LD_POOL_CLASS_COUNT];
+
+/* slabs are linked so they stay reachable for leak checkers */
+static ld_atomic_t slabLock;
+static void *      slabs;
+
+struct LDPoolCache
+{
+    struct LDPoolBlock *blocks[LD_POOL_CLASS_COUNT];
+    unsigned int        counts[LD_POOL_CLASS_COUNT];
+    /* unused part of the newest slab of each class, handed out in order
+    so that slab memory is first touched when it is allocated */
+    char *              unused[LD_POOL_CLASS_COUNT];
+    char *              unusedEnd[LD_POOL_CLASS_COUNT];
+    /* set once the cache is released when the thread exits */
+    LDBoolean registered;
+};
+
+static LD_THREAD_LOCAL struct LDPoolCache threadCache;
+
+/* created on first use, under slabLock */
+static LDBoolean exitKeyCreated;
+#ifdef _WIN32
+static DWORD exitKey;
+#else
+static pthread_key_t exitKey;
+#endif
+
+/* held only to move a few pointers, so waiters spin */
+static void
+LDi_poolLock(ld_atomic_t *const lock)
+{
+    while (!LDi_atomicCompareExchange(lock, 0, 1)) {}
+}
+
+static void
+LDi_poolUnlock(ld_atomic_t *const lock)
+{
+    LDi_atomicStore(lock, 0);
+}
+
+static unsigned int
+LDi_poolClass(const size_t bytes)
+{
+    return unitClasses[(bytes + 15) / 16];
+}
+
+static LDBoolean
+LDi_poolCarve(struct LDPoolCache *const cache, const unsigned int class)
+{
+    char *slab;
+
+    if (!(slab = (char *)malloc(LD_POOL_SLAB_SIZE))) {
+        return LDBooleanFalse;
+    }
+
+    LDi_poolLock(&slabLock);
+    *(void **)slab = slabs;
+    slabs          = slab;
+    LDi_poolUnlock(&slabLock);
+
+    cache->unused[class]    = slab + LD_POOL_HEADER_SIZE;
+    cache->unusedEnd[class] = slab + LD_POOL_SLAB_SIZE;
+
+    return LDBooleanTrue;
+}
+
+/* moves the first count blocks of the cache to the shared list */
+static void
+LDi_poolShare(
+    struct LDPoolCache *const cache,
+    const unsigned int        class,
+    const unsigned int        count)
+{
+    struct LDPoolShared *const pool = &shared[class];
+    struct LDPoolBlock *       first, *last;
+    unsigned int               i;
+
+    first = last = cache->blocks[class];
+
+    for (i = 1; i < count; i++) {
+        last = last->next;
+    }
+
+    cache->blocks[class] = last->next;
+    cache->counts[class] -= count;
+
+    last->next         = NULL;
+    first->header.size = count;
+
+    LDi_poolLock(&pool->lock);
+    first->nextBatch = pool->batches;
+    pool->batches    = first;
+    LDi_poolUnlock(&pool->lock);
+}
+
+/* shares everything the cache holds, including the unused part of its slabs,
+so the memory of an exiting thread is reused */
+static void
+LDi_poolRelease(struct LDPoolCache *const cache)
+{
+    unsigned int class;
+
+    for (class = 0; class < LD_POOL_CLASS_COUNT; class++) {
+        const size_t blockSize = LD_POOL_HEADER_SIZE + classSizes[class];
+
+        while (cache->unused[class] &&
+               cache->unused[class] + blockSize <= cache->unusedEnd[class])
+        {
+            struct LDPoolBlock *const block =
+                (struct LDPoolBlock *)cache->unused[class];
+
+            cache->unused[class] += blockSize;
+
+            block->header.size   = classSizes[class];
+            block->next          = cache->blocks[class];
+            cache->blocks[class] = block;
+            cache->counts[class]++;
+        }
+
+        cache->unused[class] = cache->unusedEnd[class] = NULL;
+
+        while (cache->counts[class] > LD_POOL_CACHE_LIMIT / 2) {
+            LDi_poolShare(cache, class, LD_POOL_CACHE_LIMIT / 2);
+        }
+
+        if (cache->counts[class]) {
+            LDi_poolShare(cache, class, cache->counts[class]);
+        }
+    }
+
+    /* a later allocation on the thread registers it again */
+    cache->registered = LDBooleanFalse;
+}
+
+#ifdef _WIN32
+static VOID NTAPI
+LDi_poolThreadExit(PVOID cache)
+#else
+static void
+LDi_poolThreadExit(void *cache)
+#endif
+{
+    LDi_poolRelease((struct LDPoolCache *)cache);
+}
+
+/* arranges for the cache to be released when the thread exits, it is not if
+that fails */
+static void
+LDi_poolRegister(struct LDPoolCache *const cache)
+{
+    LDBoolean created;
+
+    LDi_poolLock(&slabLock);
+
+    if (!exitKeyCreated) {
+#ifdef _WIN32
+        exitKey        = FlsAlloc(LDi_poolThreadExit);
+        exitKeyCreated = exitKey != FLS_OUT_OF_INDEXES;
+#else
+        exitKeyCreated = pthread_key_create(&exitKey, LDi_poolThreadExit) == 0;
+#endif
+    }
+
+    created = exitKeyCreated;
+
+    LDi_poolUnlock(&slabLock);
+
+    if (created) {
+#ifdef _WIN32
+        FlsSetValue(exitKey, cache);
+#else
+        pthread_setspecific(exitKey, cache);
+#endif
+    }
+
+    cache->registered = LDBooleanTrue;
+}
+
+/* called when the cache has no free blocks of the class */
+static struct LDPoolBlock *
+LDi_poolRefill(struct LDPoolCache *const cache, const unsigned int class)
+{
+    struct LDPoolShared *const pool = &shared[class];
+    const size_t         blockSize  = LD_POOL_HEADER_SIZE + classSizes[class];
+    struct LDPoolBlock * block;
+
+    if (!cache->registered) {
+        LDi_poolRegister(cache);
+    }
+
+    LDi_poolLock(&pool->lock);
+
+    if ((block = pool->batches)) {
+        pool->batches = block->nextBatch;
+    }
+
+    LDi_poolUnlock(&pool->lock);
+
+    if (block) {
+        cache->blocks[class] = block->next;
+        cache->counts[class] = (unsigned int)block->header.size - 1;
+
+        block->header.size = classSizes[class];
+
+        return block;
+    }
+
+    if (cache->unused[class] + blockSize > cache->unusedEnd[class]) {
+        if (!LDi_poolCarve(cache, class)) {
+            return NULL;
+        }
+    }
+
+    block = (struct LDPoolBlock *)cache->unused[class];
+
+    cache->unused[class] += blockSize;
+
+    block->header.size = classSizes[class];
+
+    return block;
+}
+
+void *
+LDPoolAlloc(const size_t bytes)
+{
+    struct LDPoolCache *const cache = &threadCache;
+    struct LDPoolBlock *      block;
+    unsigned int              class;
+
+    if (bytes > LD_POOL_MAX_SIZE) {
+        union LDPoolHeader *header;
+
+        if (bytes > (size_t)-1 - LD_POOL_HEADER_SIZE) {
+            return NULL;
+        }
+
+        if (!(header = (union LDPoolHeader *)malloc(
+                  LD_POOL_HEADER_SIZE + bytes)))
+        {
+            return NULL;
+        }
+
+        header->size = bytes;
+
+        return (char *)header + LD_POOL_HEADER_SIZE;
+    }
+
+    class = LDi_poolClass(bytes);
+
+    if ((block = cache->blocks[class])) {
+        cache->blocks[class] = block->next;
+        cache->counts[class]--;
+    } else if (!(block = LDi_poolRefill(cache, class))) {
+        return NULL;
+    }
+
+    return (char *)block + LD_POOL_HEADER_SIZE;
+}
+
+void
+LDPoolFree(void *const buffer)
+{
+    struct LDPoolCache *const cache = &threadCache;
+    struct LDPoolBlock *      block;
+    unsigned int              class;
+
+    if (!buffer) {
+        return;
+    }
+
+    block = (struct LDPoolBlock *)((char *)buffer - LD_POOL_HEADER_SIZE);
+
+    if (block->header.size > LD_POOL_MAX_SIZE) {
+        free(block);
+
+        return;
+    }
+
+    class = LDi_poolClass(block->header.size);
+
+    block->next          = cache->blocks[class];
+    cache->blocks[class] = block;
+
+    /* a thread may free blocks without allocating any */
+    if (!block->next && !cache->registered) {
+        LDi_poolRegister(cache);
+    }
+
+    /* shares the most recently freed blocks */
+    if (++cache->counts[class] > LD_POOL_CACHE_LIMIT) {
+        LDi_poolShare(cache, class, LD_POOL_CACHE_LIMIT / 2);
+    }
+}
+
+void *
+LDPoolRealloc(void *const buffer, const size_t bytes)
+{
+    union LDPoolHeader *header;
+    void *              result;
+
+    if (!buffer) {
+        return LDPoolAlloc(bytes);
+    }
+
+    header = (union LDPoolHeader *)((char *)buffer - LD_POOL_HEADER_SIZE);
+
+    if (header->size > LD_POOL_MAX_SIZE && bytes > LD_POOL_MAX_SIZE) {
+        if (bytes > (size_t)-1 - LD_POOL_HEADER_SIZE) {
+            return NULL;
+        }
+
+        if (!(header = (union LDPoolHeader *)realloc(
+                  header, LD_POOL_HEADER_SIZE + bytes)))
+        {
+            return NULL;
+        }
+
+        header->size = bytes;
+
+        return (char *)header + LD_POOL_HEADER_SIZE;
+    }
+
+    if (bytes <= header->size && header->size <= LD_POOL_MAX_SIZE) {
+        return buffer;
+    }
+
+    if (!(result = LDPoolAlloc(bytes))) {
+        return NULL;
+    }
+
+    memcpy(result, buffer, header->size < bytes ? header->size : bytes);
+
+    LDPoolFree(buffer);
+
+    return result;
+}
+
+void *
+LDPoolCalloc(const size_t nmemb, const size_t size)
+{
+    void *result;
+
+    if (size && nmemb > (size_t)-1 / size) {
+        return NULL;
+    }
+
+    if ((result = LDPoolAlloc(nmemb * size))) {
+        memset(result, 0, nmemb * size);
+    }
+
+    return result;
+}
+
+char *
+LDPoolStrDup(const char *const string)
+{
+    return LDPoolStrNDup(string, strlen(string));
+}
+
+char *
+LDPoolStrNDup(const char *const str, const size_t n)
+{
+    char * result;
+    size_t length;
+
+    /* like strndup the copy stops at a terminator within n */
+    for (length = 0; length < n && str[length]; length++) {}
+
+    if ((result = (char *)LDPoolAlloc(length + 1))) {
+        memcpy(result, str, length);
+        result[length] = '\0';
+    }
+
+    return result;
+}
+
+void
+LDSetPoolMemoryRoutines(void)
+{
+    LDSetMemoryRoutines(
+        LDPoolAlloc,
+        LDPoolFree,
+        LDPoolRealloc,
+        LDPoolStrDup,
+        LDPoolCalloc,
+        LDPoolStrNDup);
+}
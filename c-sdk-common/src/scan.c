@@ -0,0 +1,174 @@
+#include "scan.h"
+
+#if defined(LD_SCAN_AVX2)
+#include <immintrin.h>
+#elif defined(LD_SCAN_SSE2)
+#include <emmintrin.h>
+#elif defined(LD_SCAN_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(LD_SCAN_SSE2)
+/* mask must be non zero */
+static unsigned int
+LDi_lowestSetBit(const unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+
+    _BitScanForward(&index, mask);
+
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+size_t
+LDi_scanLineEnd(const char *const data, const size_t size)
+{
+    size_t offset;
+
+    offset = 0;
+
+#if defined(LD_SCAN_SSE2)
+    {
+        const __m128i carriageReturn = _mm_set1_epi8('\r');
+        const __m128i lineFeed       = _mm_set1_epi8('\n');
+
+        for (; offset + 16 <= size; offset += 16) {
+            __m128i block;
+            int     mask;
+
+            block = _mm_loadu_si128((const __m128i *)(data + offset));
+            mask  = _mm_movemask_epi8(_mm_or_si128(
+                _mm_cmpeq_epi8(block, carriageReturn),
+                _mm_cmpeq_epi8(block, lineFeed)));
+
+            if (mask) {
+                return offset + LDi_lowestSetBit((unsigned int)mask);
+            }
+        }
+    }
+#elif defined(LD_SCAN_NEON)
+    {
+        const uint8x16_t carriageReturn = vdupq_n_u8('\r');
+        const uint8x16_t lineFeed       = vdupq_n_u8('\n');
+
+        for (; offset + 16 <= size; offset += 16) {
+            uint8x16_t block, matches;
+
+            block   = vld1q_u8((const uint8_t *)(data + offset));
+            matches = vorrq_u8(
+                vceqq_u8(block, carriageReturn), vceqq_u8(block, lineFeed));
+
+            /* the scalar loop below locates the match within the block */
+            if (vmaxvq_u8(matches)) {
+                break;
+            }
+        }
+    }
+#endif
+
+    for (; offset < size; offset++) {
+        if (data[offset] == '\n' || data[offset] == '\r') {
+            return offset;
+        }
+    }
+
+    return size;
+}
+
+/* true for bytes that cannot appear unescaped in a JSON string */
+#define LD_JSON_SPECIAL(c)                                                     \
+    ((c) == '"' || (c) == '\\' || (unsigned char)(c) < 0x20)
+
+size_t
+LDi_scanJSONString(const char *const data, const size_t size)
+{
+    size_t offset;
+
+    offset = 0;
+
+#if defined(LD_SCAN_SSE2)
+#if defined(LD_SCAN_AVX2)
+    {
+        const __m256i quote     = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i control   = _mm256_set1_epi8(0x1F);
+
+        for (; offset + 32 <= size; offset += 32) {
+            __m256i block;
+            int     mask;
+
+            block = _mm256_loadu_si256((const __m256i *)(data + offset));
+            /* unsigned block <= 0x1F when the maximum of the two is 0x1F */
+            mask = _mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_or_si256(
+                    _mm256_cmpeq_epi8(block, quote),
+                    _mm256_cmpeq_epi8(block, backslash)),
+                _mm256_cmpeq_epi8(_mm256_max_epu8(block, control), control)));
+
+            if (mask) {
+                return offset + LDi_lowestSetBit((unsigned int)mask);
+            }
+        }
+    }
+#endif
+    {
+        const __m128i quote     = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control   = _mm_set1_epi8(0x1F);
+
+        for (; offset + 16 <= size; offset += 16) {
+            __m128i block;
+            int     mask;
+
+            block = _mm_loadu_si128((const __m128i *)(data + offset));
+            /* unsigned block <= 0x1F when the maximum of the two is 0x1F */
+            mask = _mm_movemask_epi8(_mm_or_si128(
+                _mm_or_si128(
+                    _mm_cmpeq_epi8(block, quote),
+                    _mm_cmpeq_epi8(block, backslash)),
+                _mm_cmpeq_epi8(_mm_max_epu8(block, control), control)));
+
+            if (mask) {
+                return offset + LDi_lowestSetBit((unsigned int)mask);
+            }
+        }
+    }
+#elif defined(LD_SCAN_NEON)
+    {
+        const uint8x16_t quote     = vdupq_n_u8('"');
+        const uint8x16_t backslash = vdupq_n_u8('\\');
+        const uint8x16_t control   = vdupq_n_u8(0x20);
+
+        for (; offset + 16 <= size; offset += 16) {
+            uint8x16_t block, matches;
+
+            block   = vld1q_u8((const uint8_t *)(data + offset));
+            matches = vorrq_u8(
+                vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash)),
+                vcltq_u8(block, control));
+
+            /* the scalar loop below locates the match within the block */
+            if (vmaxvq_u8(matches)) {
+                break;
+            }
+        }
+    }
+#endif
+
+    for (; offset < size; offset++) {
+        if (LD_JSON_SPECIAL(data[offset])) {
+            return offset;
+        }
+    }
+
+    return size;
+}
@@ -0,0 +1,35 @@
+/*!
+ * @file scan.h
+ * @brief Internal byte scanning kernels.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+/* Vector kernels are chosen at compile time. SSE2 is part of the x86-64
+baseline, and NEON is part of the AArch64 baseline, so neither needs runtime
+feature detection. Any other target uses the portable scalar loops. */
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LD_SCAN_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LD_SCAN_NEON
+#endif
+
+/* AVX2 is not part of any baseline, it is only used when the build targets it
+explicitly, for example with -mavx2 or /arch:AVX2. */
+#if defined(LD_SCAN_SSE2) && defined(__AVX2__)
+#define LD_SCAN_AVX2
+#endif
+
+/* Returns the offset of the first carriage return or line feed in the range,
+or size if there is none. */
+size_t
+LDi_scanLineEnd(const char *const data, const size_t size);
+
+/* Returns the offset of the first byte in the range that cannot appear
+unescaped inside a JSON string: a quote, a backslash, or a control character.
+Returns size if there is none. */
+size_t
+LDi_scanJSONString(const char *const data, const size_t size);
@@ -3,8 +3,90 @@
 #include <launchdarkly/memory.h>
 
 #include "assertion.h"
+#include "scan.h"
 #include "sse.h"
 
+/* smallest allocation made for any parser buffer */
+#define LD_SSE_MIN_CAPACITY 256
+/* buffers larger than this are released after each event instead of being
+kept around, so a single large put does not pin memory for the stream life */
+#define LD_SSE_RETAIN_CAPACITY (64 * 1024)
+
+static void
+LDi_sseBufferInitialize(struct LDSSEBuffer *const buffer)
+{
+    LD_ASSERT(buffer);
+
+    buffer->data     = NULL;
+    buffer->size     = 0;
+    buffer->capacity = 0;
+}
+
+static void
+LDi_sseBufferDestroy(struct LDSSEBuffer *const buffer)
+{
+    LD_ASSERT(buffer);
+
+    LDFree(buffer->data);
+
+    LDi_sseBufferInitialize(buffer);
+}
+
+static void
+LDi_sseBufferReset(struct LDSSEBuffer *const buffer)
+{
+    LD_ASSERT(buffer);
+
+    if (buffer->capacity > LD_SSE_RETAIN_CAPACITY) {
+        LDi_sseBufferDestroy(buffer);
+    } else {
+        buffer->size = 0;
+    }
+}
+
+static LDBoolean
+LDi_sseBufferAppend(
+    struct LDSSEBuffer *const buffer, const char *const data, const size_t size)
+{
+    size_t required;
+
+    LD_ASSERT(buffer);
+
+    /* space for the terminator */
+    required = buffer->size + size + 1;
+
+    if (required > buffer->capacity) {
+        char * dataTmp;
+        size_t capacity;
+
+        capacity = buffer->capacity * 2;
+
+        if (capacity < LD_SSE_MIN_CAPACITY) {
+            capacity = LD_SSE_MIN_CAPACITY;
+        }
+
+        if (capacity < required) {
+            capacity = required;
+        }
+
+        if (!(dataTmp = (char *)LDRealloc(buffer->data, capacity))) {
+            return LDBooleanFalse;
+        }
+
+        buffer->data     = dataTmp;
+        buffer->capacity = capacity;
+    }
+
+    if (size) {
+        memcpy(buffer->data + buffer->size, data, size);
+    }
+
+    buffer->size += size;
+    buffer->data[buffer->size] = '\0';
+
+    return LDBooleanTrue;
+}
+
 void
 LDSSEParserInitialize(
     struct LDSSEParser *const parser,
@@ -14,110 +96,253 @@ LDSSEParserInitialize(
     LD_ASSERT(parser);
     LD_ASSERT(dispatch);
 
-    parser->buffer     = NULL;
-    parser->bufferSize = 0;
-    parser->eventName  = NULL;
-    parser->eventBody  = NULL;
-    parser->dispatch   = dispatch;
-    parser->context    = context;
+    LDi_sseBufferInitialize(&parser->line);
+    LDi_sseBufferInitialize(&parser->eventName);
+    LDi_sseBufferInitialize(&parser->eventBody);
+
+    parser->hasEventName = LDBooleanFalse;
+    parser->hasEventBody = LDBooleanFalse;
+    parser->skipLineFeed  = LDBooleanFalse;
+    parser->dispatch      = dispatch;
+    parser->streamBegin   = NULL;
+    parser->streamData    = NULL;
+    parser->streamOffered = LDBooleanFalse;
+    parser->streaming     = LDBooleanFalse;
+    parser->lineStreaming = LDBooleanFalse;
+    parser->context       = context;
+}
+
+void
+LDSSEParserSetStreaming(
+    struct LDSSEParser *const parser,
+    ld_sse_stream_begin       streamBegin,
+    ld_sse_stream_data        streamData)
+{
+    LD_ASSERT(parser);
+    LD_ASSERT((streamBegin == NULL) == (streamData == NULL));
+
+    parser->streamBegin = streamBegin;
+    parser->streamData  = streamData;
 }
 
 void
 LDSSEParserDestroy(struct LDSSEParser *const parser)
 {
     if (parser) {
-        LDFree(parser->buffer);
-        LDFree(parser->eventName);
-        LDFree(parser->eventBody);
+        LDi_sseBufferDestroy(&parser->line);
+        LDi_sseBufferDestroy(&parser->eventName);
+        LDi_sseBufferDestroy(&parser->eventBody);
 
-        parser->buffer    = NULL;
-        parser->eventName = NULL;
-        parser->eventBody = NULL;
+        parser->hasEventName = LDBooleanFalse;
+        parser->hasEventBody = LDBooleanFalse;
     }
 }
 
 static LDBoolean
-LDi_processLine(struct LDSSEParser *const parser, const char *line)
+LDi_dispatchEvent(struct LDSSEParser *const parser)
 {
+    LDBoolean status;
+
     LD_ASSERT(parser);
-    LD_ASSERT(line);
 
-    if (line[0] == ':') {
-        /* skip comment */
-    } else if (line[0] == '\0') {
-        LDBoolean status;
-        /* dispatch */
-        if (parser->eventName == NULL) {
-            LD_LOG(LD_LOG_WARNING, "SSE dispatch with NULL event name");
+    if (!parser->hasEventName) {
+        LD_LOG(LD_LOG_WARNING, "SSE dispatch with NULL event name");
+
+        status = LDBooleanTrue;
+    } else if (!parser->hasEventBody) {
+        LD_LOG(LD_LOG_WARNING, "SSE dispatch with NULL event body");
+
+        status = LDBooleanTrue;
+    } else if (parser->streaming) {
+        LD_ASSERT(parser->dispatch);
+
+        status = parser->dispatch(
+            parser->eventName.data,
+            parser->eventName.size,
+            "",
+            0,
+            parser->context);
+    } else {
+        LD_ASSERT(parser->dispatch);
+
+        status = parser->dispatch(
+            parser->eventName.data,
+            parser->eventName.size,
+            parser->eventBody.data,
+            parser->eventBody.size,
+            parser->context);
+    }
 
-            status = LDBooleanTrue;
-        } else if (parser->eventBody == NULL) {
-            LD_LOG(LD_LOG_WARNING, "SSE dispatch with NULL event body");
+    LDi_sseBufferReset(&parser->eventName);
+    LDi_sseBufferReset(&parser->eventBody);
 
-            status = LDBooleanTrue;
-        } else {
-            LD_ASSERT(parser->dispatch);
+    parser->hasEventName  = LDBooleanFalse;
+    parser->hasEventBody  = LDBooleanFalse;
+    parser->streamOffered = LDBooleanFalse;
+    parser->streaming     = LDBooleanFalse;
+
+    return status;
+}
 
-            status = parser->dispatch(
-                parser->eventName, parser->eventBody, parser->context);
+/* offers the current event to the stream consumer on its first data line */
+static LDBoolean
+LDi_isStreaming(struct LDSSEParser *const parser)
+{
+    LD_ASSERT(parser);
+
+    if (!parser->streamOffered) {
+        parser->streamOffered = LDBooleanTrue;
+
+        if (parser->streamBegin && parser->hasEventName) {
+            parser->streaming = parser->streamBegin(
+                parser->eventName.data,
+                parser->eventName.size,
+                parser->context);
         }
+    }
 
-        LDFree(parser->eventName);
-        LDFree(parser->eventBody);
+    return parser->streaming;
+}
 
-        parser->eventName = NULL;
-        parser->eventBody = NULL;
+/* passes the start of a data line through to the stream consumer */
+static LDBoolean
+LDi_streamDataLine(
+    struct LDSSEParser *const parser,
+    const char *const         data,
+    const size_t              dataSize)
+{
+    LD_ASSERT(parser);
+    LD_ASSERT(parser->streaming);
 
-        if (status == LDBooleanFalse) {
+    if (parser->hasEventBody) {
+        if (!parser->streamData("\n", 1, parser->context)) {
             return LDBooleanFalse;
         }
-    } else if (strncmp(line, "data:", 5) == 0) {
-        char *    eventBodyTmp;
-        size_t    lineSize, currentBodySize;
-        LDBoolean notEmpty;
+    }
+
+    parser->hasEventBody = LDBooleanTrue;
+
+    if (dataSize == 0) {
+        return LDBooleanTrue;
+    }
+
+    return parser->streamData(data, dataSize, parser->context);
+}
+
+/* A data line of a streamed event that does not fit in the current chunk is
+passed through as soon as its prefix is known, rather than being buffered. */
+static LDBoolean
+LDi_streamPartialLine(struct LDSSEParser *const parser)
+{
+    const char *line;
+    size_t      lineSize;
+
+    LD_ASSERT(parser);
+
+    line     = parser->line.data;
+    lineSize = parser->line.size;
+
+    /* wait until the optional space after the prefix can be seen */
+    if (lineSize < 6 || memcmp(line, "data:", 5) != 0) {
+        return LDBooleanTrue;
+    }
+
+    if (!LDi_isStreaming(parser)) {
+        return LDBooleanTrue;
+    }
+
+    line += 5;
+    lineSize -= 5;
+
+    if (line[0] == ' ') {
+        line++;
+        lineSize--;
+    }
+
+    if (!LDi_streamDataLine(parser, line, lineSize)) {
+        return LDBooleanFalse;
+    }
+
+    parser->lineStreaming = LDBooleanTrue;
+
+    LDi_sseBufferReset(&parser->line);
+
+    return LDBooleanTrue;
+}
+
+/* line is not terminated, and may point into the caller's chunk */
+static LDBoolean
+LDi_processLine(
+    struct LDSSEParser *const parser, const char *line, size_t lineSize)
+{
+    LD_ASSERT(parser);
+    LD_ASSERT(line || lineSize == 0);
+
+    if (lineSize == 0) {
+        return LDi_dispatchEvent(parser);
+    }
+
+    /* the first byte is enough to tell the fields we handle apart */
+    switch (line[0]) {
+    case ':':
+        /* skip comment */
+        break;
+    case 'd':
+        if (lineSize < 5 || memcmp(line, "data:", 5) != 0) {
+            break;
+        }
 
         line += 5;
-        line += line[0] == ' ';
+        lineSize -= 5;
 
-        lineSize = strlen(line);
-        notEmpty = parser->eventBody != NULL;
+        if (lineSize && line[0] == ' ') {
+            line++;
+            lineSize--;
+        }
 
-        if (notEmpty) {
-            currentBodySize = strlen(parser->eventBody);
-        } else {
-            currentBodySize = 0;
+        if (LDi_isStreaming(parser)) {
+            return LDi_streamDataLine(parser, line, lineSize);
         }
 
-        eventBodyTmp = (char *)LDRealloc(
-            parser->eventBody, lineSize + currentBodySize + notEmpty + 1);
+        if (parser->hasEventBody) {
+            if (!LDi_sseBufferAppend(&parser->eventBody, "\n", 1)) {
+                return LDBooleanFalse;
+            }
+        }
 
-        if (eventBodyTmp == NULL) {
+        if (!LDi_sseBufferAppend(&parser->eventBody, line, lineSize)) {
             return LDBooleanFalse;
         }
 
-        parser->eventBody = eventBodyTmp;
+        parser->hasEventBody = LDBooleanTrue;
 
-        if (notEmpty) {
-            parser->eventBody[currentBodySize] = '\n';
+        break;
+    case 'e':
+        if (lineSize < 6 || memcmp(line, "event:", 6) != 0) {
+            break;
         }
 
-        memcpy(parser->eventBody + currentBodySize + notEmpty, line, lineSize);
-
-        parser->eventBody[currentBodySize + notEmpty + lineSize] = '\0';
-    } else if (strncmp(line, "event:", 6) == 0) {
         /* skip prefix and optional space*/
         line += 6;
-        line += line[0] == ' ';
+        lineSize -= 6;
 
-        if (parser->eventName) {
-            LDFree(parser->eventName);
+        if (lineSize && line[0] == ' ') {
+            line++;
+            lineSize--;
         }
 
-        parser->eventName = LDStrDup(line);
+        parser->eventName.size = 0;
 
-        if (parser->eventName == NULL) {
+        if (!LDi_sseBufferAppend(&parser->eventName, line, lineSize)) {
             return LDBooleanFalse;
         }
+
+        parser->hasEventName = LDBooleanTrue;
+
+        break;
+    default:
+        /* id, retry, and unknown fields are ignored */
+        break;
     }
 
     return LDBooleanTrue;
@@ -129,9 +354,7 @@ LDSSEParserProcess(
     const void *const         buffer,
     const size_t              bufferSize)
 {
-    void * bufferTmp;
-    char * newLineLocation;
-    size_t consumed;
+    const char *cursor, *end;
 
     LD_ASSERT(parser);
 
@@ -141,36 +364,68 @@ LDSSEParserProcess(
 
     LD_ASSERT(buffer);
 
-    bufferTmp = LDRealloc(parser->buffer, parser->bufferSize + bufferSize + 1);
+    cursor = (const char *)buffer;
+    end    = cursor + bufferSize;
 
-    if (bufferTmp == NULL) {
-        return LDBooleanFalse;
-    }
+    while (cursor != end) {
+        size_t lineSize;
 
-    parser->buffer = bufferTmp;
-    consumed       = 0;
+        /* second half of a CRLF pair, possibly split across chunks */
+        if (parser->skipLineFeed) {
+            parser->skipLineFeed = LDBooleanFalse;
 
-    memcpy(&(parser->buffer[parser->bufferSize]), buffer, bufferSize);
+            if (*cursor == '\n') {
+                cursor++;
 
-    parser->bufferSize += bufferSize;
-    parser->buffer[parser->bufferSize] = '\0';
+                continue;
+            }
+        }
 
-    while (
-        (newLineLocation = (char *)memchr(
-             parser->buffer + consumed, '\n', parser->bufferSize - consumed)))
-    {
-        *newLineLocation = '\0';
+        lineSize = LDi_scanLineEnd(cursor, end - cursor);
 
-        if (!LDi_processLine(parser, parser->buffer + consumed)) {
-            return LDBooleanFalse;
+        if (lineSize == (size_t)(end - cursor)) {
+            if (parser->lineStreaming) {
+                return parser->streamData(cursor, lineSize, parser->context);
+            }
+
+            /* unterminated line is carried over to the next chunk */
+            if (!LDi_sseBufferAppend(&parser->line, cursor, lineSize)) {
+                return LDBooleanFalse;
+            }
+
+            return LDi_streamPartialLine(parser);
         }
 
-        consumed = newLineLocation - parser->buffer + 1;
-    }
+        parser->skipLineFeed = cursor[lineSize] == '\r';
+
+        if (parser->lineStreaming) {
+            /* end of a data line that was passed through */
+            parser->lineStreaming = LDBooleanFalse;
+
+            if (lineSize &&
+                !parser->streamData(cursor, lineSize, parser->context)) {
+                return LDBooleanFalse;
+            }
+        } else if (parser->line.size) {
+            /* finish a line that was split across chunks */
+            if (!LDi_sseBufferAppend(&parser->line, cursor, lineSize)) {
+                return LDBooleanFalse;
+            }
+
+            if (!LDi_processLine(
+                    parser, parser->line.data, parser->line.size)) {
+                return LDBooleanFalse;
+            }
+
+            LDi_sseBufferReset(&parser->line);
+        } else {
+            /* complete lines are processed in place without copying */
+            if (!LDi_processLine(parser, cursor, lineSize)) {
+                return LDBooleanFalse;
+            }
+        }
 
-    if (consumed) {
-        parser->bufferSize -= consumed;
-        memmove(parser->buffer, parser->buffer + consumed, parser->bufferSize);
+        cursor += lineSize + 1;
     }
 
     return LDBooleanTrue;
@@ -4,17 +4,54 @@
 
 #include <launchdarkly/boolean.h>
 
+/* Event name and body are views into storage owned by the parser. Both are
+NUL terminated for convenience, but the sizes are authoritative. The views are
+only valid for the duration of the dispatch call. */
 typedef LDBoolean (*ld_sse_dispatch)(
-    const char *const name, const char *const body, void *const context);
+    const char *const name,
+    const size_t      nameSize,
+    const char *const body,
+    const size_t      bodySize,
+    void *const       context);
+
+/* Called for the first data line of an event, once the event name is known.
+Returning true claims the event: its data is then passed to ld_sse_stream_data
+in pieces as it arrives instead of being accumulated, with a line feed between
+data lines, and the event is dispatched with an empty body. */
+typedef LDBoolean (*ld_sse_stream_begin)(
+    const char *const name, const size_t nameSize, void *const context);
+
+typedef LDBoolean (*ld_sse_stream_data)(
+    const char *const data, const size_t dataSize, void *const context);
+
+/* slab storage that keeps its capacity between events */
+struct LDSSEBuffer
+{
+    char * data;
+    size_t size;
+    size_t capacity;
+};
 
 struct LDSSEParser
 {
-    char *          buffer;
-    size_t          bufferSize;
-    char *          eventName;
-    char *          eventBody;
-    ld_sse_dispatch dispatch;
-    void *          context;
+    /* unterminated line carried over between chunks */
+    struct LDSSEBuffer  line;
+    struct LDSSEBuffer  eventName;
+    struct LDSSEBuffer  eventBody;
+    LDBoolean           hasEventName;
+    LDBoolean           hasEventBody;
+    /* previous line ended with a carriage return */
+    LDBoolean           skipLineFeed;
+    ld_sse_dispatch     dispatch;
+    ld_sse_stream_begin streamBegin;
+    ld_sse_stream_data  streamData;
+    /* the current event has been offered to streamBegin */
+    LDBoolean           streamOffered;
+    /* the current event was claimed by streamBegin */
+    LDBoolean           streaming;
+    /* the unterminated line is data being passed through to streamData */
+    LDBoolean           lineStreaming;
+    void *              context;
 };
 
 void
@@ -23,6 +60,13 @@ LDSSEParserInitialize(
     ld_sse_dispatch           dispatch,
     void *const               context);
 
+/* opts into incremental delivery of event data, both may be NULL */
+void
+LDSSEParserSetStreaming(
+    struct LDSSEParser *const parser,
+    ld_sse_stream_begin       streamBegin,
+    ld_sse_stream_data        streamData);
+
 void
 LDSSEParserDestroy(struct LDSSEParser *const parser);
 
@@ -5,6 +5,7 @@
 #include <launchdarkly/user.h>
 
 #include "assertion.h"
+#include "json_internal.h"
 #include "user.h"
 #include "utility.h"
 
@@ -218,6 +219,10 @@ LDUserSetCustom(struct LDUser *const user, struct LDJSON *const custom)
     LDJSONFree(user->custom);
 
     user->custom = custom;
+
+    /* copied into every event carrying the user, share it instead. Failing to
+    freeze only means those are deep copies. */
+    LDJSONFreeze(user->custom);
 }
 
 void
@@ -433,7 +438,7 @@ LDi_userToJSON(
     addstring(country);
 
     if (user->custom) {
-        struct LDJSON *const custom = LDJSONDuplicate(user->custom);
+        struct LDJSON *const custom = LDi_JSONShare(user->custom);
 
         if (!custom) {
             LDJSONFree(json);
@@ -540,7 +545,7 @@ LDi_valueOfAttribute(
         LD_ASSERT(LDJSONGetType(user->custom) == LDObject);
 
         if ((node = LDObjectLookup(user->custom, attribute))) {
-            return LDJSONDuplicate(node);
+            return LDi_JSONShare(node);
         }
 
         return NULL;
@@ -164,6 +164,27 @@ LDi_getMonotonicMilliseconds(double *const resultMilliseconds)
 #endif
 }
 
+double
+LDi_getMonotonicNanoseconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+
+    return (double)counter.QuadPart * 1e9 / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+
+    if (!LDi_clockGetTime(&ts, LD_CLOCK_MONOTONIC)) {
+        return 0;
+    }
+
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
 LDBoolean
 LDi_getUnixMilliseconds(double *const resultMilliseconds)
 {
@@ -26,6 +26,9 @@ LDBoolean
 LDi_getMonotonicMilliseconds(double *const resultMilliseconds);
 LDBoolean
 LDi_getUnixMilliseconds(double *const resultMilliseconds);
+/* for timing short operations, only differences are meaningful */
+double
+LDi_getMonotonicNanoseconds(void);
 LDBoolean
 LDi_randomHex(char *const buffer, const size_t bufferSize);
 #define LD_UUID_SIZE 36
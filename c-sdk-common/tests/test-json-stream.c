@@ -0,0 +1,254 @@
+#include <locale.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "json_stream.h"
+
+/* records tokens as a compact string for comparison */
+static char   trace[4096];
+static size_t traceSize;
+
+static LDBoolean
+recordToken(const enum LDJSONStreamToken token, const char *const text,
+    const size_t textSize, const double number, void *const context)
+{
+    char *const cursor = trace + traceSize;
+
+    LD_ASSERT(context == NULL);
+    LD_ASSERT(strlen(text) == textSize);
+
+    switch (token) {
+    case LDJSONStreamObjectStart: traceSize += sprintf(cursor, "{"); break;
+    case LDJSONStreamObjectEnd:   traceSize += sprintf(cursor, "}"); break;
+    case LDJSONStreamArrayStart:  traceSize += sprintf(cursor, "["); break;
+    case LDJSONStreamArrayEnd:    traceSize += sprintf(cursor, "]"); break;
+    case LDJSONStreamKey:  traceSize += sprintf(cursor, "k:%s ", text); break;
+    case LDJSONStreamText: traceSize += sprintf(cursor, "s:%s ", text); break;
+    case LDJSONStreamNumber: traceSize += sprintf(cursor, "n:%g ", number); break;
+    case LDJSONStreamTrue:   traceSize += sprintf(cursor, "t "); break;
+    case LDJSONStreamFalse:  traceSize += sprintf(cursor, "f "); break;
+    case LDJSONStreamNull:   traceSize += sprintf(cursor, "z "); break;
+    }
+
+    return LDBooleanTrue;
+}
+
+/* parses text in chunks of chunkSize, returns success */
+static LDBoolean
+parse(const char *const text, const size_t chunkSize)
+{
+    struct LDJSONStreamParser parser;
+    size_t                    offset;
+    LDBoolean                 status;
+
+    traceSize = 0;
+    trace[0]  = '\0';
+    status    = LDBooleanTrue;
+
+    LDJSONStreamParserInitialize(&parser, recordToken, NULL);
+
+    for (offset = 0; offset < strlen(text) && status; offset += chunkSize) {
+        size_t size = strlen(text) - offset;
+
+        if (size > chunkSize) {
+            size = chunkSize;
+        }
+
+        status = LDJSONStreamParserProcess(&parser, text + offset, size);
+    }
+
+    if (status) {
+        status = LDJSONStreamParserFinish(&parser);
+    }
+
+    LDJSONStreamParserDestroy(&parser);
+
+    return status;
+}
+
+static void
+testTokens(void)
+{
+    const char *const text =
+        " {\"a\": [1, -2.5e1, \"x\\ty\", true, false, null, {}, []],\r\n"
+        "\"b\\u0041\": {\"c\": \"\\u00e9\\ud83d\\ude00\\\"\"}} ";
+    const char *const expected =
+        "{k:a [n:1 n:-25 s:x\ty t f z {}[]]k:bA {k:c s:\xc3\xa9\xf0\x9f\x98\x80\" }}";
+    size_t chunkSize;
+
+    /* every way of splitting the document gives the same tokens */
+    for (chunkSize = 1; chunkSize <= strlen(text); chunkSize++) {
+        LD_ASSERT(parse(text, chunkSize));
+        LD_ASSERT(strcmp(trace, expected) == 0);
+    }
+}
+
+static void
+testScalarDocuments(void)
+{
+    LD_ASSERT(parse("52", 1));
+    LD_ASSERT(strcmp(trace, "n:52 ") == 0);
+
+    LD_ASSERT(parse(" \"text\" ", 3));
+    LD_ASSERT(strcmp(trace, "s:text ") == 0);
+
+    LD_ASSERT(parse("null", 2));
+    LD_ASSERT(strcmp(trace, "z ") == 0);
+}
+
+/* captures the raw text of the value of the top level key "v" into trace */
+static LDBoolean captureNext;
+
+static LDBoolean
+captureToken(const enum LDJSONStreamToken token, const char *const text,
+    const size_t textSize, const double number, void *const context)
+{
+    struct LDJSONStreamParser *const parser =
+        (struct LDJSONStreamParser *)context;
+
+    (void)textSize;
+    (void)number;
+
+    if (token == LDJSONStreamKey && parser->depth == 1) {
+        captureNext = strcmp(text, "v") == 0;
+    } else if (token == LDJSONStreamObjectStart && parser->depth == 2 &&
+        captureNext)
+    {
+        LDJSONStreamParserBeginCapture(parser);
+    } else if (token == LDJSONStreamObjectEnd && parser->depth == 1 &&
+        parser->capturing)
+    {
+        char * captured;
+        size_t capturedSize;
+
+        LD_ASSERT(captured = LDJSONStreamParserEndCapture(parser, &capturedSize));
+        LD_ASSERT(capturedSize == strlen(captured));
+        LD_ASSERT(capturedSize < sizeof(trace));
+
+        memcpy(trace, captured, capturedSize + 1);
+
+        LDFree(captured);
+    }
+
+    return LDBooleanTrue;
+}
+
+static void
+testCapture(void)
+{
+    const char *const text =
+        "{\"a\": {\"b\": 1}, \"v\": {\"x\": [1, \"}\\\"\", {}], \"y\" : null} ,"
+        " \"c\": 2}";
+    const char *const expected =
+        "{\"x\": [1, \"}\\\"\", {}], \"y\" : null}";
+    size_t chunkSize;
+
+    for (chunkSize = 1; chunkSize <= strlen(text); chunkSize++) {
+        struct LDJSONStreamParser parser;
+        size_t                    offset;
+
+        trace[0] = '\0';
+
+        LDJSONStreamParserInitialize(&parser, captureToken, &parser);
+
+        for (offset = 0; offset < strlen(text); offset += chunkSize) {
+            size_t size = strlen(text) - offset;
+
+            if (size > chunkSize) {
+                size = chunkSize;
+            }
+
+            LD_ASSERT(LDJSONStreamParserProcess(&parser, text + offset, size));
+        }
+
+        LD_ASSERT(LDJSONStreamParserFinish(&parser));
+        LD_ASSERT(strcmp(trace, expected) == 0);
+
+        LDJSONStreamParserDestroy(&parser);
+    }
+}
+
+static void
+testInvalid(void)
+{
+    LD_ASSERT(!parse("", 1));
+    LD_ASSERT(!parse("{", 1));
+    LD_ASSERT(!parse("{\"a\" 1}", 1));
+    LD_ASSERT(!parse("{\"a\": 1,}", 1));
+    LD_ASSERT(!parse("[1 2]", 1));
+    LD_ASSERT(!parse("[1}", 1));
+    LD_ASSERT(!parse("nul", 1));
+    LD_ASSERT(!parse("truex", 1));
+    LD_ASSERT(!parse("1e", 1));
+    LD_ASSERT(!parse("\"a\nb\"", 1));
+    LD_ASSERT(!parse("\"\\x\"", 1));
+    LD_ASSERT(!parse("\"\\udc00\"", 1));
+    LD_ASSERT(!parse("{} {}", 1));
+}
+
+static double numberSum;
+
+static LDBoolean
+sumNumbers(const enum LDJSONStreamToken token, const char *const text,
+    const size_t textSize, const double number, void *const context)
+{
+    (void)text;
+    (void)textSize;
+    (void)context;
+
+    if (token == LDJSONStreamNumber) {
+        numberSum += number;
+    }
+
+    return LDBooleanTrue;
+}
+
+/* JSON numbers use a point whatever the locale of the host application */
+static void
+testCommaLocale(void)
+{
+    const char *const locales[] = {
+        "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "German"};
+    const char *const         text = "[0.5, -1.25e1, 3]";
+    struct LDJSONStreamParser parser;
+    size_t                    i;
+
+    for (i = 0; i < sizeof(locales) / sizeof(locales[0]); i++) {
+        if (setlocale(LC_NUMERIC, locales[i])) {
+            break;
+        }
+    }
+
+    /* no locale with a comma is installed */
+    if (i == sizeof(locales) / sizeof(locales[0])) {
+        return;
+    }
+
+    numberSum = 0;
+
+    LDJSONStreamParserInitialize(&parser, sumNumbers, NULL);
+    LD_ASSERT(LDJSONStreamParserProcess(&parser, text, strlen(text)));
+    LD_ASSERT(LDJSONStreamParserFinish(&parser));
+    LDJSONStreamParserDestroy(&parser);
+
+    LD_ASSERT(numberSum == -9);
+
+    setlocale(LC_NUMERIC, "C");
+}
+
+int
+main(void)
+{
+    LDGlobalInit();
+
+    testTokens();
+    testScalarDocuments();
+    testCapture();
+    testInvalid();
+    testCommaLocale();
+
+    return 0;
+}
@@ -0,0 +1,559 @@
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <launchdarkly/json.h>
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "buffer.h"
+#include "cJSON.h"
+#include "json_internal.h"
+#include "number_format.h"
+#include "scan.h"
+
+#define KEY_COUNT 1000
+
+static void
+makeKey(char *const buffer, const unsigned int i)
+{
+    sprintf(buffer, "key-%u", i);
+}
+
+/* large objects are indexed, check every mutation keeps lookups correct */
+static void
+testLargeObject(void)
+{
+    struct LDJSON *object, *copy, *iter;
+    char           key[32];
+    unsigned int   i;
+
+    LD_ASSERT(object = LDNewObject());
+
+    for (i = 0; i < KEY_COUNT; i++) {
+        makeKey(key, i);
+        LD_ASSERT(LDObjectSetKey(object, key, LDNewNumber(i)));
+    }
+
+    /* replace the odd keys and delete every third key */
+    for (i = 1; i < KEY_COUNT; i += 2) {
+        makeKey(key, i);
+        LD_ASSERT(LDObjectSetKey(object, key, LDNewNumber(i * 2)));
+    }
+
+    for (i = 0; i < KEY_COUNT; i += 3) {
+        makeKey(key, i);
+        LDObjectDeleteKey(object, key);
+    }
+
+    LD_ASSERT(copy = LDJSONDuplicate(object));
+    LD_ASSERT(LDJSONCompare(object, copy));
+
+    for (i = 0; i < KEY_COUNT; i++) {
+        struct LDJSON *value;
+
+        makeKey(key, i);
+        value = LDObjectLookup(copy, key);
+
+        if (i % 3 == 0) {
+            LD_ASSERT(!value);
+        } else {
+            LD_ASSERT(value);
+            LD_ASSERT(LDGetNumber(value) == (i % 2 ? i * 2 : i));
+        }
+    }
+
+    /* replaced keys moved to the end, appending still works */
+    LD_ASSERT(LDObjectSetKey(copy, "last", LDNewNull()));
+
+    for (iter = LDGetIter(copy); LDIterNext(iter); iter = LDIterNext(iter)) {
+    }
+
+    LD_ASSERT(strcmp(LDIterKey(iter), "last") == 0);
+
+    LDJSONFree(object);
+    LDJSONFree(copy);
+}
+
+/* an indexed object stays usable once its first or every member is gone */
+static void
+testLargeObjectRemoveThenAdd(void)
+{
+    struct LDJSON *object;
+    char           key[32];
+    unsigned int   i;
+
+    LD_ASSERT(object = LDNewObject());
+
+    for (i = 0; i < KEY_COUNT; i++) {
+        makeKey(key, i);
+        LD_ASSERT(LDObjectSetKey(object, key, LDNewNumber(i)));
+    }
+
+    makeKey(key, 0);
+    LDObjectDeleteKey(object, key);
+
+    LD_ASSERT(LDObjectSetKey(object, "first", LDNewNumber(1)));
+    LD_ASSERT(LDGetNumber(LDObjectLookup(object, "first")) == 1);
+    LD_ASSERT(LDCollectionGetSize(object) == KEY_COUNT);
+
+    makeKey(key, 1);
+    LD_ASSERT(strcmp(LDIterKey(LDGetIter(object)), key) == 0);
+
+    for (i = 1; i < KEY_COUNT; i++) {
+        makeKey(key, i);
+        LDObjectDeleteKey(object, key);
+    }
+
+    LDObjectDeleteKey(object, "first");
+    LD_ASSERT(LDCollectionGetSize(object) == 0);
+
+    LD_ASSERT(LDObjectSetKey(object, "only", LDNewNumber(2)));
+    LD_ASSERT(LDObjectSetKey(object, "second", LDNewNumber(3)));
+    LD_ASSERT(LDCollectionGetSize(object) == 2);
+    LD_ASSERT(strcmp(LDIterKey(LDGetIter(object)), "only") == 0);
+    LD_ASSERT(LDGetNumber(LDObjectLookup(object, "second")) == 3);
+
+    LDJSONFree(object);
+}
+
+static void
+testParsedObjectDuplicateKeys(void)
+{
+    struct LDJSON *object;
+    char           text[KEY_COUNT * 16];
+    size_t         size;
+    unsigned int   i;
+
+    size = sprintf(text, "{\"dupe\": 1");
+
+    for (i = 0; i < KEY_COUNT; i++) {
+        size += sprintf(text + size, ", \"key-%u\": %u", i, i);
+    }
+
+    sprintf(text + size, ", \"dupe\": 2}");
+
+    LD_ASSERT(object = LDJSONDeserialize(text));
+
+    /* the first member with a key is found */
+    LD_ASSERT(LDGetNumber(LDObjectLookup(object, "dupe")) == 1);
+    LD_ASSERT(LDGetNumber(LDObjectLookup(object, "key-500")) == 500);
+
+    LDObjectDeleteKey(object, "dupe");
+    LD_ASSERT(LDGetNumber(LDObjectLookup(object, "dupe")) == 2);
+
+    LDObjectDeleteKey(object, "dupe");
+    LD_ASSERT(!LDObjectLookup(object, "dupe"));
+    LD_ASSERT(LDCollectionGetSize(object) == KEY_COUNT);
+
+    LDJSONFree(object);
+}
+
+static void
+testArena(void)
+{
+    struct LDJSON *arena, *heap, *value, *copy;
+    char           text[KEY_COUNT * 2 + 16];
+    unsigned int   i;
+    const char *const document =
+        "{\"a\": [1, \"two\", null, true], \"b\": {\"c\": \"d\\n\"}}";
+
+    LD_ASSERT(arena = LDJSONDeserializeArena(document));
+    LD_ASSERT(heap = LDJSONDeserialize(document));
+    LD_ASSERT(LDJSONCompare(arena, heap));
+
+    /* values copied out of the arena outlive it */
+    LD_ASSERT(copy = LDJSONDuplicate(LDObjectLookup(arena, "b")));
+
+    /* arena documents can still be modified */
+    LD_ASSERT(value = LDObjectDetachKey(arena, "a"));
+    LDJSONFree(value);
+    LD_ASSERT(LDObjectSetKey(arena, "b", LDNewText("e")));
+    LD_ASSERT(LDObjectSetKey(arena, "f", LDNewNumber(3)));
+    LD_ASSERT(LDCollectionGetSize(arena) == 2);
+
+    LDJSONFree(arena);
+
+    LD_ASSERT(LDJSONCompare(copy, LDObjectLookup(heap, "b")));
+
+    LDJSONFree(copy);
+    LDJSONFree(heap);
+
+    /* enough small values to need several blocks */
+    text[0] = '[';
+    for (i = 0; i < KEY_COUNT; i++) {
+        text[i * 2 + 1] = '1';
+        text[i * 2 + 2] = ',';
+    }
+    text[KEY_COUNT * 2] = ']';
+    text[KEY_COUNT * 2 + 1] = '\0';
+
+    LD_ASSERT(arena = LDJSONDeserializeArena(text));
+    LD_ASSERT(LDCollectionGetSize(arena) == KEY_COUNT);
+    LDJSONFree(arena);
+
+    LD_ASSERT(!LDJSONDeserializeArena("{\"a\": [1, \"b\"}"));
+}
+
+static void
+expectFormat(const double value, const char *const expected)
+{
+    char buffer[LD_NUMBER_FORMAT_SIZE];
+
+    LD_ASSERT(LDi_formatNumber(value, buffer) == strlen(expected));
+    LD_ASSERT(strcmp(buffer, expected) == 0);
+}
+
+/* formatted text must read back as exactly the same double */
+static void
+expectRoundtrip(const double value)
+{
+    char   buffer[LD_NUMBER_FORMAT_SIZE];
+    size_t length;
+
+    length = LDi_formatNumber(value, buffer);
+
+    LD_ASSERT(length == strlen(buffer));
+    LD_ASSERT(length < LD_NUMBER_FORMAT_SIZE);
+    LD_ASSERT(strtod(buffer, NULL) == value);
+}
+
+static void
+testNumberFormat(void)
+{
+    char         buffer[LD_NUMBER_FORMAT_SIZE], expected[64];
+    unsigned int i;
+
+    expectFormat(0, "0");
+    expectFormat(-0.0 * 1, "-0");
+    expectFormat(0.1, "0.1");
+    expectFormat(-1.5, "-1.5");
+    expectFormat(0.0001, "0.0001");
+    expectFormat(0.00001, "1e-05");
+    expectFormat(1e15, "1e+15");
+    expectFormat(1e15 + 1, "1000000000000001");
+    expectFormat(1e17, "1e+17");
+    expectFormat(1e100, "1e+100");
+    expectFormat(123456789012345678.0, "1.2345678901234568e+17");
+    expectFormat(DBL_MAX, "1.7976931348623157e+308");
+    expectFormat(DBL_MIN, "2.2250738585072014e-308");
+    expectFormat(4.9406564584124654e-324, "5e-324");
+
+    /* whole numbers keep the exact text of "%1.15g" */
+    for (i = 0; i < 100000; i++) {
+        const double value = (double)rand() * (i % 2 ? -1 : 1) * (i % 7);
+
+        sprintf(expected, "%1.15g", value);
+        LDi_formatNumber(value, buffer);
+
+        LD_ASSERT(strcmp(buffer, expected) == 0);
+    }
+
+    /* arbitrary bit patterns, skipping infinities and NaNs */
+    for (i = 0; i < 100000; i++) {
+        unsigned char bytes[sizeof(double)];
+        double        value;
+        size_t        j;
+
+        for (j = 0; j < sizeof(bytes); j++) {
+            bytes[j] = (unsigned char)rand();
+        }
+
+        memcpy(&value, bytes, sizeof(value));
+
+        if (value * 0 == 0) {
+            expectRoundtrip(value);
+        }
+    }
+
+    for (i = 0; i < 1000; i++) {
+        expectRoundtrip(i / 1000.0);
+        expectRoundtrip(i * 1e-310);
+    }
+}
+
+static void
+testSerializeTo(void)
+{
+    struct LDBuffer *buffer;
+    struct LDJSON *  json, *large;
+    char *           expected;
+    const char *     data;
+    size_t           capacity;
+    unsigned int     i;
+
+    LD_ASSERT(buffer = LDBufferNew());
+    LD_ASSERT(LDBufferSize(buffer) == 0);
+    LD_ASSERT(strcmp(LDBufferData(buffer), "") == 0);
+
+    LD_ASSERT(json = LDJSONDeserialize(
+                  "{\"a\": [1, -2.5, \"x\\ty\", true, false, null], \"b\": {}}"));
+    LD_ASSERT(expected = LDJSONSerialize(json));
+
+    /* appends after existing content */
+    LD_ASSERT(LDBufferAppend(buffer, "x", 1));
+    LD_ASSERT(LDJSONSerializeTo(json, buffer));
+    LD_ASSERT(LDBufferSize(buffer) == strlen(expected) + 1);
+    LD_ASSERT(strcmp(LDBufferData(buffer) + 1, expected) == 0);
+
+    /* clearing keeps the capacity, printing again reuses it */
+    capacity = buffer->capacity;
+    data     = LDBufferData(buffer);
+    LDBufferClear(buffer);
+    LD_ASSERT(LDBufferSize(buffer) == 0);
+    LD_ASSERT(LDJSONSerializeTo(json, buffer));
+    LD_ASSERT(strcmp(LDBufferData(buffer), expected) == 0);
+    LD_ASSERT(buffer->capacity == capacity);
+    LD_ASSERT(LDBufferData(buffer) == data);
+
+    LDFree(expected);
+    LDJSONFree(json);
+
+    /* the estimate covers plain content exactly */
+    LD_ASSERT(large = LDNewArray());
+
+    for (i = 0; i < KEY_COUNT; i++) {
+        char key[32];
+
+        makeKey(key, i);
+
+        LD_ASSERT(json = LDNewObject());
+        LD_ASSERT(LDObjectSetKey(json, key, LDNewNumber(i)));
+        LD_ASSERT(LDObjectSetKey(json, "n", LDNewNumber(-(double)i - 1)));
+        LD_ASSERT(LDObjectSetKey(json, "t", LDNewText(key)));
+        LD_ASSERT(LDArrayPush(large, json));
+    }
+
+    LD_ASSERT(expected = LDJSONSerialize(large));
+    LD_ASSERT(
+        cJSON_EstimatePrintedLength((const cJSON *)large) == strlen(expected));
+
+    LDBufferClear(buffer);
+    LD_ASSERT(LDJSONSerializeTo(large, buffer));
+    LD_ASSERT(strcmp(LDBufferData(buffer), expected) == 0);
+
+    LDFree(expected);
+    LDJSONFree(large);
+
+    /* detaching leaves the buffer empty and usable */
+    LD_ASSERT(expected = LDi_bufferDetach(buffer));
+    LD_ASSERT(LDBufferSize(buffer) == 0);
+    LD_ASSERT(LDBufferAppend(buffer, "abc", 3));
+    LD_ASSERT(strcmp(LDBufferData(buffer), "abc") == 0);
+
+    LDFree(expected);
+    LDBufferFree(buffer);
+}
+
+static void
+testFreeze(void)
+{
+    struct LDJSON *json, *duplicate, *nested, *detached;
+    char           key[32];
+    unsigned int   i;
+
+    /* the sharing state lives outside of the node */
+    LD_ASSERT(sizeof(cJSON) <= 64);
+
+    LD_ASSERT(json = LDJSONDeserialize(
+                  "{\"a\": {\"b\": [1, 2]}, \"c\": \"text\", \"d\": 3}"));
+    LD_ASSERT(LDJSONFreeze(json));
+
+    /* shares have the same contents */
+    LD_ASSERT(duplicate = LDi_JSONShare(json));
+    LD_ASSERT(LDGetIter(duplicate) == LDGetIter(json));
+    LD_ASSERT(LDJSONCompare(json, duplicate));
+
+    /* nested values may be read but not modified or moved */
+    LD_ASSERT(nested = LDObjectLookup(json, "a"));
+    LD_ASSERT(detached = LDNewArray());
+    LD_ASSERT(!LDObjectSetKey(nested, "x", detached));
+    LD_ASSERT(!LDObjectDetachKey(nested, "b"));
+    LD_ASSERT(!LDSetNumber(LDObjectLookup(json, "d"), 4));
+    LD_ASSERT(!LDArrayPush(detached, nested));
+    LDJSONFree(detached);
+
+    /* modifying a share copies, the original is untouched */
+    LD_ASSERT(LDObjectSetKey(duplicate, "e", LDNewBool(LDBooleanTrue)));
+    LD_ASSERT(LDGetIter(duplicate) != LDGetIter(json));
+    LD_ASSERT(LDCollectionGetSize(duplicate) == 4);
+    LD_ASSERT(LDCollectionGetSize(json) == 3);
+    LD_ASSERT(LDSetNumber(LDObjectLookup(duplicate, "d"), 4));
+    LD_ASSERT(LDGetNumber(LDObjectLookup(json, "d")) == 3);
+    LDJSONFree(duplicate);
+
+    /* detaching through an iterator of the shared contents */
+    LD_ASSERT(duplicate = LDi_JSONShare(json));
+    LD_ASSERT(detached = LDCollectionDetachIter(
+                  duplicate, LDIterNext(LDGetIter(duplicate))));
+    LD_ASSERT(strcmp(LDIterKey(detached), "c") == 0);
+    LD_ASSERT(LDCollectionGetSize(duplicate) == 2);
+    LD_ASSERT(LDCollectionGetSize(json) == 3);
+    LDJSONFree(detached);
+
+    /* the contents outlive whichever holder is freed first */
+    LD_ASSERT(nested = LDi_JSONShare(json));
+    LDJSONFree(json);
+    LD_ASSERT(strcmp(LDGetText(LDObjectLookup(nested, "c")), "text") == 0);
+
+    /* a sole holder takes the contents over without copying */
+    json = LDGetIter(nested);
+    LD_ASSERT(LDObjectSetKey(nested, "x", LDNewNull()));
+    LD_ASSERT(LDGetIter(nested) == json);
+    LD_ASSERT(LDObjectSetKey(LDObjectLookup(nested, "a"), "x", LDNewNull()));
+    LDJSONFree(nested);
+    LDJSONFree(duplicate);
+
+    /* large indexed objects remain searchable */
+    LD_ASSERT(json = LDNewObject());
+
+    for (i = 0; i < KEY_COUNT; i++) {
+        makeKey(key, i);
+        LD_ASSERT(LDObjectSetKey(json, key, LDNewNumber(i)));
+    }
+
+    LD_ASSERT(LDJSONFreeze(json));
+    LD_ASSERT(duplicate = LDi_JSONShare(json));
+    LD_ASSERT(LDObjectSetKey(duplicate, "extra", LDNewNull()));
+
+    for (i = 0; i < KEY_COUNT; i++) {
+        makeKey(key, i);
+        LD_ASSERT(LDGetNumber(LDObjectLookup(json, key)) == i);
+        LD_ASSERT(LDGetNumber(LDObjectLookup(duplicate, key)) == i);
+    }
+
+    LD_ASSERT(!LDObjectLookup(json, "extra"));
+    LDJSONFree(json);
+    LDJSONFree(duplicate);
+
+    /* scalars and text are copied */
+    LD_ASSERT(json = LDNewText("copied"));
+    LD_ASSERT(LDJSONFreeze(json));
+    LD_ASSERT(duplicate = LDi_JSONShare(json));
+    LD_ASSERT(LDGetText(duplicate) != LDGetText(json));
+    LDJSONFree(json);
+    LD_ASSERT(strcmp(LDGetText(duplicate), "copied") == 0);
+    LDJSONFree(duplicate);
+
+    /* duplicates are deep copies, modifiable at any depth */
+    LD_ASSERT(json = LDJSONDeserialize("{\"a\": {\"b\": [1]}}"));
+    LD_ASSERT(LDJSONFreeze(json));
+    LD_ASSERT(duplicate = LDJSONDuplicate(json));
+    LD_ASSERT(nested = LDObjectLookup(duplicate, "a"));
+    LD_ASSERT(LDObjectSetKey(nested, "c", LDNewNull()));
+    LD_ASSERT(LDArrayPush(LDObjectLookup(nested, "b"), LDNewNumber(2)));
+    LD_ASSERT(LDSetNumber(LDArrayLookup(LDObjectLookup(nested, "b"), 0), 3));
+    LD_ASSERT(LDCollectionGetSize(LDObjectLookup(json, "a")) == 1);
+    LD_ASSERT(LDGetNumber(LDArrayLookup(
+                  LDObjectLookup(LDObjectLookup(json, "a"), "b"), 0)) == 1);
+    LDJSONFree(json);
+    LDJSONFree(duplicate);
+
+    LD_ASSERT(json = LDJSONDeserializeArena("{\"a\": 1}"));
+    LD_ASSERT(!LDJSONFreeze(json));
+    LDJSONFree(json);
+}
+
+static void
+testScanJSONString(void)
+{
+    const char   specials[] = {'"', '\\', '\0', '\n', 0x1F};
+    char         buffer[100];
+    unsigned int i, j;
+
+    /* bytes with the high bit set are ordinary, as in UTF-8 text */
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (char)(i % 2 ? 0x80 + i : 'a' + i % 26);
+    }
+
+    LD_ASSERT(LDi_scanJSONString(buffer, 0) == 0);
+    LD_ASSERT(LDi_scanJSONString(buffer, sizeof(buffer)) == sizeof(buffer));
+
+    for (i = 0; i < sizeof(buffer); i++) {
+        for (j = 0; j < sizeof(specials); j++) {
+            const char original = buffer[i];
+
+            buffer[i] = specials[j];
+
+            LD_ASSERT(LDi_scanJSONString(buffer, sizeof(buffer)) == i);
+            LD_ASSERT(LDi_scanJSONString(buffer, i) == i);
+            LD_ASSERT(LDi_scanJSONString(buffer + i, 1) == 0);
+
+            buffer[i] = original;
+        }
+    }
+}
+
+/* strings with escapes at every position survive serialization */
+static void
+testStringRoundtrip(void)
+{
+    const char *const specials[] = {"\"", "\\", "\n", "\x01", "\xc3\xa9"};
+    const char *const escaped[]  = {"\\\"", "\\\\", "\\n", "\\u0001", "\xc3\xa9"};
+    struct LDJSON *   parsed;
+    unsigned int      length, position, i;
+
+    for (length = 0; length < 70; length++) {
+        for (position = 0; position <= length; position++) {
+            for (i = 0; i < sizeof(specials) / sizeof(specials[0]); i++) {
+                char           text[128], expected[160];
+                struct LDJSON *json;
+                char *         serialized;
+
+                memset(text, 'x', length);
+                text[length] = '\0';
+                memcpy(expected, text, position);
+                sprintf(
+                    expected + position,
+                    "%s%s",
+                    escaped[i],
+                    text + position);
+
+                sprintf(text + position, "%s", specials[i]);
+                memset(text + strlen(text), 'x', length - position);
+                text[length + strlen(specials[i])] = '\0';
+
+                LD_ASSERT(json = LDNewText(text));
+                LD_ASSERT(serialized = LDJSONSerialize(json));
+                LD_ASSERT(serialized[0] == '"');
+                LD_ASSERT(strncmp(serialized + 1, expected, strlen(expected)) == 0);
+                LD_ASSERT(strcmp(serialized + 1 + strlen(expected), "\"") == 0);
+
+                LD_ASSERT(parsed = LDJSONDeserialize(serialized));
+                LD_ASSERT(strcmp(LDGetText(parsed), text) == 0);
+
+                LDFree(serialized);
+                LDJSONFree(parsed);
+                LDJSONFree(json);
+            }
+        }
+    }
+
+    /* escapes that are only ever parsed, and unescaped control characters */
+    LD_ASSERT(parsed = LDJSONDeserialize("\"a\\/b\\u0041\\t\x01\""));
+    LD_ASSERT(strcmp(LDGetText(parsed), "a/bA\t\x01") == 0);
+    LDJSONFree(parsed);
+
+    LD_ASSERT(!LDJSONDeserialize("\"abc"));
+    LD_ASSERT(!LDJSONDeserialize("\"abc\\"));
+    LD_ASSERT(!LDJSONDeserialize("\"abc\\\""));
+}
+
+int
+main(void)
+{
+    LDGlobalInit();
+
+    testLargeObject();
+    testLargeObjectRemoveThenAdd();
+    testParsedObjectDuplicateKeys();
+    testArena();
+    testNumberFormat();
+    testSerializeTo();
+    testFreeze();
+    testScanJSONString();
+    testStringRoundtrip();
+
+    return 0;
+}
@@ -1,10 +1,16 @@
+#include <stdio.h>
 #include <string.h>
 
+/* more verbose calls in this file are compiled out */
+#define LD_LOG_MIN_LEVEL LD_LOG_INFO
+
 #include <launchdarkly/boolean.h>
 #include <launchdarkly/logging.h>
 
 #include "assertion.h"
+#include "atomic.h"
 #include "logging.h"
+#include "utility.h"
 
 static void
 testLogLevelToString(void)
@@ -100,6 +106,162 @@ testRespectsLogLevel(void)
     LD_LOG(LD_LOG_WARNING, "c");
     LD_ASSERT(logLevel == LD_LOG_WARNING);
     LD_ASSERT(endsWith(logBuffer, "c"));
+
+    /* the macros are expressions */
+    (void)(LD_LOG(LD_LOG_ERROR, "d"), 0);
+    LD_ASSERT(logLevel == LD_LOG_ERROR);
+    LD_ASSERT(endsWith(logBuffer, "d"));
+}
+
+static unsigned int evaluations;
+
+static const char *
+countEvaluation(void)
+{
+    evaluations++;
+
+    return "x";
+}
+
+static void
+testFilteredArgumentsNotEvaluated(void)
+{
+    LDConfigureGlobalLogger(LD_LOG_INFO, bufferLogger);
+
+    evaluations = 0;
+
+    LD_LOG_1(LD_LOG_WARNING, "%s", countEvaluation());
+    LD_ASSERT(evaluations == 1);
+
+    LD_LOG_1(LD_LOG_DEBUG, "%s", countEvaluation());
+    LD_ASSERT(evaluations == 1);
+
+    LDConfigureGlobalLogger(LD_LOG_INFO, NULL);
+
+    LD_LOG_1(LD_LOG_WARNING, "%s", countEvaluation());
+    LD_ASSERT(evaluations == 1);
+}
+
+static void
+testMinimumLevelCompiledOut(void)
+{
+    LDConfigureGlobalLogger(LD_LOG_TRACE, bufferLogger);
+
+    LD_LOG(LD_LOG_INFO, "a");
+    LD_ASSERT(logLevel == LD_LOG_INFO);
+    LD_ASSERT(endsWith(logBuffer, "a"));
+
+    LD_LOG(LD_LOG_DEBUG, "b");
+    LD_LOG_1(LD_LOG_TRACE, "%s", countEvaluation());
+    LD_ASSERT(endsWith(logBuffer, "a"));
+
+    /* the function itself still honors the runtime level */
+    LDi_log(LD_LOG_DEBUG, "c");
+    LD_ASSERT(logLevel == LD_LOG_DEBUG);
+}
+
+/* written only by the async writer thread, read after shutdown joins it */
+static char         asyncTexts[8][64];
+static unsigned int asyncCount;
+static unsigned int asyncNotes;
+static ld_atomic_t  asyncHold;
+
+static void
+asyncLogger(const LDLogLevel level, const char *const text)
+{
+    while (LDi_atomicLoad(&asyncHold)) {
+        LDi_sleepMilliseconds(1);
+    }
+
+    if (strncmp(text, "async logger:", 13) == 0) {
+        LD_ASSERT(level == LD_LOG_WARNING);
+
+        asyncNotes++;
+
+        return;
+    }
+
+    if (asyncCount < 8) {
+        strncpy(asyncTexts[asyncCount], text, sizeof(asyncTexts[0]) - 1);
+    }
+
+    asyncCount++;
+}
+
+static void
+resetAsyncLogger(void)
+{
+    memset(asyncTexts, 0, sizeof(asyncTexts));
+    asyncCount = 0;
+    asyncNotes = 0;
+
+    LD_ASSERT(LDAsyncLoggerInitialize(asyncLogger));
+    LDConfigureGlobalLogger(LD_LOG_INFO, LDAsyncLogger);
+}
+
+static void
+testAsyncLoggerWritesInOrder(void)
+{
+    resetAsyncLogger();
+
+    LD_LOG(LD_LOG_INFO, "a");
+    LD_LOG(LD_LOG_WARNING, "b");
+    LD_LOG(LD_LOG_DEBUG, "c");
+    LD_LOG(LD_LOG_ERROR, "d");
+
+    LDAsyncLoggerShutdown();
+
+    LD_ASSERT(asyncCount == 3);
+    LD_ASSERT(endsWith(asyncTexts[0], "a"));
+    LD_ASSERT(endsWith(asyncTexts[1], "b"));
+    LD_ASSERT(endsWith(asyncTexts[2], "d"));
+    LD_ASSERT(asyncNotes == 0);
+    LD_ASSERT(LDAsyncLoggerDropped() == 0);
+}
+
+static void
+testAsyncLoggerSuppressesRepeats(void)
+{
+    unsigned int i;
+
+    resetAsyncLogger();
+
+    for (i = 0; i < 100; i++) {
+        LDAsyncLogger(LD_LOG_ERROR, "repeated");
+    }
+
+    LDAsyncLoggerShutdown();
+
+    /* at most a burst in each of two seconds if the loop crossed one */
+    LD_ASSERT(asyncCount >= 10 && asyncCount <= 20);
+    LD_ASSERT(LDAsyncLoggerDropped() == 100 - asyncCount);
+    LD_ASSERT(asyncNotes >= 1);
+}
+
+static void
+testAsyncLoggerDropsWhenFull(void)
+{
+    unsigned int i;
+    char         text[32];
+
+    resetAsyncLogger();
+
+    LDi_atomicStore(&asyncHold, 1);
+
+    for (i = 0; i < 1000; i++) {
+        snprintf(text, sizeof(text), "message %u", i);
+
+        LDAsyncLogger(LD_LOG_INFO, text);
+    }
+
+    LDi_atomicStore(&asyncHold, 0);
+
+    LDAsyncLoggerShutdown();
+
+    LD_ASSERT(LDAsyncLoggerDropped() > 0);
+    LD_ASSERT(asyncCount + LDAsyncLoggerDropped() == 1000);
+    LD_ASSERT(endsWith(asyncTexts[0], "message 0"));
+    LD_ASSERT(asyncNotes >= 1);
 }
 
 int
@@ -109,6 +271,11 @@ main(void)
     testLoggingFormatting();
     testBasicLoggers();
     testRespectsLogLevel();
+    testFilteredArgumentsNotEvaluated();
+    testMinimumLevelCompiledOut();
+    testAsyncLoggerWritesInOrder();
+    testAsyncLoggerSuppressesRepeats();
+    testAsyncLoggerDropsWhenFull();
 
     return 0;
 }
@@ -0,0 +1,208 @@
+#include <string.h>
+
+#include <launchdarkly/json.h>
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "concurrency.h"
+
+#define THREAD_COUNT 4
+
+static void
+testSizes(void)
+{
+    char * blocks[2100];
+    size_t i, j;
+
+    /* every size up to beyond the largest class, written in full */
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+        LD_ASSERT(blocks[i] = (char *)LDAlloc(i));
+        LD_ASSERT(((size_t)blocks[i]) % 16 == 0);
+
+        memset(blocks[i], (int)(i % 251), i);
+    }
+
+    for (i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+        for (j = 0; j < i; j++) {
+            LD_ASSERT(blocks[i][j] == (char)(i % 251));
+        }
+
+        LDFree(blocks[i]);
+    }
+
+    LDFree(NULL);
+}
+
+static void
+testRealloc(void)
+{
+    char * buffer;
+    size_t size;
+
+    LD_ASSERT(buffer = (char *)LDRealloc(NULL, 1));
+    buffer[0] = 0;
+
+    /* grows through every class and into malloc, keeping contents */
+    for (size = 2; size < 5000; size = size * 3 / 2 + 1) {
+        size_t i;
+
+        LD_ASSERT(buffer = (char *)LDRealloc(buffer, size));
+
+        for (i = 0; i < size * 2 / 3; i++) {
+            LD_ASSERT(buffer[i] == (char)i);
+        }
+
+        for (i = 0; i < size; i++) {
+            buffer[i] = (char)i;
+        }
+    }
+
+    /* and back down */
+    LD_ASSERT(buffer = (char *)LDRealloc(buffer, 20));
+    LD_ASSERT(buffer[19] == 19);
+
+    LDFree(buffer);
+}
+
+static void
+testStrings(void)
+{
+    char *copy;
+    int * zeroed;
+    int   i;
+
+    LD_ASSERT(copy = LDStrDup("pooled"));
+    LD_ASSERT(strcmp(copy, "pooled") == 0);
+    LDFree(copy);
+
+    LD_ASSERT(copy = LDStrNDup("pooled", 4));
+    LD_ASSERT(strcmp(copy, "pool") == 0);
+    LDFree(copy);
+
+    LD_ASSERT(copy = LDStrNDup("ab", 10));
+    LD_ASSERT(strcmp(copy, "ab") == 0);
+    LDFree(copy);
+
+    LD_ASSERT(zeroed = (int *)LDCalloc(100, sizeof(int)));
+
+    for (i = 0; i < 100; i++) {
+        LD_ASSERT(zeroed[i] == 0);
+    }
+
+    LDFree(zeroed);
+
+    LD_ASSERT(!LDCalloc((size_t)-1, 16));
+}
+
+/* blocks allocated by one thread and freed by another end up in the cache of
+the freeing thread */
+static char *handoff[THREAD_COUNT][1000];
+
+static THREAD_RETURN
+churn(void *const context)
+{
+    char **const blocks = (char **)context;
+    size_t       round, i;
+
+    for (round = 0; round < 20; round++) {
+        for (i = 0; i < 1000; i++) {
+            if (blocks[i]) {
+                LDFree(blocks[i]);
+            }
+
+            LD_ASSERT(blocks[i] = (char *)LDAlloc(i % 300));
+
+            memset(blocks[i], 1, i % 300);
+        }
+    }
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+static void
+testThreads(void)
+{
+    ld_thread_t threads[THREAD_COUNT];
+    size_t      i, j;
+
+    for (i = 0; i < THREAD_COUNT; i++) {
+        LD_ASSERT(LDi_thread_create(&threads[i], churn, handoff[i]));
+    }
+
+    for (i = 0; i < THREAD_COUNT; i++) {
+        LD_ASSERT(LDi_thread_join(&threads[i]));
+    }
+
+    for (i = 0; i < THREAD_COUNT; i++) {
+        for (j = 0; j < 1000; j++) {
+            LDFree(handoff[i][j]);
+        }
+    }
+}
+
+/* the cache of an exiting thread is shared, so each thread below reuses the
+block of the one before rather than carving a slab */
+static THREAD_RETURN
+allocateOne(void *const context)
+{
+    char **const block = (char **)context;
+
+    LD_ASSERT(*block = (char *)LDAlloc(16));
+
+    LDFree(*block);
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+static void
+testThreadExit(void)
+{
+    char *      blocks[100];
+    ld_thread_t thread;
+    size_t      i, j, distinct;
+
+    for (i = 0; i < 100; i++) {
+        LD_ASSERT(LDi_thread_create(&thread, allocateOne, &blocks[i]));
+        LD_ASSERT(LDi_thread_join(&thread));
+    }
+
+    for (distinct = 0, i = 0; i < 100; i++) {
+        for (j = 0; j < i && blocks[j] != blocks[i]; j++) {}
+
+        if (j == i) {
+            distinct++;
+        }
+    }
+
+    LD_ASSERT(distinct <= 2);
+}
+
+static void
+testJSON(void)
+{
+    struct LDJSON *json;
+    char *         text;
+
+    LD_ASSERT(json = LDJSONDeserialize("{\"a\": [1, \"two\", {\"b\": null}]}"));
+    LD_ASSERT(text = LDJSONSerialize(json));
+    LD_ASSERT(strcmp(text, "{\"a\":[1,\"two\",{\"b\":null}]}") == 0);
+
+    LDFree(text);
+    LDJSONFree(json);
+}
+
+int
+main(void)
+{
+    LDSetPoolMemoryRoutines();
+    LDGlobalInit();
+
+    testSizes();
+    testRealloc();
+    testStrings();
+    testThreads();
+    testThreadExit();
+    testJSON();
+
+    return 0;
+}
@@ -1,16 +1,31 @@
+#include <stdlib.h>
 #include <string.h>
 
+#include <launchdarkly/memory.h>
+
 #include "assertion.h"
+#include "scan.h"
 #include "sse.h"
 
-static char nameBuffer[4096], bodyBuffer[4096];
+static char   nameBuffer[4096], bodyBuffer[4096];
+static size_t bodySize;
+static int    dispatchCount;
 
 static LDBoolean
-mockDispatch(const char *const name, const char *const body,
-    void *const context)
+mockDispatch(const char *const name, const size_t nameSize,
+    const char *const body, const size_t bodyLength, void *const context)
 {
-    memcpy(nameBuffer, name, strlen(name) + 1);
-    memcpy(bodyBuffer, body, strlen(body) + 1);
+    LD_ASSERT(strlen(name) == nameSize);
+
+    memcpy(nameBuffer, name, nameSize + 1);
+
+    if (bodyLength < sizeof(bodyBuffer)) {
+        memcpy(bodyBuffer, body, bodyLength + 1);
+    }
+
+    bodySize = bodyLength;
+
+    dispatchCount++;
 
     return LDBooleanTrue;
 }
@@ -33,10 +48,236 @@ testBasicEvent(void)
     LDSSEParserDestroy(&parser);
 }
 
+static void
+testMultiLineData(void)
+{
+    struct LDSSEParser parser;
+
+    LDSSEParserInitialize(&parser, mockDispatch, NULL);
+
+    const char *const event =
+        ": comment\n"
+        "event: patch\n"
+        "data: a\n"
+        "data:b\n"
+        "data: c\n\n";
+
+    LD_ASSERT(LDSSEParserProcess(&parser, event, strlen(event)));
+    LD_ASSERT(strcmp(nameBuffer, "patch") == 0);
+    LD_ASSERT(strcmp(bodyBuffer, "a\nb\nc") == 0);
+    LD_ASSERT(bodySize == 5);
+
+    LDSSEParserDestroy(&parser);
+}
+
+static void
+testSplitAcrossChunks(void)
+{
+    struct LDSSEParser parser;
+    size_t             i;
+
+    LDSSEParserInitialize(&parser, mockDispatch, NULL);
+
+    const char *const event =
+        "event: put\n"
+        "data: {\"a\": 1}\n\n"
+        "event: delete\n"
+        "data: {\"key\": \"a\"}\n\n";
+
+    dispatchCount = 0;
+
+    /* deliver one byte at a time */
+    for (i = 0; i < strlen(event); i++) {
+        LD_ASSERT(LDSSEParserProcess(&parser, event + i, 1));
+    }
+
+    LD_ASSERT(dispatchCount == 2);
+    LD_ASSERT(strcmp(nameBuffer, "delete") == 0);
+    LD_ASSERT(strcmp(bodyBuffer, "{\"key\": \"a\"}") == 0);
+
+    LDSSEParserDestroy(&parser);
+}
+
+static void
+testLargeEvent(void)
+{
+    struct LDSSEParser parser;
+    char *             line;
+    const size_t       lineSize = 1024 * 1024;
+    const char *const  prefix   = "event: put\ndata: ";
+    const char *const  suffix   = "\n\n";
+
+    LDSSEParserInitialize(&parser, mockDispatch, NULL);
+
+    LD_ASSERT(line = (char *)malloc(lineSize));
+    memset(line, 'x', lineSize);
+
+    dispatchCount = 0;
+
+    LD_ASSERT(LDSSEParserProcess(&parser, prefix, strlen(prefix)));
+    /* the body arrives as many curl sized chunks */
+    LD_ASSERT(LDSSEParserProcess(&parser, line, lineSize / 2));
+    LD_ASSERT(LDSSEParserProcess(&parser, line, lineSize / 2));
+    LD_ASSERT(LDSSEParserProcess(&parser, suffix, strlen(suffix)));
+
+    LD_ASSERT(dispatchCount == 1);
+    LD_ASSERT(bodySize == lineSize);
+    LD_ASSERT(strcmp(nameBuffer, "put") == 0);
+
+    free(line);
+
+    LDSSEParserDestroy(&parser);
+}
+
+static void
+testLineEndings(void)
+{
+    struct LDSSEParser parser;
+    size_t             i;
+
+    LDSSEParserInitialize(&parser, mockDispatch, NULL);
+
+    const char *const event =
+        "event: patch\r\n"
+        "data: a\r"
+        "data: b\n"
+        "\r\n"
+        "event: delete\r"
+        "data: c\r"
+        "\r";
+
+    dispatchCount = 0;
+
+    LD_ASSERT(LDSSEParserProcess(&parser, event, strlen(event)));
+    LD_ASSERT(dispatchCount == 2);
+    LD_ASSERT(strcmp(nameBuffer, "delete") == 0);
+    LD_ASSERT(strcmp(bodyBuffer, "c") == 0);
+
+    /* a CRLF pair split between chunks is a single line ending */
+    dispatchCount = 0;
+
+    for (i = 0; i < strlen(event); i++) {
+        LD_ASSERT(LDSSEParserProcess(&parser, event + i, 1));
+
+        if (dispatchCount == 1) {
+            LD_ASSERT(strcmp(nameBuffer, "patch") == 0);
+            LD_ASSERT(strcmp(bodyBuffer, "a\nb") == 0);
+        }
+    }
+
+    LD_ASSERT(dispatchCount == 2);
+
+    LDSSEParserDestroy(&parser);
+}
+
+static void
+testScanLineEnd(void)
+{
+    char   buffer[100];
+    size_t i;
+
+    memset(buffer, 'x', sizeof(buffer));
+
+    LD_ASSERT(LDi_scanLineEnd(buffer, 0) == 0);
+    LD_ASSERT(LDi_scanLineEnd(buffer, sizeof(buffer)) == sizeof(buffer));
+
+    /* every position in and around the vector blocks */
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = '\n';
+        LD_ASSERT(LDi_scanLineEnd(buffer, sizeof(buffer)) == i);
+        buffer[i] = '\r';
+        LD_ASSERT(LDi_scanLineEnd(buffer, sizeof(buffer)) == i);
+        LD_ASSERT(LDi_scanLineEnd(buffer, i) == i);
+        buffer[i] = 'x';
+    }
+}
+
+static char   streamBuffer[4096];
+static size_t streamSize;
+
+static LDBoolean
+mockStreamBegin(const char *const name, const size_t nameSize,
+    void *const context)
+{
+    LD_ASSERT(strlen(name) == nameSize);
+
+    streamSize = 0;
+
+    return strcmp(name, "put") == 0;
+}
+
+static LDBoolean
+mockStreamData(const char *const data, const size_t dataSize,
+    void *const context)
+{
+    LD_ASSERT(dataSize);
+    LD_ASSERT(streamSize + dataSize < sizeof(streamBuffer));
+
+    memcpy(streamBuffer + streamSize, data, dataSize);
+    streamSize += dataSize;
+    streamBuffer[streamSize] = '\0';
+
+    return LDBooleanTrue;
+}
+
+static void
+testStreamedEvent(void)
+{
+    struct LDSSEParser parser;
+    size_t             chunkSize, offset;
+
+    const char *const event =
+        "event: put\r\n"
+        "data: {\"a\":\r\n"
+        "data:  1}\n"
+        "\n"
+        "event: patch\n"
+        "data: {\"b\": 2}\n"
+        "\n";
+
+    for (chunkSize = 1; chunkSize <= strlen(event); chunkSize++) {
+        LDSSEParserInitialize(&parser, mockDispatch, NULL);
+        LDSSEParserSetStreaming(&parser, mockStreamBegin, mockStreamData);
+
+        dispatchCount = 0;
+
+        for (offset = 0; offset < strlen(event); offset += chunkSize) {
+            size_t size = strlen(event) - offset;
+
+            if (size > chunkSize) {
+                size = chunkSize;
+            }
+
+            LD_ASSERT(LDSSEParserProcess(&parser, event + offset, size));
+
+            if (dispatchCount == 1) {
+                /* the put was streamed rather than buffered */
+                LD_ASSERT(strcmp(nameBuffer, "put") == 0);
+                LD_ASSERT(bodySize == 0);
+                LD_ASSERT(strcmp(streamBuffer, "{\"a\":\n 1}") == 0);
+            }
+        }
+
+        LD_ASSERT(dispatchCount == 2);
+        LD_ASSERT(strcmp(nameBuffer, "patch") == 0);
+        LD_ASSERT(strcmp(bodyBuffer, "{\"b\": 2}") == 0);
+
+        LDSSEParserDestroy(&parser);
+    }
+}
+
 int
 main(void)
 {
+    LDGlobalInit();
+
     testBasicEvent();
+    testMultiLineData();
+    testSplitAcrossChunks();
+    testLargeEvent();
+    testLineEndings();
+    testScanLineEnd();
+    testStreamedEvent();
 
     return 0;
 }
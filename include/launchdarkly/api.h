@@ -16,12 +16,14 @@
 extern "C" {
 #endif
 
+#include <launchdarkly/buffer.h>
 #include <launchdarkly/client.h>
 #include <launchdarkly/config.h>
 #include <launchdarkly/export.h>
 #include <launchdarkly/json.h>
 #include <launchdarkly/logging.h>
 #include <launchdarkly/memory.h>
+#include <launchdarkly/profile.h>
 #include <launchdarkly/user.h>
 
 #ifdef __cplusplus
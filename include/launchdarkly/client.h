@@ -275,3 +275,147 @@ LDClientUnregisterFeatureFlagListener(
     struct LDClient *const client,
     const char *const      flagKey,
     LDlistenerfn           listener);
+
+/** @brief Counters and gauges describing the activity of a client, filled by
+ * `LDClientGetStats`.
+ *
+ * Counters accumulate from client initialization and wrap on overflow, so
+ * rates should be computed from the difference between two samples. */
+struct LDClientStats
+{
+    /** @brief Evaluations by requested type, `LDJSONVariation` is counted as
+     * JSON */
+    unsigned long boolEvaluations;
+    unsigned long numberEvaluations;
+    unsigned long stringEvaluations;
+    unsigned long jsonEvaluations;
+    /** @brief Evaluations of flags absent from the store */
+    unsigned long flagNotFound;
+    /** @brief Evaluations of flags with a value of another type */
+    unsigned long wrongType;
+    /** @brief Analytics events accepted into the queue */
+    unsigned long eventsQueued;
+    /** @brief Analytics events discarded because the queue was at
+     * `LDConfigSetEventsCapacity` */
+    unsigned long eventsDropped;
+    /** @brief Analytics events delivered, including summary events */
+    unsigned long eventsFlushed;
+    /** @brief Successful event deliveries */
+    unsigned long flushes;
+    /** @brief Duration of the most recent successful event delivery */
+    unsigned long lastFlushMilliseconds;
+    /** @brief Event payload bytes delivered */
+    unsigned long bytesSent;
+    /** @brief Flag data bytes received by polling and streaming */
+    unsigned long bytesReceived;
+    /** @brief Stream connection attempts after a failure */
+    unsigned long streamReconnects;
+    /** @brief Delay before the most recent stream reconnection */
+    unsigned long lastStreamBackoffMilliseconds;
+    /** @brief Flags in the store, including deleted flags retained to order
+     * updates */
+    unsigned long storeSize;
+    /** @brief Incremented for every change applied to the store */
+    unsigned long storeGeneration;
+};
+
+/** @brief Fill `stats` with a snapshot of the activity of the client.
+ *
+ * Counters are maintained atomically and read without taking any lock, so
+ * collecting them does not add contention to evaluation. Fields are read
+ * independently, so a snapshot taken while the client is active may not be
+ * mutually consistent. */
+LD_EXPORT(LDBoolean)
+LDClientGetStats(
+    struct LDClient *const client, struct LDClientStats *const stats);
+
+/** @brief Distribution of sampled evaluation durations of one variation
+ * type, in nanoseconds.
+ *
+ * Percentiles are reported as the upper bound of the histogram bucket they
+ * fall in, which is within 12.5% of the recorded duration. */
+struct LDLatencySnapshot
+{
+    /** @brief Evaluations timed */
+    unsigned long count;
+    double        p50;
+    double        p90;
+    double        p99;
+    double        p999;
+    /** @brief Longest evaluation timed, exact */
+    double        max;
+};
+
+/** @brief Evaluation latency by requested type, filled by
+ * `LDClientGetEvaluationLatency`. `LDJSONVariation` is counted as JSON. */
+struct LDEvaluationLatency
+{
+    struct LDLatencySnapshot boolVariations;
+    struct LDLatencySnapshot numberVariations;
+    struct LDLatencySnapshot stringVariations;
+    struct LDLatencySnapshot jsonVariations;
+};
+
+/** @brief Fill `latency` with percentiles of the evaluations timed since the
+ * client was initialized.
+ *
+ * Returns false if timing was not enabled with
+ * `LDConfigSetEvaluationLatencySampling`. */
+LD_EXPORT(LDBoolean)
+LDClientGetEvaluationLatency(
+    struct LDClient *const client, struct LDEvaluationLatency *const latency);
+
+/** @brief An evaluation, as passed to an evaluation hook. */
+struct LDEvaluationHookData
+{
+    /** @brief The key passed to the variation function */
+    const char *flagKey;
+    /** @brief The index of the variation returned, -1 if the fallback value
+     * was returned */
+    int         variationIndex;
+    /** @brief The type requested, `LDNull` for `LDJSONVariation` */
+    LDJSONType  type;
+    /** @brief The kind of the evaluation reason, such as `"RULE_MATCH"`.
+     * `"ERROR"` when the fallback value was returned, `NULL` when the
+     * server did not send a reason. */
+    const char *reasonKind;
+    /** @brief Time taken by the evaluation */
+    double      durationNanoseconds;
+};
+
+/** @brief A callback invoked after every evaluation, on the evaluating
+ * thread. The data is valid only for the duration of the call. */
+typedef void (*LDEvaluationHook)(
+    const struct LDEvaluationHookData *const data, void *const context);
+
+/** @brief Install a hook called after every evaluation of the client, for
+ * example to annotate a trace span, replacing any previous hook.
+ *
+ * Pass a `NULL` hook to remove it. Evaluations check for a hook with a single
+ * atomic load, so a client without one pays only for that branch, and
+ * replacing a hook takes no lock. An evaluation running concurrently with
+ * the replacement may still call the previous hook, and the memory of each
+ * replaced hook is released when the client is closed, so hooks should be
+ * set rarely. */
+LD_EXPORT(LDBoolean)
+LDClientSetEvaluationHook(
+    struct LDClient *const client,
+    const LDEvaluationHook hook,
+    void *const            context);
+
+/** @brief Write the statistics of every environment in the OpenMetrics text
+ * format, for scraping by Prometheus.
+ *
+ * Covers the fields of `LDClientStats` and, where
+ * `LDConfigSetEvaluationLatencySampling` is enabled, histograms of evaluation
+ * duration, for the client and every secondary environment configured with
+ * it. Samples are labeled `environment` with the name of the environment, as
+ * used by `LDClientGetForMobileKey`. Nothing is allocated and no lock is
+ * taken.
+ *
+ * Like `snprintf` the result is the length of the complete text excluding
+ * the terminator, and if it is not less than `capacity` the text was
+ * truncated. Returns 0 on failure. */
+LD_EXPORT(size_t)
+LDClientWriteMetrics(
+    struct LDClient *const client, char *const buffer, const size_t capacity);
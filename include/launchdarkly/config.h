@@ -171,6 +171,28 @@ LDConfigAutoAliasOptOut(struct LDConfig *const config, const LDBoolean optOut);
 LD_EXPORT(void)
 LDConfigSetRequestTimeoutMillis(struct LDConfig *const config, const int millis);
 
+/** @brief Sets how long, in microseconds, streamed flag patches and deletes
+ * may be held so that a burst of them is applied as one store update.
+ *
+ * Updates that arrive in the same network read are always applied together.
+ * A non zero window also groups updates from later reads until the window
+ * has elapsed since the first held update. This delays individual updates by
+ * up to the window, or until the next network activity after it elapses.
+ * Defaults to 0. */
+LD_EXPORT(void)
+LDConfigSetStreamPatchCoalescingMicros(
+    struct LDConfig *const config, const unsigned int micros);
+
+/** @brief Sets how often evaluations are timed for
+ * `LDClientGetEvaluationLatency`.
+ *
+ * One in every `interval` evaluations on each thread is timed and recorded.
+ * A value of 1 times every evaluation. A value of 0 disables timing, leaving
+ * only a single branch on the evaluation path. Defaults to 0. */
+LD_EXPORT(void)
+LDConfigSetEvaluationLatencySampling(
+    struct LDConfig *const config, const unsigned int interval);
+
 /** @brief Free an existing `LDConfig` instance.
  *
  * You will likely never use this routine as ownership is transferred to
@@ -11,7 +11,9 @@
 
 #include <launchdarkly/api.h>
 
+#include "buffer.h"
 #include "ldinternal.h"
+#include "request_template.h"
 #include "uthash.h"
 
 static struct LDGlobal_i globalContext;
@@ -24,6 +26,7 @@ void
 LDi_earlyinit(void)
 {
     LDi_rwlock_init(&globalContext.sharedUserLock);
+    LDi_lockProfileLabel(&globalContext.sharedUserLock, "sharedUser");
     globalContext.clientTable   = NULL;
     globalContext.primaryClient = NULL;
     globalContext.sharedConfig  = NULL;
@@ -65,13 +68,10 @@ LDi_clientInitIsolated(
     struct LDGlobal_i *const shared, const char *const mobileKey)
 {
     struct LDClient *client;
-    unsigned int     threadCount;
 
     LD_ASSERT_API(shared);
     LD_ASSERT_API(mobileKey);
 
-    threadCount = 0;
-
     LDi_once(&LDi_earlyonce, LDi_earlyinit);
 
     if (!(client = LDAlloc(sizeof(*client)))) {
@@ -90,6 +90,20 @@ LDi_clientInitIsolated(
 
     LDi_initSocket(&client->streamhandle);
 
+    if (shared->sharedConfig->latencySampling) {
+        unsigned int kind;
+
+        if (!(client->latency = (struct LDLatencyHistogram *)LDAlloc(
+                  sizeof(struct LDLatencyHistogram) * LDLatencyKindCount)))
+        {
+            goto err1;
+        }
+
+        for (kind = 0; kind < LDLatencyKindCount; kind++) {
+            LDi_latencyInitialize(&client->latency[kind]);
+        }
+    }
+
     if (!LDSetString(&client->mobileKey, mobileKey)) {
         goto err1;
     }
@@ -115,74 +129,69 @@ LDi_clientInitIsolated(
         goto err6;
     }
 
+    LDi_lockProfileLabel(&client->clientLock, "client");
+    LDi_lockProfileLabel(&client->initCondMtx, "clientInit");
+    LDi_lockProfileLabel(&client->condMtx, "clientCondition");
+
     if (!LDi_cond_init(&client->initCond)) {
         goto err7;
     }
 
-    if (!LDi_cond_init(&client->eventCond)) {
+    if (!LDi_cond_init(&client->streamCond)) {
         goto err8;
     }
 
-    if (!LDi_cond_init(&client->pollCond)) {
-        goto err9;
-    }
+    LDi_rwlock_rdlock(&shared->sharedUserLock);
 
-    if (!LDi_cond_init(&client->streamCond)) {
-        goto err10;
-    }
+    client->requests = LDi_requestTemplateNew(
+        shared->sharedConfig, client->mobileKey, shared->sharedUser);
 
-    if (!LDi_thread_create(&client->eventThread, LDi_bgeventsender, client)) {
-        goto err11;
-    }
-    threadCount++;
+    LDi_rwlock_rdunlock(&shared->sharedUserLock);
 
-    if (!LDi_thread_create(&client->pollingThread, LDi_bgfeaturepoller, client))
-    {
-        goto err12;
+    if (!client->requests) {
+        goto err9;
     }
-    threadCount++;
 
-    if (!LDi_thread_create(
-            &client->streamingThread, LDi_bgfeaturestreamer, client)) {
-        goto err12;
+    LDi_initializeTimers(client);
+
+    if (shared->sharedConfig->streaming &&
+        !LDi_thread_create(
+            &client->streamingThread, LDi_bgfeaturestreamer, client))
+    {
+        goto err10;
     }
-    threadCount++;
 
     LDi_rwlock_rdlock(&shared->sharedUserLock);
 
     if (!LDi_identify(client->eventProcessor, shared->sharedUser)) {
         LDi_rwlock_rdunlock(&shared->sharedUserLock);
 
-        goto err12;
+        goto err11;
     }
 
     LDi_rwlock_rdunlock(&shared->sharedUserLock);
 
+    /* schedules the first poll and delivery */
+    LDi_clientStateChanged(client);
+
     return client;
 
-err12:
+err11:
     LDi_rwlock_wrlock(&client->clientLock);
     LDi_updatestatus(client, LDStatusShuttingdown);
     LDi_reinitializeconnection(client);
     LDi_rwlock_wrunlock(&client->clientLock);
 
-    if (threadCount > 0) {
-        LDi_thread_join(&client->eventThread);
-    }
-
-    if (threadCount > 1) {
-        LDi_thread_join(&client->pollingThread);
-    }
-
-    if (threadCount > 2) {
+    /* the streaming thread may apply a put until it is joined */
+    if (shared->sharedConfig->streaming) {
         LDi_thread_join(&client->streamingThread);
     }
-err11:
-    LDi_cond_destroy(&client->streamCond);
+
+    LDi_cancelTimers(client);
 err10:
-    LDi_cond_destroy(&client->pollCond);
+    LDi_rc_decrement(&client->requests->rc);
 err9:
-    LDi_cond_destroy(&client->eventCond);
+    LDi_cond_destroy(&client->streamCond);
 err8:
     LDi_cond_destroy(&client->initCond);
 err7:
@@ -198,6 +207,7 @@ err3:
 err2:
     LDFree(client->mobileKey);
 err1:
+    LDFree(client->latency);
     LDFree(client);
 
     return NULL;
@@ -235,6 +245,14 @@ LDClientInit(
     }
 #endif
 
+    LDi_once(&LDi_earlyonce, LDi_earlyinit);
+
+    if (!LDi_timerWheelStart(&globalContext.timers)) {
+        LD_LOG(LD_LOG_CRITICAL, "failed to start the timer thread");
+
+        return NULL;
+    }
+
     globalContext.sharedUser   = user;
     globalContext.sharedConfig = config;
 
@@ -307,7 +325,8 @@ LDClientSetOffline(struct LDClient *const client)
     HASH_ITER(hh, globalContext.clientTable, clientIter, tmp)
     {
         LDi_rwlock_wrlock(&clientIter->clientLock);
-        clientIter->offline = LDBooleanTrue;
+        LDi_atomicStore(&clientIter->offline, LDBooleanTrue);
+        LDi_clientStateChanged(clientIter);
         LDi_rwlock_wrunlock(&clientIter->clientLock);
     }
 }
@@ -330,8 +349,9 @@ LDClientSetOnline(struct LDClient *const client)
     HASH_ITER(hh, globalContext.clientTable, clientIter, tmp)
     {
         LDi_rwlock_wrlock(&clientIter->clientLock);
-        clientIter->offline = LDBooleanFalse;
+        LDi_atomicStore(&clientIter->offline, LDBooleanFalse);
         LDi_updatestatus(clientIter, LDStatusInitializing);
+        LDi_clientStateChanged(clientIter);
         LDi_rwlock_wrunlock(&clientIter->clientLock);
     }
 }
@@ -339,8 +359,6 @@ LDClientSetOnline(struct LDClient *const client)
 LDBoolean
 LDClientIsOffline(struct LDClient *const client)
 {
-    LDBoolean offline;
-
     LD_ASSERT_API(client);
 
 #ifdef LAUNCHDARKLY_DEFENSIVE
@@ -351,11 +369,7 @@ LDClientIsOffline(struct LDClient *const client)
     }
 #endif
 
-    LDi_rwlock_rdlock(&client->clientLock);
-    offline = client->offline;
-    LDi_rwlock_rdunlock(&client->clientLock);
-
-    return offline;
+    return (LDBoolean)LDi_atomicLoad(&client->offline);
 }
 
 void
@@ -372,7 +386,7 @@ LDClientSetBackground(struct LDClient *const client, const LDBoolean background)
 #endif
 
     LDi_rwlock_wrlock(&client->clientLock);
-    client->background = background;
+    LDi_atomicStore(&client->background, background);
     LDi_startstopstreaming(client, background);
     LDi_rwlock_wrunlock(&client->clientLock);
 }
@@ -380,9 +394,11 @@ LDClientSetBackground(struct LDClient *const client, const LDBoolean background)
 void
 LDClientIdentify(struct LDClient *const client, struct LDUser *const user)
 {
-    struct LDClient *clientIter, *tmp;
-    struct LDUser *  previousUser;
-    LDBoolean        shouldAlias;
+    struct LDClient *          clientIter, *tmp;
+    struct LDUser *            previousUser;
+    struct LDRequestTemplate **requests;
+    unsigned int               count, i;
+    LDBoolean                  shouldAlias;
 
     LD_ASSERT_API(client);
     LD_ASSERT_API(user);
@@ -403,15 +419,58 @@ LDClientIdentify(struct LDClient *const client, struct LDUser *const user)
 
     LDi_rwlock_wrlock(&globalContext.sharedUserLock);
 
+    /* every template is built before any client changes, so that a failure
+    leaves each environment requesting for the previous user rather than
+    one of them without requests */
+    count = HASH_COUNT(globalContext.clientTable);
+
+    if (!(requests = (struct LDRequestTemplate **)LDAlloc(
+              sizeof(struct LDRequestTemplate *) * (count ? count : 1))))
+    {
+        LD_LOG(LD_LOG_ERROR, "LDClientIdentify alloc error");
+
+        goto error;
+    }
+
+    i = 0;
+
+    HASH_ITER(hh, globalContext.clientTable, clientIter, tmp)
+    {
+        /* built before taking the client lock so requests are not blocked */
+        if (!(requests[i] = LDi_requestTemplateNew(
+                  globalContext.sharedConfig, clientIter->mobileKey, user)))
+        {
+            LD_LOG(LD_LOG_ERROR, "LDClientIdentify failed to build requests");
+
+            while (i) {
+                LDi_rc_decrement(&requests[--i]->rc);
+            }
+
+            LDFree(requests);
+
+            goto error;
+        }
+
+        i++;
+    }
+
     previousUser             = globalContext.sharedUser;
     globalContext.sharedUser = user;
     shouldAlias              = previousUser->anonymous && !user->anonymous &&
                   !globalContext.sharedConfig->autoAliasOptOut;
 
+    i = 0;
+
     HASH_ITER(hh, globalContext.clientTable, clientIter, tmp)
     {
         LDi_rwlock_wrlock(&clientIter->clientLock);
 
+        if (clientIter->requests) {
+            LDi_rc_decrement(&clientIter->requests->rc);
+        }
+
+        clientIter->requests = requests[i++];
+
         LDi_updatestatus(client, LDStatusInitializing);
 
         LDi_reinitializeconnection(clientIter);
@@ -424,50 +483,105 @@ LDClientIdentify(struct LDClient *const client, struct LDUser *const user)
         LDi_rwlock_wrunlock(&clientIter->clientLock);
     }
 
+    LDFree(requests);
+
     if (previousUser != user) {
         LDUserFree(previousUser);
     }
 
     LDi_rwlock_wrunlock(&globalContext.sharedUserLock);
+
+    return;
+
+error:
+    LDi_rwlock_wrunlock(&globalContext.sharedUserLock);
+
+    /* the client keeps the previous user, and owns the one passed */
+    if (user != globalContext.sharedUser) {
+        LDUserFree(user);
+    }
 }
 
 void
 clientCloseIsolated(struct LDClient *const client)
 {
+    LDBoolean failed;
+
     LD_ASSERT_API(client);
 
     LDi_rwlock_wrlock(&client->clientLock);
+    failed = LDi_atomicLoad(&client->status) == LDStatusFailed;
     LDi_updatestatus(client, LDStatusShuttingdown);
     LDi_reinitializeconnection(client);
     LDi_rwlock_wrunlock(&client->clientLock);
 
     LDi_mutex_lock(&client->condMtx);
     LDi_cond_signal(&client->initCond);
-    LDi_cond_signal(&client->eventCond);
-    LDi_cond_signal(&client->pollCond);
     LDi_cond_signal(&client->streamCond);
     LDi_mutex_unlock(&client->condMtx);
 
-    LDi_thread_join(&client->eventThread);
-    LDi_thread_join(&client->pollingThread);
-    LDi_thread_join(&client->streamingThread);
+    /* the streaming thread may apply a put until it is joined */
+    if (client->shared->sharedConfig->streaming) {
+        LDi_thread_join(&client->streamingThread);
+    }
+
+    LDi_cancelTimers(client);
+
+    if (!failed) {
+        LDi_flushEventsOnClose(client);
+    }
+
+    LDBufferFree(client->eventPayload);
 
     LDi_freeEventProcessor(client->eventProcessor);
     LDi_storeDestroy(&client->store);
 
+    if (client->requests) {
+        LDi_rc_decrement(&client->requests->rc);
+    }
+
     LDi_rwlock_destroy(&client->clientLock);
 
     LDi_mutex_destroy(&client->initCondMtx);
     LDi_mutex_destroy(&client->condMtx);
 
     LDi_cond_destroy(&client->initCond);
-    LDi_cond_destroy(&client->eventCond);
-    LDi_cond_destroy(&client->pollCond);
+    LDi_cond_destroy(&client->streamCond);
     LDFree(client->mobileKey);
+    LDFree(client->latency);
+
+    LDFree(client->evaluationHook);
+
+    while (client->retiredHooks) {
+        struct LDEvaluationHookRegistration *const retired =
+            client->retiredHooks;
+
+        client->retiredHooks = retired->retired;
+
+        LDFree(retired);
+    }
 
     LDFree(client);
 }
 
+struct LDRequestTemplate *
+LDi_clientRequestTemplate(struct LDClient *const client)
+{
+    struct LDRequestTemplate *requests;
+
+    LD_ASSERT(client);
+
+    LDi_rwlock_rdlock(&client->clientLock);
+
+    if ((requests = client->requests)) {
+        LDi_rc_increment(&requests->rc);
+    }
+
+    LDi_rwlock_rdunlock(&client->clientLock);
+
+    return requests;
+}
+
 void
 LDClientClose(struct LDClient *const client)
 {
@@ -480,6 +594,8 @@ LDClientClose(struct LDClient *const client)
             clientCloseIsolated(clientIter);
         }
 
+        LDi_timerWheelStop(&globalContext.timers);
+
         LDUserFree(globalContext.sharedUser);
         LDConfigFree(globalContext.sharedConfig);
 
@@ -492,8 +608,6 @@ LDClientClose(struct LDClient *const client)
 LDBoolean
 LDClientIsInitialized(struct LDClient *const client)
 {
-    LDBoolean isInit;
-
     LD_ASSERT_API(client);
 
 #ifdef LAUNCHDARKLY_DEFENSIVE
@@ -504,19 +618,13 @@ LDClientIsInitialized(struct LDClient *const client)
     }
 #endif
 
-    LDi_rwlock_rdlock(&client->clientLock);
-    isInit = client->status == LDStatusInitialized;
-    LDi_rwlock_rdunlock(&client->clientLock);
-
-    return isInit;
+    return LDi_atomicLoad(&client->status) == LDStatusInitialized;
 }
 
 LDBoolean
 LDClientAwaitInitialized(
     struct LDClient *const client, const unsigned int timeoutmilli)
 {
-    LDBoolean isInit;
-
     LD_ASSERT_API(client);
 
 #ifdef LAUNCHDARKLY_DEFENSIVE
@@ -528,25 +636,17 @@ LDClientAwaitInitialized(
 #endif
 
     LDi_mutex_lock(&client->initCondMtx);
-    LDi_rwlock_rdlock(&client->clientLock);
 
-    if (client->status == LDStatusInitialized) {
-        LDi_rwlock_rdunlock(&client->clientLock);
+    if (LDi_atomicLoad(&client->status) == LDStatusInitialized) {
         LDi_mutex_unlock(&client->initCondMtx);
 
         return LDBooleanTrue;
     }
 
-    LDi_rwlock_rdunlock(&client->clientLock);
-
     LDi_cond_wait(&client->initCond, &client->initCondMtx, timeoutmilli);
     LDi_mutex_unlock(&client->initCondMtx);
 
-    LDi_rwlock_rdlock(&client->clientLock);
-    isInit = client->status == LDStatusInitialized;
-    LDi_rwlock_rdunlock(&client->clientLock);
-
-    return isInit;
+    return LDi_atomicLoad(&client->status) == LDStatusInitialized;
 }
 
 void
@@ -558,8 +658,9 @@ LDSetClientStatusCallback(void(callback)(int))
 char *
 LDClientSaveFlags(struct LDClient *const client)
 {
-    struct LDJSON *bundle;
-    char *         serialized;
+    struct LDJSON *  bundle;
+    struct LDBuffer *buffer;
+    char *           serialized;
 
     LD_ASSERT_API(client);
 
@@ -567,12 +668,20 @@ LDClientSaveFlags(struct LDClient *const client)
         return NULL;
     }
 
-    if (!(serialized = LDJSONSerialize(bundle))) {
+    if (!(buffer = LDBufferNew())) {
         LDJSONFree(bundle);
 
         return NULL;
     }
 
+    serialized = NULL;
+
+    /* sized from an estimate up front instead of grown while printing */
+    if (LDJSONSerializeTo(bundle, buffer)) {
+        serialized = LDi_bufferDetach(buffer);
+    }
+
+    LDBufferFree(buffer);
     LDJSONFree(bundle);
 
     return serialized;
@@ -620,7 +729,7 @@ LDAllFlags(struct LDClient *const client)
     for (i = 0; i < flagCount; i++) {
         struct LDJSON *tmp;
 
-        if (!(tmp = LDJSONDuplicate(flags[i]->flag.value))) {
+        if (!(tmp = LDJSONDuplicate(LDi_flag_value(&flags[i]->flag)))) {
             goto error;
         }
 
@@ -673,8 +782,8 @@ fillDetails(
         LDObjectSetKey(
             details->reason, "errorKind", LDNewText("FLAG_NOT_SPECIFIED"));
     } else if (node) {
-        if (type == LDNull || LDJSONGetType(node->flag.value) == type ||
-            LDJSONGetType(node->flag.value) == LDNull)
+        if (type == LDNull || LDi_flag_value_type(&node->flag) == type ||
+            LDi_flag_value_type(&node->flag) == LDNull)
         {
             if (node->flag.reason) {
                 details->reason = LDJSONDuplicate(node->flag.reason);
@@ -701,13 +810,20 @@ fillDetails(
     }
 }
 
+/* switches on the requested kind, which the caller has checked matches the
+source, so that where the call is inlined for a known kind the compiler sees
+only the matching store */
 static void
-LDi_castJSONToValue(void **const destination, struct LDJSON *const source)
+LDi_castJSONToValue(
+    void **const        destination,
+    const LDJSONType    kind,
+    struct LDJSON *const source)
 {
     LD_ASSERT(destination);
     LD_ASSERT(source);
+    LD_ASSERT(LDJSONGetType(source) == kind);
 
-    switch (LDJSONGetType(source)) {
+    switch (kind) {
     case LDNull:
         LD_ASSERT(LDBooleanFalse);
         break;
@@ -734,6 +850,56 @@ LDi_castJSONToValue(void **const destination, struct LDJSON *const source)
     }
 }
 
+static enum LDLatencyKind
+LDi_latencyKind(const LDJSONType variationKind)
+{
+    switch (variationKind) {
+    case LDBool:
+        return LDLatencyBool;
+    case LDNumber:
+        return LDLatencyNumber;
+    case LDText:
+        return LDLatencyString;
+    default:
+        return LDLatencyJSON;
+    }
+}
+
+/* builds the data of an evaluation for a hook and calls it */
+static void
+LDi_callEvaluationHook(
+    const struct LDEvaluationHookRegistration *const registration,
+    const char *const                                flagKey,
+    const LDJSONType                                 variationKind,
+    const struct LDStoreNode *const                  matched,
+    const double                                     durationNanoseconds)
+{
+    struct LDEvaluationHookData data;
+
+    data.flagKey             = flagKey;
+    data.type                = variationKind;
+    data.durationNanoseconds = durationNanoseconds;
+
+    if (matched) {
+        struct LDJSON *kind;
+
+        data.variationIndex = matched->flag.variation;
+        data.reasonKind     = NULL;
+
+        if (matched->flag.reason &&
+            (kind = LDObjectLookup(matched->flag.reason, "kind")) &&
+            LDJSONGetType(kind) == LDText)
+        {
+            data.reasonKind = LDGetText(kind);
+        }
+    } else {
+        data.variationIndex = -1;
+        data.reasonKind     = "ERROR";
+    }
+
+    registration->hook(&data, registration->context);
+}
+
 static LDBoolean
 LDi_evalInternal(
     struct LDClient *const     client,
@@ -743,7 +909,10 @@ LDi_evalInternal(
     void **const               resultValue,
     struct LDStoreNode **const selected)
 {
-    struct LDStoreNode *node;
+    struct LDStoreNode *                       node;
+    const struct LDEvaluationHookRegistration *hook;
+    LDBoolean                                  sampled, matched;
+    double                                     started;
 
     LD_ASSERT_API(client);
     LD_ASSERT_API(flagKey);
@@ -772,17 +941,56 @@ LDi_evalInternal(
     }
 #endif
 
+    hook = (const struct LDEvaluationHookRegistration *)LDi_atomicLoadPointer(
+        &client->evaluationHook);
+
+    sampled = client->latency != NULL &&
+        LDi_latencySample(client->shared->sharedConfig->latencySampling);
+
+    if (sampled || hook) {
+        started = LDi_getMonotonicNanoseconds();
+    }
+
+    switch (variationKind) {
+    case LDBool:
+        LDi_atomicIncrement(&client->counters.boolEvaluations);
+        break;
+    case LDNumber:
+        LDi_atomicIncrement(&client->counters.numberEvaluations);
+        break;
+    case LDText:
+        LDi_atomicIncrement(&client->counters.stringEvaluations);
+        break;
+    default:
+        LDi_atomicIncrement(&client->counters.jsonEvaluations);
+        break;
+    }
+
     node = LDi_storeGet(&client->store, flagKey);
 
-    if (node && (variationKind == LDNull ||
-                 LDJSONGetType(node->flag.value) == variationKind))
-    {
+    if (!node) {
+        LDi_atomicIncrement(&client->counters.flagNotFound);
+    }
+
+    matched = node && (variationKind == LDNull ||
+                       LDi_flag_value_type(&node->flag) == variationKind);
+
+    if (matched) {
         if (variationKind == LDNull) {
-            *((struct LDJSON * *const) resultValue) = node->flag.value;
+            if (!(*((struct LDJSON * *const) resultValue) =
+                      LDi_flag_value(&node->flag)))
+            {
+                *resultValue = fallbackValue;
+            }
         } else {
-            LDi_castJSONToValue(resultValue, node->flag.value);
+            LDi_castJSONToValue(
+                resultValue, variationKind, node->flag.value);
         }
     } else {
+        if (node) {
+            LDi_atomicIncrement(&client->counters.wrongType);
+        }
+
         *resultValue = fallbackValue;
     }
 
@@ -800,6 +1008,21 @@ LDi_evalInternal(
 
     LDi_rwlock_rdunlock(&client->shared->sharedUserLock);
 
+    if (sampled || hook) {
+        const double duration = LDi_getMonotonicNanoseconds() - started;
+
+        if (sampled) {
+            LDi_latencyRecord(
+                &client->latency[LDi_latencyKind(variationKind)],
+                (unsigned long)duration);
+        }
+
+        if (hook) {
+            LDi_callEvaluationHook(
+                hook, flagKey, variationKind, matched ? node : NULL, duration);
+        }
+    }
+
     if (selected) {
         *selected = node;
     } else if (node) {
@@ -1251,7 +1474,7 @@ LDClientFlush(struct LDClient *const client)
 
     HASH_ITER(hh, globalContext.clientTable, clientIter, tmp)
     {
-        LDi_cond_signal(&clientIter->eventCond);
+        LDi_timerStart(&globalContext.timers, &clientIter->flushTimer, 0);
     }
 }
 
@@ -1325,11 +1548,154 @@ LDClientUnregisterFeatureFlagListener(
     LDi_storeUnregisterListener(&client->store, key, fn);
 }
 
+LDBoolean
+LDClientGetStats(
+    struct LDClient *const client, struct LDClientStats *const stats)
+{
+    struct LDClientCounters *counters;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(stats);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientGetStats NULL client");
+
+        return LDBooleanFalse;
+    }
+
+    if (stats == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientGetStats NULL stats");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    counters = &client->counters;
+
+    stats->boolEvaluations   = LDi_atomicLoad(&counters->boolEvaluations);
+    stats->numberEvaluations = LDi_atomicLoad(&counters->numberEvaluations);
+    stats->stringEvaluations = LDi_atomicLoad(&counters->stringEvaluations);
+    stats->jsonEvaluations   = LDi_atomicLoad(&counters->jsonEvaluations);
+    stats->flagNotFound      = LDi_atomicLoad(&counters->flagNotFound);
+    stats->wrongType         = LDi_atomicLoad(&counters->wrongType);
+    stats->eventsFlushed     = LDi_atomicLoad(&counters->eventsFlushed);
+    stats->flushes           = LDi_atomicLoad(&counters->flushes);
+    stats->lastFlushMilliseconds =
+        LDi_atomicLoad(&counters->lastFlushMilliseconds);
+    stats->bytesSent        = LDi_atomicLoad(&counters->bytesSent);
+    stats->bytesReceived    = LDi_atomicLoad(&counters->bytesReceived);
+    stats->streamReconnects = LDi_atomicLoad(&counters->streamReconnects);
+    stats->lastStreamBackoffMilliseconds =
+        LDi_atomicLoad(&counters->lastStreamBackoffMilliseconds);
+
+    LDi_eventProcessorStats(client->eventProcessor, stats);
+    LDi_storeStats(
+        &client->store, &stats->storeSize, &stats->storeGeneration);
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDClientGetEvaluationLatency(
+    struct LDClient *const client, struct LDEvaluationLatency *const latency)
+{
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(latency);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientGetEvaluationLatency NULL client");
+
+        return LDBooleanFalse;
+    }
+
+    if (latency == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientGetEvaluationLatency NULL latency");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    if (!client->latency) {
+        return LDBooleanFalse;
+    }
+
+    LDi_latencySnapshot(
+        &client->latency[LDLatencyBool], &latency->boolVariations);
+    LDi_latencySnapshot(
+        &client->latency[LDLatencyNumber], &latency->numberVariations);
+    LDi_latencySnapshot(
+        &client->latency[LDLatencyString], &latency->stringVariations);
+    LDi_latencySnapshot(
+        &client->latency[LDLatencyJSON], &latency->jsonVariations);
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDClientSetEvaluationHook(
+    struct LDClient *const client,
+    const LDEvaluationHook hook,
+    void *const            context)
+{
+    struct LDEvaluationHookRegistration *registration, *replaced;
+
+    LD_ASSERT_API(client);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientSetEvaluationHook NULL client");
+
+        return LDBooleanFalse;
+    }
+#endif
+
+    registration = NULL;
+
+    if (hook) {
+        if (!(registration = (struct LDEvaluationHookRegistration *)LDAlloc(
+                  sizeof(*registration))))
+        {
+            LD_LOG(LD_LOG_ERROR, "LDClientSetEvaluationHook alloc error");
+
+            return LDBooleanFalse;
+        }
+
+        registration->hook    = hook;
+        registration->context = context;
+        registration->retired = NULL;
+    }
+
+    do {
+        replaced = (struct LDEvaluationHookRegistration *)LDi_atomicLoadPointer(
+            &client->evaluationHook);
+    } while (!LDi_atomicCompareExchangePointer(
+        &client->evaluationHook, replaced, registration));
+
+    /* evaluations that loaded the replaced hook may still call it */
+    if (replaced) {
+        do {
+            replaced->retired =
+                (struct LDEvaluationHookRegistration *)LDi_atomicLoadPointer(
+                    &client->retiredHooks);
+        } while (!LDi_atomicCompareExchangePointer(
+            &client->retiredHooks, replaced->retired, replaced));
+    }
+
+    return LDBooleanTrue;
+}
+
 void
 LDi_updatestatus(struct LDClient *const client, const LDStatus status)
 {
-    if (client->status != status) {
-        client->status = status;
+    const long current = LDi_atomicLoad(&client->status);
+
+    /* once closing, a put or failure reported by a background thread must
+    not revive the client, or its timers, while it is freed */
+    if (current != (long)status && current != LDStatusShuttingdown) {
+        LDi_atomicStore(&client->status, status);
+        LDi_clientStateChanged(client);
         if (LDi_statuscallback) {
             LDi_rwlock_wrunlock(&client->clientLock);
             LDi_statuscallback(status);
@@ -2,11 +2,17 @@
 
 #include "uthash.h"
 
+#include "atomic.h"
 #include "config.h"
+#include "latency.h"
 #include "store.h"
+#include "timer.h"
 #include "user.h"
+#include "utility.h"
 #include "socket.h"
 
+struct LDRequestTemplate;
+
 struct LDGlobal_i
 {
     struct LDClient *clientTable;
@@ -14,6 +20,37 @@ struct LDGlobal_i
     struct LDConfig *sharedConfig;
     struct LDUser *  sharedUser;
     ld_rwlock_t      sharedUserLock;
+    /* polls and event deliveries of every environment */
+    struct LDTimerWheel timers;
+};
+
+/* counters behind LDClientGetStats that are not kept by the event processor
+or store, updated atomically so evaluating threads never wait on each other */
+struct LDClientCounters
+{
+    ld_atomic_t boolEvaluations;
+    ld_atomic_t numberEvaluations;
+    ld_atomic_t stringEvaluations;
+    ld_atomic_t jsonEvaluations;
+    ld_atomic_t flagNotFound;
+    ld_atomic_t wrongType;
+    ld_atomic_t eventsFlushed;
+    ld_atomic_t flushes;
+    ld_atomic_t lastFlushMilliseconds;
+    ld_atomic_t bytesSent;
+    ld_atomic_t bytesReceived;
+    ld_atomic_t streamReconnects;
+    ld_atomic_t lastStreamBackoffMilliseconds;
+};
+
+/* a hook set with LDClientSetEvaluationHook, hook and context never change
+once published */
+struct LDEvaluationHookRegistration
+{
+    LDEvaluationHook                     hook;
+    void *                               context;
+    /* replaced registrations, which evaluations may still be reading */
+    struct LDEvaluationHookRegistration *retired;
 };
 
 struct LDClient
@@ -21,22 +58,44 @@ struct LDClient
     struct LDGlobal_i *    shared;
     char *                 mobileKey;
     ld_rwlock_t            clientLock;
-    LDBoolean              offline;
-    LDBoolean              background;
-    LDStatus               status;
-    ld_thread_t            eventThread;
-    ld_thread_t            pollingThread;
+    /* written under clientLock, read atomically so the background threads
+    and status queries do not take it */
+    ld_atomic_t            offline;
+    ld_atomic_t            background;
+    ld_atomic_t            status;
+    /* incremented under condMtx whenever offline, background, status or the
+    connection changes, so the streaming thread can sleep until there is work
+    for it */
+    ld_atomic_t            stateGeneration;
+    /* only started when streaming is configured */
     ld_thread_t            streamingThread;
-    ld_cond_t              eventCond;
-    ld_cond_t              pollCond;
     ld_cond_t              streamCond;
     ld_mutex_t             condMtx;
     LDBoolean              shouldstopstreaming;
     struct ld_socket_state streamhandle;
     struct EventProcessor *eventProcessor;
     struct LDStore         store;
+    /* protected by clientLock, replaced on identify */
+    struct LDRequestTemplate *requests;
     ld_cond_t              initCond;
     ld_mutex_t             initCondMtx;
+    /* run on the timers of shared */
+    struct LDTimer         pollTimer;
+    struct LDTimer         flushTimer;
+    /* only touched by the flush timer and close, kept across flushes so that
+    steady state flushing does not allocate */
+    struct LDBuffer *      eventPayload;
+    char                   eventPayloadId[LD_UUID_SIZE + 1];
+    unsigned int           eventPayloadCount;
+    /* the payload failed once and is retried before new events are sent */
+    LDBoolean              eventPayloadRetry;
+    struct LDClientCounters counters;
+    /* indexed by LDLatencyKind, NULL unless sampling is configured */
+    struct LDLatencyHistogram *latency;
+    /* accessed atomically, NULL without a hook */
+    struct LDEvaluationHookRegistration *evaluationHook;
+    /* freed on close, pushed atomically */
+    struct LDEvaluationHookRegistration *retiredHooks;
     UT_hash_handle         hh;
 };
 
@@ -46,3 +105,8 @@ LDi_clientInitIsolated(
 
 void
 clientCloseIsolated(struct LDClient *const client);
+
+/* returns a reference the caller must release, NULL if the template could not
+be built */
+struct LDRequestTemplate *
+LDi_clientRequestTemplate(struct LDClient *const client);
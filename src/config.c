@@ -47,6 +47,8 @@ LDConfigNew(const char *const mobileKey)
     config->streamURI                       = NULL;
     config->secondaryMobileKeys             = NULL;
     config->autoAliasOptOut                 = 0;
+    config->patchCoalescingMicros           = 0;
+    config->latencySampling                 = 0;
 
     if (!LDSetString(&config->appURI, "https://app.launchdarkly.com")) {
         goto error;
@@ -187,6 +189,44 @@ LDConfigSetRequestTimeoutMillis(
     config->requestTimeoutMillis = millis;
 }
 
+void
+LDConfigSetStreamPatchCoalescingMicros(
+    struct LDConfig *const config, const unsigned int micros)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(
+            LD_LOG_WARNING,
+            "LDConfigSetStreamPatchCoalescingMicros NULL config");
+
+        return;
+    }
+#endif
+
+    config->patchCoalescingMicros = micros;
+}
+
+void
+LDConfigSetEvaluationLatencySampling(
+    struct LDConfig *const config, const unsigned int interval)
+{
+    LD_ASSERT_API(config);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (config == NULL) {
+        LD_LOG(
+            LD_LOG_WARNING,
+            "LDConfigSetEvaluationLatencySampling NULL config");
+
+        return;
+    }
+#endif
+
+    config->latencySampling = interval;
+}
+
 void
 LDConfigSetDisableBackgroundUpdating(
     struct LDConfig *const config, const LDBoolean disable)
@@ -26,6 +26,8 @@ struct LDConfig
     char *       certFile;
     LDBoolean    inlineUsersInEvents;
     LDBoolean    autoAliasOptOut;
+    unsigned int patchCoalescingMicros;
+    unsigned int latencySampling;
     /* map of name -> key */
     struct LDJSON *secondaryMobileKeys;
     /* array of strings */
@@ -3,6 +3,7 @@
 
 #include "event_processor.h"
 #include "event_processor_internal.h"
+#include "json_internal.h"
 #include "ldinternal.h"
 #include "utility.h"
 
@@ -31,9 +32,12 @@ LDi_newEventProcessor(const struct LDConfig *const config)
     context->lastUserKeyFlush = 0;
     context->lastServerTime   = 0;
     context->config           = config;
+    context->queued           = 0;
+    context->dropped          = 0;
 
     LDi_getMonotonicMilliseconds(&context->lastUserKeyFlush);
     LDi_mutex_init(&context->lock);
+    LDi_lockProfileLabel(&context->lock, "events");
 
     if (!(context->events = LDNewArray())) {
         goto error;
@@ -74,8 +78,14 @@ LDi_addEvent(struct EventProcessor *const context, struct LDJSON *const event)
     if (LDCollectionGetSize(context->events) >= context->config->eventsCapacity)
     {
         LD_LOG(LD_LOG_WARNING, "event capacity exceeded, dropping event");
+
+        LDJSONFree(event);
+
+        LDi_atomicIncrement(&context->dropped);
     } else {
         LDArrayPush(context->events, event);
+
+        LDi_atomicIncrement(&context->queued);
     }
 }
 
@@ -632,6 +642,17 @@ error:
     return NULL;
 }
 
+void
+LDi_eventProcessorStats(
+    struct EventProcessor *const context, struct LDClientStats *const stats)
+{
+    LD_ASSERT(context);
+    LD_ASSERT(stats);
+
+    stats->eventsQueued  = LDi_atomicLoad(&context->queued);
+    stats->eventsDropped = LDi_atomicLoad(&context->dropped);
+}
+
 LDBoolean
 LDi_bundleEventPayload(
     struct EventProcessor *const context, struct LDJSON **const result)
@@ -717,7 +738,7 @@ LDi_valueToJSON(const void *const value, const LDJSONType valueType)
 
     switch (valueType) {
     case LDNull:
-        tmp = LDJSONDuplicate((struct LDJSON *)value);
+        tmp = LDi_JSONShare((const struct LDJSON *)value);
         break;
     case LDBool:
         tmp = LDNewBool(*(LDBoolean *)value);
@@ -839,7 +860,7 @@ LDi_newFeatureRequestEvent(
          **/
 
         if (node->flag.reason && (detailed || node->flag.trackReason)) {
-            if (!(tmp = LDJSONDuplicate(node->flag.reason))) {
+            if (!(tmp = LDi_JSONShare(node->flag.reason))) {
                 return NULL;
             }
 
@@ -1071,11 +1092,14 @@ LDi_summarizeEvent(
             goto cleanup;
         }
     } else {
-        LDBoolean status;
         tmp = LDObjectLookup(entry, "count");
         LD_ASSERT(tmp);
-        status = LDSetNumber(tmp, LDGetNumber(tmp) + 1);
-        LD_ASSERT(status);
+
+        if (!LDSetNumber(tmp, LDGetNumber(tmp) + 1)) {
+            LD_LOG(LD_LOG_ERROR, "failed to update count");
+
+            goto cleanup;
+        }
     }
 
     success = LDBooleanTrue;
@@ -1140,9 +1164,9 @@ LDi_processEvalEvent(
     if (!LDi_summarizeEvent(
             context, flagKey, node, valueType, fallback, actualValue))
     {
-        LDi_addEvent(context, featureEvent);
-
-        LDJSONFree(featureEvent);
+        if (featureEvent) {
+            LDi_addEvent(context, featureEvent);
+        }
 
         LDi_mutex_unlock(&context->lock);
 
@@ -32,6 +32,11 @@ LDi_alias(
     const struct LDUser *const   currentUser,
     const struct LDUser *const   previousUser);
 
+/* fills the event queue totals of stats without taking the lock */
+void
+LDi_eventProcessorStats(
+    struct EventProcessor *const context, struct LDClientStats *const stats);
+
 LDBoolean
 LDi_bundleEventPayload(
     struct EventProcessor *const context, struct LDJSON **const result);
@@ -4,6 +4,7 @@
 
 #include <launchdarkly/json.h>
 
+#include "atomic.h"
 #include "concurrency.h"
 #include "event_processor.h"
 
@@ -16,8 +17,12 @@ struct EventProcessor
     double                 lastUserKeyFlush;
     double                 lastServerTime;
     const struct LDConfig *config;
+    /* totals for LDClientGetStats, written under lock and read without it */
+    ld_atomic_t            queued;
+    ld_atomic_t            dropped;
 };
 
+/* takes ownership of event, which is freed if the queue is full */
 void
 LDi_addEvent(struct EventProcessor *const context, struct LDJSON *const event);
 
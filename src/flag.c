@@ -1,7 +1,9 @@
 #include <launchdarkly/memory.h>
 
 #include "assertion.h"
+#include "atomic.h"
 #include "flag.h"
+#include "json_internal.h"
 
 LDBoolean
 LDi_flag_parse(
@@ -16,6 +18,7 @@ LDi_flag_parse(
 
     result->key         = NULL;
     result->value       = NULL;
+    result->valueText   = NULL;
     result->reason      = NULL;
     result->deleted     = LDBooleanFalse;
     result->version     = -1;
@@ -187,6 +190,33 @@ error:
     return LDBooleanFalse;
 }
 
+LDBoolean
+LDi_flag_tombstone(
+    struct LDFlag *const result,
+    const char *const    key,
+    const unsigned int   version)
+{
+    LD_ASSERT(result);
+    LD_ASSERT(key);
+
+    if (!(result->key = LDStrDup(key))) {
+        return LDBooleanFalse;
+    }
+
+    result->value                = NULL;
+    result->valueText            = NULL;
+    result->version              = version;
+    result->flagVersion          = -1;
+    result->variation            = 0;
+    result->trackEvents          = LDBooleanFalse;
+    result->trackReason          = LDBooleanFalse;
+    result->reason               = NULL;
+    result->debugEventsUntilDate = 0;
+    result->deleted              = LDBooleanTrue;
+
+    return LDBooleanTrue;
+}
+
 struct LDJSON *
 LDi_flag_to_json(struct LDFlag *const flag)
 {
@@ -210,7 +240,15 @@ LDi_flag_to_json(struct LDFlag *const flag)
     }
     tmp = NULL;
 
-    if (!(tmp = LDJSONDuplicate(flag->value))) {
+    /* a value not yet parsed is only parsed for this copy, so that saving
+    flags does not keep every value parsed */
+    if (LDi_atomicLoadPointer(&flag->value) || !flag->valueText) {
+        tmp = LDi_JSONShare(flag->value);
+    } else {
+        tmp = LDJSONDeserialize(flag->valueText);
+    }
+
+    if (!tmp) {
         goto error;
     }
 
@@ -273,7 +311,7 @@ LDi_flag_to_json(struct LDFlag *const flag)
     }
 
     if (flag->reason) {
-        if (!(tmp = LDJSONDuplicate(flag->reason))) {
+        if (!(tmp = LDi_JSONShare(flag->reason))) {
             goto error;
         }
 
@@ -314,11 +352,55 @@ error:
     return NULL;
 }
 
+struct LDJSON *
+LDi_flag_value(struct LDFlag *const flag)
+{
+    struct LDJSON *value, *parsed;
+
+    LD_ASSERT(flag);
+
+    if ((value = LDi_atomicLoadPointer(&flag->value)) || !flag->valueText) {
+        return value;
+    }
+
+    if (!(parsed = LDJSONDeserialize(flag->valueText))) {
+        LD_LOG(LD_LOG_ERROR, "LDi_flag_value failed to parse value");
+
+        return NULL;
+    }
+
+    /* evaluations duplicate the value constantly, share it instead */
+    LDJSONFreeze(parsed);
+
+    /* another caller may have parsed it concurrently, only one is kept */
+    if (LDi_atomicCompareExchangePointer(&flag->value, NULL, parsed)) {
+        return parsed;
+    }
+
+    LDJSONFree(parsed);
+
+    return LDi_atomicLoadPointer(&flag->value);
+}
+
+LDJSONType
+LDi_flag_value_type(const struct LDFlag *const flag)
+{
+    LD_ASSERT(flag);
+
+    /* only containers are deferred */
+    if (flag->valueText) {
+        return flag->valueText[0] == '{' ? LDObject : LDArray;
+    }
+
+    return LDJSONGetType(flag->value);
+}
+
 void
 LDi_flag_destroy(struct LDFlag *const flag)
 {
     if (flag) {
         LDFree(flag->key);
+        LDFree(flag->valueText);
         LDJSONFree(flag->value);
         LDJSONFree(flag->reason);
     }
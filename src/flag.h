@@ -6,7 +6,10 @@
 struct LDFlag
 {
     char *         key;
+    /* Use LDi_flag_value. Object and array values from a payload are kept as
+    their JSON text until first used, as most flags never are. */
     struct LDJSON *value;
+    char *         valueText;
     int            version;
     int            flagVersion;
     int            variation;
@@ -23,8 +26,25 @@ LDi_flag_parse(
     const char *const          key,
     const struct LDJSON *const raw);
 
+/* the placeholder stored in place of a deleted flag */
+LDBoolean
+LDi_flag_tombstone(
+    struct LDFlag *const result,
+    const char *const    key,
+    const unsigned int   version);
+
 struct LDJSON *
 LDi_flag_to_json(struct LDFlag *const flag);
 
+/* Returns the value of the flag, parsing it from its text on first use. The
+result is owned by the flag, frozen, and shared by concurrent callers. Returns
+NULL if the value could not be parsed. */
+struct LDJSON *
+LDi_flag_value(struct LDFlag *const flag);
+
+/* the type of the value of the flag without parsing it */
+LDJSONType
+LDi_flag_value_type(const struct LDFlag *const flag);
+
 void
 LDi_flag_destroy(struct LDFlag *const flag);
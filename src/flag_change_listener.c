@@ -1,12 +1,13 @@
 #include "flag_change_listener.h"
+#include "flag_key.h"
 #include "utlist.h"
 #include <launchdarkly/memory.h>
 
 #include <string.h>
 
 struct ChangeListener {
-    /* Owned flag key; must be freed. */
-    char *flag;
+    /* Interned flag key holding a reference; must be released. */
+    const char *flag;
     /* User-provided callback. */
     LDlistenerfn callback;
     /* Used by utlist.h macros. */
@@ -18,24 +19,21 @@ newListener(const char* flag, LDlistenerfn callback) {
     struct ChangeListener *listener = NULL;
 
     if (!(listener = LDAlloc(sizeof(struct ChangeListener)))) {
-        return LDBooleanFalse;
+        return NULL;
     }
 
+    LDi_flagKeyRetain(flag);
+
     listener->callback = callback;
-    listener->flag = NULL;
+    listener->flag = flag;
     listener->next = NULL;
 
-    if (!(listener->flag = LDStrDup(flag))) {
-        LDFree(listener);
-        return NULL;
-    }
-
     return listener;
 }
 
 static void
 freeListener(struct ChangeListener *listener) {
-    LDFree(listener->flag);
+    LDi_flagKeyRelease(listener->flag);
     LDFree(listener);
 }
 
@@ -132,7 +130,8 @@ LDi_listenersDispatch(struct ChangeListener* listeners, const char *flag, LDBool
     listener = NULL;
 
     LL_FOREACH_SAFE(listeners, listener, tmp) {
-        if (strcmp(listener->flag, flag) == 0) {
+        /* keys from the same table are equal only if they are the same atom */
+        if (listener->flag == flag) {
             listener->callback(flag, status);
         }
     }
@@ -9,6 +9,8 @@
  * The ChangeListener struct should be stored as a pointer, and initialized with LDi_initListeners.
  *
  * Only one callback can be registered for a given (flag, function pointer) pair; this is enforced at insertion time.
+ *
+ * Flag keys passed to LDi_listenerAdd and LDi_listenersDispatch must be atoms from the same LDFlagKeyTable.
  * */
 struct ChangeListener;
 
@@ -21,7 +23,7 @@ LDi_initListeners(struct ChangeListener** listeners);
 void
 LDi_freeListeners(struct ChangeListener** listeners);
 
-/* Insert a new listener.
+/* Insert a new listener, which takes its own reference to the flag key.
  * If the combination of (flag, function pointer) already exists, no new listener is created.
  * If allocation fails, returns false. */
 LDBoolean
@@ -0,0 +1,633 @@
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "flag_decoder.h"
+
+enum
+{
+    LD_FLAG_FIELD_UNKNOWN,
+    LD_FLAG_FIELD_KEY,
+    LD_FLAG_FIELD_VALUE,
+    LD_FLAG_FIELD_VERSION,
+    LD_FLAG_FIELD_FLAG_VERSION,
+    LD_FLAG_FIELD_VARIATION,
+    LD_FLAG_FIELD_TRACK_EVENTS,
+    LD_FLAG_FIELD_TRACK_REASON,
+    LD_FLAG_FIELD_REASON,
+    LD_FLAG_FIELD_DEBUG_EVENTS_UNTIL_DATE,
+    LD_FLAG_FIELD_DELETED
+};
+
+/* field names are told apart by length and one distinguishing byte, so
+each name is compared at most once */
+static int
+LDi_flagField(const char *const name, const size_t nameSize)
+{
+    const char *expected;
+    int         field;
+
+    switch (nameSize) {
+    case 3:
+        expected = "key";
+        field    = LD_FLAG_FIELD_KEY;
+        break;
+    case 5:
+        expected = "value";
+        field    = LD_FLAG_FIELD_VALUE;
+        break;
+    case 6:
+        expected = "reason";
+        field    = LD_FLAG_FIELD_REASON;
+        break;
+    case 7:
+        if (name[0] == 'v') {
+            expected = "version";
+            field    = LD_FLAG_FIELD_VERSION;
+        } else {
+            expected = "deleted";
+            field    = LD_FLAG_FIELD_DELETED;
+        }
+        break;
+    case 9:
+        expected = "variation";
+        field    = LD_FLAG_FIELD_VARIATION;
+        break;
+    case 11:
+        switch (name[5]) {
+        case 'E':
+            expected = "trackEvents";
+            field    = LD_FLAG_FIELD_TRACK_EVENTS;
+            break;
+        case 'R':
+            expected = "trackReason";
+            field    = LD_FLAG_FIELD_TRACK_REASON;
+            break;
+        default:
+            expected = "flagVersion";
+            field    = LD_FLAG_FIELD_FLAG_VERSION;
+            break;
+        }
+        break;
+    case 20:
+        expected = "debugEventsUntilDate";
+        field    = LD_FLAG_FIELD_DEBUG_EVENTS_UNTIL_DATE;
+        break;
+    default:
+        return LD_FLAG_FIELD_UNKNOWN;
+    }
+
+    if (memcmp(name, expected, nameSize) != 0) {
+        return LD_FLAG_FIELD_UNKNOWN;
+    }
+
+    return field;
+}
+
+static void
+LDi_flagDecoderResetFlag(struct LDFlagDecoder *const decoder)
+{
+    decoder->flag.key                  = NULL;
+    decoder->flag.value                = NULL;
+    decoder->flag.valueText            = NULL;
+    decoder->flag.version              = -1;
+    decoder->flag.flagVersion          = -1;
+    decoder->flag.variation            = -1;
+    decoder->flag.trackEvents          = LDBooleanFalse;
+    decoder->flag.trackReason          = LDBooleanFalse;
+    decoder->flag.reason               = NULL;
+    decoder->flag.debugEventsUntilDate = 0;
+    decoder->flag.deleted              = LDBooleanFalse;
+
+    decoder->hasValue     = LDBooleanFalse;
+    decoder->hasVariation = LDBooleanFalse;
+    decoder->field        = LD_FLAG_FIELD_UNKNOWN;
+    decoder->capturing    = LDBooleanFalse;
+}
+
+static LDBoolean
+LDi_flagDecoderToken(
+    const enum LDJSONStreamToken token,
+    const char *const            text,
+    const size_t                 textSize,
+    const double                 number,
+    void *const                  context);
+
+void
+LDi_flagDecoderInitialize(struct LDFlagDecoder *const decoder)
+{
+    LD_ASSERT(decoder);
+
+    LDJSONStreamParserInitialize(
+        &decoder->parser, LDi_flagDecoderToken, decoder);
+
+    decoder->single            = LDBooleanFalse;
+    decoder->flags             = NULL;
+    decoder->flagCount         = 0;
+    decoder->flagCapacity      = 0;
+    decoder->depth             = 0;
+    decoder->skipDepth         = 0;
+    decoder->containers        = NULL;
+    decoder->containerCount    = 0;
+    decoder->containerCapacity = 0;
+    decoder->pendingKey        = NULL;
+
+    LDi_flagDecoderResetFlag(decoder);
+}
+
+void
+LDi_flagDecoderDestroy(struct LDFlagDecoder *const decoder)
+{
+    if (decoder) {
+        unsigned int i;
+
+        for (i = 0; i < decoder->flagCount; i++) {
+            LDi_flag_destroy(&decoder->flags[i]);
+        }
+
+        LDi_flag_destroy(&decoder->flag);
+        LDJSONStreamParserDestroy(&decoder->parser);
+        LDFree(decoder->flags);
+        LDFree(decoder->containers);
+        LDFree(decoder->pendingKey);
+
+        decoder->flags      = NULL;
+        decoder->flagCount  = 0;
+        decoder->containers = NULL;
+        decoder->pendingKey = NULL;
+
+        LDi_flagDecoderResetFlag(decoder);
+    }
+}
+
+static struct LDJSON *
+LDi_newScalar(
+    const enum LDJSONStreamToken token,
+    const char *const            text,
+    const double                 number)
+{
+    switch (token) {
+    case LDJSONStreamText:
+        return LDNewText(text);
+    case LDJSONStreamNumber:
+        return LDNewNumber(number);
+    case LDJSONStreamTrue:
+        return LDNewBool(LDBooleanTrue);
+    case LDJSONStreamFalse:
+        return LDNewBool(LDBooleanFalse);
+    case LDJSONStreamNull:
+        return LDNewNull();
+    default:
+        return NULL;
+    }
+}
+
+static LDBoolean
+LDi_pushContainer(
+    struct LDFlagDecoder *const decoder, struct LDJSON *const container)
+{
+    if (decoder->containerCount == decoder->containerCapacity) {
+        struct LDJSON **containersTmp;
+        size_t          capacity;
+
+        capacity = decoder->containerCapacity ? decoder->containerCapacity * 2
+                                              : 8;
+
+        if (!(containersTmp = (struct LDJSON **)LDRealloc(
+                  decoder->containers, sizeof(struct LDJSON *) * capacity)))
+        {
+            return LDBooleanFalse;
+        }
+
+        decoder->containers        = containersTmp;
+        decoder->containerCapacity = capacity;
+    }
+
+    decoder->containers[decoder->containerCount++] = container;
+
+    return LDBooleanTrue;
+}
+
+/* handles a token inside of a value or reason tree */
+static LDBoolean
+LDi_treeToken(
+    struct LDFlagDecoder *const  decoder,
+    const enum LDJSONStreamToken token,
+    const char *const            text,
+    const double                 number)
+{
+    struct LDJSON *parent, *item;
+
+    parent = decoder->containers[decoder->containerCount - 1];
+
+    switch (token) {
+    case LDJSONStreamKey:
+        LDFree(decoder->pendingKey);
+
+        return (decoder->pendingKey = LDStrDup(text)) != NULL;
+    case LDJSONStreamObjectEnd:
+    case LDJSONStreamArrayEnd:
+        decoder->containerCount--;
+
+        return LDBooleanTrue;
+    case LDJSONStreamObjectStart:
+        item = LDNewObject();
+        break;
+    case LDJSONStreamArrayStart:
+        item = LDNewArray();
+        break;
+    default:
+        item = LDi_newScalar(token, text, number);
+        break;
+    }
+
+    if (!item) {
+        return LDBooleanFalse;
+    }
+
+    if (LDJSONGetType(parent) == LDObject) {
+        LD_ASSERT(decoder->pendingKey);
+
+        if (!LDObjectSetKey(parent, decoder->pendingKey, item)) {
+            LDJSONFree(item);
+
+            return LDBooleanFalse;
+        }
+    } else {
+        if (!LDArrayPush(parent, item)) {
+            LDJSONFree(item);
+
+            return LDBooleanFalse;
+        }
+    }
+
+    if (token == LDJSONStreamObjectStart || token == LDJSONStreamArrayStart) {
+        return LDi_pushContainer(decoder, item);
+    }
+
+    return LDBooleanTrue;
+}
+
+/* begins building a value or reason, the result is owned by the flag */
+static LDBoolean
+LDi_startTree(
+    struct LDFlagDecoder *const  decoder,
+    struct LDJSON **const        target,
+    const enum LDJSONStreamToken token,
+    const char *const            text,
+    const double                 number)
+{
+    struct LDJSON *item;
+
+    if (token == LDJSONStreamObjectStart) {
+        item = LDNewObject();
+    } else if (token == LDJSONStreamArrayStart) {
+        item = LDNewArray();
+    } else {
+        item = LDi_newScalar(token, text, number);
+    }
+
+    if (!item) {
+        return LDBooleanFalse;
+    }
+
+    LDJSONFree(*target);
+
+    *target = item;
+
+    if (token == LDJSONStreamObjectStart || token == LDJSONStreamArrayStart) {
+        return LDi_pushContainer(decoder, item);
+    }
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_fieldToken(
+    struct LDFlagDecoder *const  decoder,
+    const enum LDJSONStreamToken token,
+    const char *const            text,
+    const double                 number)
+{
+    switch (decoder->field) {
+    case LD_FLAG_FIELD_KEY:
+        if (token != LDJSONStreamText) {
+            LD_LOG(LD_LOG_ERROR, "LDi_flag_parse key is not text");
+
+            return LDBooleanFalse;
+        }
+
+        LDFree(decoder->flag.key);
+
+        return (decoder->flag.key = LDStrDup(text)) != NULL;
+    case LD_FLAG_FIELD_VALUE:
+        decoder->hasValue = LDBooleanTrue;
+
+        LDFree(decoder->flag.valueText);
+        decoder->flag.valueText = NULL;
+
+        /* containers are kept as text until the flag is first evaluated,
+        their tokens are skipped while the parser collects the text */
+        if (token == LDJSONStreamObjectStart ||
+            token == LDJSONStreamArrayStart) {
+            LDJSONFree(decoder->flag.value);
+            decoder->flag.value = NULL;
+
+            LDJSONStreamParserBeginCapture(&decoder->parser);
+
+            decoder->capturing = LDBooleanTrue;
+            decoder->skipDepth = 1;
+
+            return LDBooleanTrue;
+        }
+
+        return LDi_startTree(
+            decoder, &decoder->flag.value, token, text, number);
+    case LD_FLAG_FIELD_REASON:
+        if (token != LDJSONStreamObjectStart) {
+            LD_LOG(LD_LOG_ERROR, "LDi_flag_parse reason is not an object");
+
+            return LDBooleanFalse;
+        }
+
+        return LDi_startTree(
+            decoder, &decoder->flag.reason, token, text, number);
+    case LD_FLAG_FIELD_VERSION:
+        if (token != LDJSONStreamNumber) {
+            LD_LOG(LD_LOG_ERROR, "LDi_flag_parse version is not a number");
+
+            return LDBooleanFalse;
+        }
+
+        decoder->flag.version = number;
+
+        return LDBooleanTrue;
+    case LD_FLAG_FIELD_FLAG_VERSION:
+        if (token != LDJSONStreamNumber) {
+            LD_LOG(LD_LOG_ERROR, "LDi_flag_parse flagVersion is not a number");
+
+            return LDBooleanFalse;
+        }
+
+        decoder->flag.flagVersion = number;
+
+        return LDBooleanTrue;
+    case LD_FLAG_FIELD_VARIATION:
+        if (token == LDJSONStreamNumber) {
+            decoder->flag.variation = number;
+        } else if (token == LDJSONStreamNull) {
+            decoder->flag.variation = -1;
+        } else {
+            LD_LOG(
+                LD_LOG_ERROR,
+                "LDi_flag_parse variation is not a number or null");
+
+            return LDBooleanFalse;
+        }
+
+        decoder->hasVariation = LDBooleanTrue;
+
+        return LDBooleanTrue;
+    case LD_FLAG_FIELD_DEBUG_EVENTS_UNTIL_DATE:
+        if (token != LDJSONStreamNumber) {
+            LD_LOG(
+                LD_LOG_ERROR,
+                "LDi_flag_parse debugEventsUntilDate not a number");
+
+            return LDBooleanFalse;
+        }
+
+        decoder->flag.debugEventsUntilDate = number;
+
+        return LDBooleanTrue;
+    case LD_FLAG_FIELD_TRACK_EVENTS:
+    case LD_FLAG_FIELD_TRACK_REASON:
+    case LD_FLAG_FIELD_DELETED:
+        if (token != LDJSONStreamTrue && token != LDJSONStreamFalse) {
+            LD_LOG(LD_LOG_ERROR, "LDi_flag_parse expected a boolean");
+
+            return LDBooleanFalse;
+        }
+
+        if (decoder->field == LD_FLAG_FIELD_TRACK_EVENTS) {
+            decoder->flag.trackEvents = token == LDJSONStreamTrue;
+        } else if (decoder->field == LD_FLAG_FIELD_TRACK_REASON) {
+            decoder->flag.trackReason = token == LDJSONStreamTrue;
+        } else {
+            decoder->flag.deleted = token == LDJSONStreamTrue;
+        }
+
+        return LDBooleanTrue;
+    default:
+        /* unknown fields are ignored, including any nested content */
+        if (token == LDJSONStreamObjectStart ||
+            token == LDJSONStreamArrayStart) {
+            decoder->skipDepth = 1;
+        }
+
+        return LDBooleanTrue;
+    }
+}
+
+static LDBoolean
+LDi_finishFlag(struct LDFlagDecoder *const decoder)
+{
+    if (!decoder->flag.key) {
+        LD_LOG(LD_LOG_ERROR, "LDi_flag_parse expected key");
+
+        return LDBooleanFalse;
+    }
+
+    if (!decoder->hasValue) {
+        LD_LOG(LD_LOG_ERROR, "LDi_flag_parse expected value");
+
+        return LDBooleanFalse;
+    }
+
+    if (!decoder->hasVariation) {
+        LD_LOG(LD_LOG_ERROR, "LDi_flag_parse expected variation");
+
+        return LDBooleanFalse;
+    }
+
+    if (decoder->flagCount == decoder->flagCapacity) {
+        struct LDFlag *flagsTmp;
+        unsigned int   capacity;
+
+        capacity = decoder->flagCapacity ? decoder->flagCapacity * 2 : 16;
+
+        if (!(flagsTmp = (struct LDFlag *)LDRealloc(
+                  decoder->flags, sizeof(struct LDFlag) * capacity)))
+        {
+            return LDBooleanFalse;
+        }
+
+        decoder->flags        = flagsTmp;
+        decoder->flagCapacity = capacity;
+    }
+
+    decoder->flags[decoder->flagCount++] = decoder->flag;
+
+    LDi_flagDecoderResetFlag(decoder);
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_flagDecoderToken(
+    const enum LDJSONStreamToken token,
+    const char *const            text,
+    const size_t                 textSize,
+    const double                 number,
+    void *const                  context)
+{
+    struct LDFlagDecoder *decoder;
+
+    LD_ASSERT(context);
+
+    decoder = (struct LDFlagDecoder *)context;
+
+    if (decoder->containerCount) {
+        return LDi_treeToken(decoder, token, text, number);
+    }
+
+    if (decoder->skipDepth) {
+        if (token == LDJSONStreamObjectStart ||
+            token == LDJSONStreamArrayStart) {
+            decoder->skipDepth++;
+        } else if (
+            token == LDJSONStreamObjectEnd || token == LDJSONStreamArrayEnd)
+        {
+            decoder->skipDepth--;
+        }
+
+        if (decoder->skipDepth == 0 && decoder->capturing) {
+            size_t size;
+
+            decoder->capturing = LDBooleanFalse;
+
+            return (decoder->flag.valueText = LDJSONStreamParserEndCapture(
+                        &decoder->parser, &size)) != NULL;
+        }
+
+        return LDBooleanTrue;
+    }
+
+    switch (decoder->depth) {
+    case 0:
+        if (token != LDJSONStreamObjectStart) {
+            LD_LOG(LD_LOG_ERROR, "flag payload is not an object");
+
+            return LDBooleanFalse;
+        }
+
+        decoder->depth = decoder->single ? 2 : 1;
+
+        return LDBooleanTrue;
+    case 1:
+        if (token == LDJSONStreamKey) {
+            LDFree(decoder->flag.key);
+
+            return (decoder->flag.key = LDStrDup(text)) != NULL;
+        } else if (token == LDJSONStreamObjectStart) {
+            decoder->depth = 2;
+
+            return LDBooleanTrue;
+        } else if (token == LDJSONStreamObjectEnd) {
+            decoder->depth = 0;
+
+            return LDBooleanTrue;
+        }
+
+        LD_LOG(LD_LOG_ERROR, "LDi_flag_parse not an object");
+
+        return LDBooleanFalse;
+    default:
+        if (token == LDJSONStreamKey) {
+            decoder->field = LDi_flagField(text, textSize);
+
+            /* in a put the key of a flag is the name of its field */
+            if (decoder->field == LD_FLAG_FIELD_KEY && !decoder->single) {
+                decoder->field = LD_FLAG_FIELD_UNKNOWN;
+            }
+
+            return LDBooleanTrue;
+        } else if (token == LDJSONStreamObjectEnd) {
+            decoder->depth = decoder->single ? 0 : 1;
+
+            return LDi_finishFlag(decoder);
+        }
+
+        return LDi_fieldToken(decoder, token, text, number);
+    }
+}
+
+LDBoolean
+LDi_flagDecoderProcess(
+    struct LDFlagDecoder *const decoder,
+    const char *const           data,
+    const size_t                dataSize)
+{
+    LD_ASSERT(decoder);
+
+    return LDJSONStreamParserProcess(&decoder->parser, data, dataSize);
+}
+
+LDBoolean
+LDi_flagDecoderFinish(
+    struct LDFlagDecoder *const decoder,
+    struct LDFlag **const       flags,
+    unsigned int *const         flagCount)
+{
+    LD_ASSERT(decoder);
+    LD_ASSERT(flags);
+    LD_ASSERT(flagCount);
+
+    if (!LDJSONStreamParserFinish(&decoder->parser)) {
+        return LDBooleanFalse;
+    }
+
+    *flags     = decoder->flags;
+    *flagCount = decoder->flagCount;
+
+    decoder->flags        = NULL;
+    decoder->flagCount    = 0;
+    decoder->flagCapacity = 0;
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDi_flagDecode(
+    struct LDFlag *const result,
+    const char *const    text,
+    const size_t         textSize)
+{
+    struct LDFlagDecoder decoder;
+    struct LDFlag *      flags;
+    unsigned int         flagCount;
+    LDBoolean            status;
+
+    LD_ASSERT(result);
+    LD_ASSERT(text);
+
+    LDi_flagDecoderInitialize(&decoder);
+    decoder.single = LDBooleanTrue;
+
+    status = LDi_flagDecoderProcess(&decoder, text, textSize) &&
+        LDi_flagDecoderFinish(&decoder, &flags, &flagCount);
+
+    if (status) {
+        /* the parser rejects anything after the flag object */
+        LD_ASSERT(flagCount == 1);
+
+        *result = flags[0];
+
+        LDFree(flags);
+    }
+
+    LDi_flagDecoderDestroy(&decoder);
+
+    return status;
+}
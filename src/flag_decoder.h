@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+#include <launchdarkly/json.h>
+
+#include "flag.h"
+#include "json_stream.h"
+
+/* Builds flags directly from the text of a put payload, an object mapping
+flag keys to flags. Input may be delivered in arbitrarily split chunks as it
+arrives from the network, so neither the payload text nor a parse tree of the
+whole payload is ever held in memory. */
+struct LDFlagDecoder
+{
+    struct LDJSONStreamParser parser;
+    /* decoding a single flag object that names its own key */
+    LDBoolean                 single;
+    /* completed flags */
+    struct LDFlag *           flags;
+    unsigned int              flagCount;
+    unsigned int              flagCapacity;
+    /* flag currently being decoded */
+    struct LDFlag             flag;
+    LDBoolean                 hasValue;
+    LDBoolean                 hasVariation;
+    int                       field;
+    size_t                    depth;
+    /* depth within a field that is being ignored or captured as text */
+    size_t                    skipDepth;
+    LDBoolean                 capturing;
+    /* open containers of a value or reason being built */
+    struct LDJSON **          containers;
+    size_t                    containerCount;
+    size_t                    containerCapacity;
+    char *                    pendingKey;
+};
+
+void
+LDi_flagDecoderInitialize(struct LDFlagDecoder *const decoder);
+
+void
+LDi_flagDecoderDestroy(struct LDFlagDecoder *const decoder);
+
+LDBoolean
+LDi_flagDecoderProcess(
+    struct LDFlagDecoder *const decoder,
+    const char *const           data,
+    const size_t                dataSize);
+
+/* on success ownership of the flags is transferred to the caller */
+LDBoolean
+LDi_flagDecoderFinish(
+    struct LDFlagDecoder *const decoder,
+    struct LDFlag **const       flags,
+    unsigned int *const         flagCount);
+
+/* Decodes a single flag object that carries its own key field, as sent in
+patch events. On success ownership of the contents of result is transferred
+to the caller. */
+LDBoolean
+LDi_flagDecode(
+    struct LDFlag *const result,
+    const char *const    text,
+    const size_t         textSize);
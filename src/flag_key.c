@@ -0,0 +1,141 @@
+#include <stddef.h>
+#include <string.h>
+
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "flag_key.h"
+
+static struct LDFlagKeyAtom *
+LDi_flagKeyAtom(const char *const key)
+{
+    return (struct LDFlagKeyAtom *)(key - offsetof(struct LDFlagKeyAtom, text));
+}
+
+LDBoolean
+LDi_flagKeyTableInitialize(struct LDFlagKeyTable *const table)
+{
+    LD_ASSERT(table);
+
+    table->atoms = NULL;
+
+    if (!LDi_mutex_init(&table->lock)) {
+        return LDBooleanFalse;
+    }
+
+    LDi_lockProfileLabel(&table->lock, "flagKeys");
+
+    return LDBooleanTrue;
+}
+
+void
+LDi_flagKeyTableDestroy(struct LDFlagKeyTable *const table)
+{
+    struct LDFlagKeyAtom *atom, *tmp;
+
+    if (table) {
+        HASH_ITER(hh, table->atoms, atom, tmp)
+        {
+            HASH_DEL(table->atoms, atom);
+
+            LDFree(atom);
+        }
+
+        LDi_mutex_destroy(&table->lock);
+    }
+}
+
+const char *
+LDi_flagKeyIntern(struct LDFlagKeyTable *const table, const char *const key)
+{
+    struct LDFlagKeyAtom *atom;
+    unsigned int          hash;
+    size_t                length;
+
+    LD_ASSERT(table);
+    LD_ASSERT(key);
+
+    length = strlen(key);
+
+    HASH_VALUE(key, length, hash);
+
+    LDi_mutex_lock(&table->lock);
+
+    HASH_FIND_BYHASHVALUE(hh, table->atoms, key, length, hash, atom);
+
+    if (atom) {
+        LDi_atomicIncrement(&atom->references);
+    } else {
+        if (!(atom = (struct LDFlagKeyAtom *)LDAlloc(
+                  sizeof(struct LDFlagKeyAtom) + length)))
+        {
+            LDi_mutex_unlock(&table->lock);
+
+            return NULL;
+        }
+
+        atom->table      = table;
+        atom->references = 1;
+        atom->hash       = hash;
+        atom->length     = length;
+
+        memcpy(atom->text, key, length + 1);
+
+        HASH_ADD_KEYPTR_BYHASHVALUE(
+            hh, table->atoms, atom->text, length, hash, atom);
+    }
+
+    LDi_mutex_unlock(&table->lock);
+
+    return atom->text;
+}
+
+void
+LDi_flagKeyRetain(const char *const key)
+{
+    LD_ASSERT(key);
+
+    LDi_atomicIncrement(&LDi_flagKeyAtom(key)->references);
+}
+
+void
+LDi_flagKeyRelease(const char *const key)
+{
+    struct LDFlagKeyAtom * atom;
+    struct LDFlagKeyTable *table;
+
+    if (!key) {
+        return;
+    }
+
+    atom  = LDi_flagKeyAtom(key);
+    table = atom->table;
+
+    /* decrementing under the lock stops a concurrent intern from reviving an
+    atom that is about to be freed */
+    LDi_mutex_lock(&table->lock);
+
+    if (LDi_atomicDecrement(&atom->references) == 0) {
+        HASH_DEL(table->atoms, atom);
+
+        LDFree(atom);
+    }
+
+    LDi_mutex_unlock(&table->lock);
+}
+
+unsigned int
+LDi_flagKeyHash(const char *const key)
+{
+    LD_ASSERT(key);
+
+    return LDi_flagKeyAtom(key)->hash;
+}
+
+size_t
+LDi_flagKeyLength(const char *const key)
+{
+    LD_ASSERT(key);
+
+    return LDi_flagKeyAtom(key)->length;
+}
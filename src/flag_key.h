@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <launchdarkly/boolean.h>
+
+#include "atomic.h"
+#include "concurrency.h"
+#include "uthash.h"
+
+/* Flag keys are compared and hashed on every store update and listener
+dispatch. An intern table gives each distinct key a single immutable copy,
+its atom, with its length and hash computed once, so that holders share the
+copy and compare keys by address. Atoms are reference counted, and remember
+their table so they can be released without it. */
+struct LDFlagKeyAtom
+{
+    UT_hash_handle         hh;
+    struct LDFlagKeyTable *table;
+    ld_atomic_t            references;
+    unsigned int           hash;
+    size_t                 length;
+    /* allocated to fit the key */
+    char                   text[1];
+};
+
+struct LDFlagKeyTable
+{
+    struct LDFlagKeyAtom *atoms;
+    ld_mutex_t            lock;
+};
+
+LDBoolean
+LDi_flagKeyTableInitialize(struct LDFlagKeyTable *const table);
+
+/* frees any atoms still referenced, so must only be called once every holder
+has released its keys */
+void
+LDi_flagKeyTableDestroy(struct LDFlagKeyTable *const table);
+
+/* returns the atom for key with a reference for the caller, or NULL if
+allocation failed */
+const char *
+LDi_flagKeyIntern(struct LDFlagKeyTable *const table, const char *const key);
+
+/* the caller must already hold a reference to key */
+void
+LDi_flagKeyRetain(const char *const key);
+
+void
+LDi_flagKeyRelease(const char *const key);
+
+/* the uthash hash of the key, as used by HASH_FIND_STR */
+unsigned int
+LDi_flagKeyHash(const char *const key);
+
+size_t
+LDi_flagKeyLength(const char *const key);
@@ -0,0 +1,185 @@
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#include "assertion.h"
+#include "concurrency.h"
+#include "latency.h"
+
+/* calls remaining on this thread until the next sampled evaluation */
+static LD_THREAD_LOCAL unsigned int sampleCountdown;
+
+static unsigned int
+LDi_latencyBucket(const unsigned long nanoseconds)
+{
+    unsigned int  exponent, bucket;
+    unsigned long value;
+
+    if (nanoseconds < LD_LATENCY_SUB_BUCKETS) {
+        return (unsigned int)nanoseconds;
+    }
+
+    /* position of the highest set bit, at least three */
+    for (exponent = 3, value = nanoseconds >> 4; value; value >>= 1) {
+        exponent++;
+    }
+
+    /* eight buckets for each exponent from three, selected by the highest
+    four bits which range from eight to fifteen */
+    bucket = (exponent - 3) * LD_LATENCY_SUB_BUCKETS +
+        (unsigned int)(nanoseconds >> (exponent - 3));
+
+    if (bucket >= LD_LATENCY_BUCKETS) {
+        return LD_LATENCY_BUCKETS - 1;
+    }
+
+    return bucket;
+}
+
+/* the largest duration the bucket holds */
+static double
+LDi_latencyBucketLimit(const unsigned int bucket)
+{
+    unsigned int exponent, sub;
+
+    if (bucket < LD_LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    exponent = (bucket - LD_LATENCY_SUB_BUCKETS) / LD_LATENCY_SUB_BUCKETS + 3;
+    sub      = bucket % LD_LATENCY_SUB_BUCKETS;
+
+    return ldexp(LD_LATENCY_SUB_BUCKETS + sub + 1, exponent - 3) - 1;
+}
+
+void
+LDi_latencyInitialize(struct LDLatencyHistogram *const histogram)
+{
+    LD_ASSERT(histogram);
+
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+void
+LDi_latencyRecord(
+    struct LDLatencyHistogram *const histogram,
+    const unsigned long              nanoseconds)
+{
+    const long duration =
+        nanoseconds > LONG_MAX ? LONG_MAX : (long)nanoseconds;
+    long current;
+
+    LD_ASSERT(histogram);
+
+    LDi_atomicIncrement(&histogram->buckets[LDi_latencyBucket(nanoseconds)]);
+
+    while ((current = LDi_atomicLoad(&histogram->max)) < duration) {
+        if (LDi_atomicCompareExchange(&histogram->max, current, duration)) {
+            break;
+        }
+    }
+}
+
+/* the limit of the bucket holding the sample at the percentile, capped by
+the maximum which is exact */
+static double
+LDi_latencyPercentile(
+    const unsigned long *const counts,
+    const unsigned long        total,
+    const double               max,
+    const double               percentile)
+{
+    const double  rank = percentile * total;
+    unsigned long seen;
+    unsigned int  bucket;
+
+    for (bucket = 0, seen = 0; bucket < LD_LATENCY_BUCKETS; bucket++) {
+        seen += counts[bucket];
+
+        if (counts[bucket] && seen >= rank) {
+            const double limit = LDi_latencyBucketLimit(bucket);
+
+            return limit < max ? limit : max;
+        }
+    }
+
+    return 0;
+}
+
+void
+LDi_latencySnapshot(
+    struct LDLatencyHistogram *const histogram,
+    struct LDLatencySnapshot *const  snapshot)
+{
+    unsigned long counts[LD_LATENCY_BUCKETS], total;
+    unsigned int  bucket;
+
+    LD_ASSERT(histogram);
+    LD_ASSERT(snapshot);
+
+    total = 0;
+
+    for (bucket = 0; bucket < LD_LATENCY_BUCKETS; bucket++) {
+        counts[bucket] = LDi_atomicLoad(&histogram->buckets[bucket]);
+        total += counts[bucket];
+    }
+
+    snapshot->count = total;
+    snapshot->max   = LDi_atomicLoad(&histogram->max);
+    snapshot->p50   = LDi_latencyPercentile(counts, total, snapshot->max, 0.5);
+    snapshot->p90   = LDi_latencyPercentile(counts, total, snapshot->max, 0.9);
+    snapshot->p99   = LDi_latencyPercentile(counts, total, snapshot->max, 0.99);
+    snapshot->p999 =
+        LDi_latencyPercentile(counts, total, snapshot->max, 0.999);
+}
+
+void
+LDi_latencyCumulative(
+    struct LDLatencyHistogram *const histogram,
+    const unsigned int *const        exponents,
+    const unsigned int               boundCount,
+    unsigned long *const             below,
+    unsigned long *const             total)
+{
+    unsigned long seen;
+    unsigned int  bucket, bound;
+
+    LD_ASSERT(histogram);
+    LD_ASSERT(exponents || boundCount == 0);
+    LD_ASSERT(below || boundCount == 0);
+    LD_ASSERT(total);
+
+    for (bucket = 0, bound = 0, seen = 0; bucket < LD_LATENCY_BUCKETS;
+         bucket++)
+    {
+        /* the first bucket holding two to the exponent */
+        while (bound < boundCount &&
+               LDi_latencyBucket(1UL << exponents[bound]) == bucket)
+        {
+            below[bound++] = seen;
+        }
+
+        seen += LDi_atomicLoad(&histogram->buckets[bucket]);
+    }
+
+    /* bounds past the last bucket, which also holds clamped durations */
+    while (bound < boundCount) {
+        below[bound++] = seen;
+    }
+
+    *total = seen;
+}
+
+LDBoolean
+LDi_latencySample(const unsigned int interval)
+{
+    if (sampleCountdown) {
+        sampleCountdown--;
+
+        return LDBooleanFalse;
+    }
+
+    sampleCountdown = interval - 1;
+
+    return LDBooleanTrue;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <launchdarkly/api.h>
+
+#include "atomic.h"
+
+/* Histogram of durations in nanoseconds in the style of HDR histograms with
+three significant bits. Durations below eight have a bucket each, above that
+every power of two is split into eight linear buckets, so a bucket spans at
+most an eighth of the values it holds. Buckets are atomic so that threads
+record without locking. */
+#define LD_LATENCY_SUB_BUCKETS 8
+/* enough for durations up to 2^36 nanoseconds, longer ones are clamped */
+#define LD_LATENCY_BUCKETS 272
+
+struct LDLatencyHistogram
+{
+    ld_atomic_t buckets[LD_LATENCY_BUCKETS];
+    ld_atomic_t max;
+};
+
+/* one histogram per variation type */
+enum LDLatencyKind
+{
+    LDLatencyBool = 0,
+    LDLatencyNumber,
+    LDLatencyString,
+    LDLatencyJSON,
+    LDLatencyKindCount
+};
+
+void
+LDi_latencyInitialize(struct LDLatencyHistogram *const histogram);
+
+void
+LDi_latencyRecord(
+    struct LDLatencyHistogram *const histogram,
+    const unsigned long              nanoseconds);
+
+/* counts and percentiles are read bucket by bucket, concurrent recording may
+make them slightly inconsistent with each other */
+void
+LDi_latencySnapshot(
+    struct LDLatencyHistogram *const histogram,
+    struct LDLatencySnapshot *const  snapshot);
+
+/* for each of boundCount ascending exponents, the number of durations below
+two to that exponent in nanoseconds, which are bucket boundaries, and the
+number of all durations */
+void
+LDi_latencyCumulative(
+    struct LDLatencyHistogram *const histogram,
+    const unsigned int *const        exponents,
+    const unsigned int               boundCount,
+    unsigned long *const             below,
+    unsigned long *const             total);
+
+/* true once per interval calls on each thread */
+LDBoolean
+LDi_latencySample(const unsigned int interval);
@@ -41,17 +41,21 @@ LDi_cancelread(const int handle);
 char *
 LDi_fetchfeaturemap(struct LDClient *client, int *response);
 
+/* cbread is called with the parser context after each network read, and
+periodically while the connection is idle */
 void
 LDi_readstream(
     struct LDClient *const    client,
     long *                     response,
     struct LDSSEParser *const parser,
-    void                      cbhandle(struct LDClient *client, int handle));
+    void                      cbhandle(struct LDClient *client, int handle),
+    void                      cbread(void *context));
 
 void
 LDi_sendevents(
     struct LDClient *const client,
     const char *const      eventdata,
+    const size_t           eventdataSize,
     const char *const      payloadUUID,
     int *const             response);
 
@@ -60,12 +64,30 @@ LDi_reinitializeconnection(struct LDClient *const client);
 void
 LDi_startstopstreaming(
     struct LDClient *const client, const LDBoolean stopstreaming);
+/* wakes the streaming thread and schedules or cancels the timers of client to
+suit its state */
 void
-LDi_onstreameventput(struct LDClient *const client, const char *const data);
+LDi_clientStateChanged(struct LDClient *const client);
+/* the polling and flush timers, which are scheduled by the first state
+change */
+void
+LDi_initializeTimers(struct LDClient *const client);
+/* waits for a running poll or delivery */
 void
-LDi_onstreameventpatch(struct LDClient *const client, const char *const data);
+LDi_cancelTimers(struct LDClient *const client);
+/* delivers the events still queued, expects the timers to be cancelled */
+void
+LDi_flushEventsOnClose(struct LDClient *const client);
+/* waits on cond for at most milliseconds, or LD_WAIT_FOREVER, returning true
+early if the state changed since generation was read */
+LDBoolean
+LDi_awaitStateChange(
+    struct LDClient *const client,
+    ld_cond_t *const       cond,
+    const long             generation,
+    const int              milliseconds);
 void
-LDi_onstreameventdelete(struct LDClient *const client, const char *const data);
+LDi_onstreameventput(struct LDClient *const client, const char *const data);
 
 void
 LDi_millisleep(int ms);
@@ -94,10 +116,6 @@ LDi_earlyinit(void);
 void
 LDi_updatestatus(struct LDClient *const client, const LDStatus status);
 
-THREAD_RETURN
-LDi_bgeventsender(void *const v);
-THREAD_RETURN
-LDi_bgfeaturepoller(void *const v);
 THREAD_RETURN
 LDi_bgfeaturestreamer(void *const v);
 
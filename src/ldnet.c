@@ -7,9 +7,9 @@
 #include <launchdarkly/api.h>
 
 #include "ldinternal.h"
+#include "request_template.h"
 
 #define LD_STREAMTIMEOUT_MS 300000
-#define LD_USER_AGENT_HEADER "User-Agent: CClient/" LD_SDK_VERSION
 #define UNUSED(x) (void)(x)
 
 struct MemoryStruct
@@ -25,6 +25,7 @@ struct streamdata
     curl_off_t          lastdataamt;
     struct LDClient *   client;
     struct LDSSEParser *parser;
+    void (*cbread)(void *);
 };
 
 struct cbhandlecontext
@@ -74,7 +75,11 @@ StreamWriteCallback(
     realSize = size * nmemb;
     context  = (struct streamdata *)rawContext;
 
+    LDi_atomicAdd(&context->client->counters.bytesReceived, (long)realSize);
+
     if (LDSSEParserProcess(context->parser, contents, realSize)) {
+        context->cbread(context->parser->context);
+
         return realSize;
     }
 
@@ -107,6 +112,8 @@ ProgressCallback(void *clientp,
     LD_ASSERT(clientp);
     context  = (struct streamdata *)clientp;
 
+    context->cbread(context->parser->context);
+
     if (context->lastdataamt == dlnow) {
         LDi_getMonotonicMilliseconds(&currentTime);
 
@@ -150,27 +157,20 @@ SocketCallback(
 /* returns LDBooleanFalse on failure, results left in clean state */
 static LDBoolean
 prepareShared(
-    const char *const            url,
-    const struct LDConfig *const config,
-    CURL **                      r_curl,
-    struct curl_slist **         r_headers,
-    WriteCB                      headercb,
-    void *const                  headerdata,
-    WriteCB                      datacb,
-    void *const                  data,
-    const struct LDClient *const client)
+    const char *const              url,
+    const struct curl_slist *const headers,
+    const struct LDConfig *const   config,
+    CURL **                        r_curl,
+    WriteCB                        headercb,
+    void *const                    headerdata,
+    WriteCB                        datacb,
+    void *const                    data)
 {
-
-    char               headerauth[256];
-    struct curl_slist *headers, *headerstmp;
-    CURL *             curl;
+    CURL *curl;
 
     LD_ASSERT(url);
+    LD_ASSERT(headers);
     LD_ASSERT(config);
-    LD_ASSERT(client);
-
-    headers    = NULL;
-    headerstmp = NULL;
 
     if (!(curl = curl_easy_init())) {
         LD_LOG(LD_LOG_CRITICAL, "curl_easy_init returned NULL");
@@ -184,32 +184,11 @@ prepareShared(
         goto error;
     }
 
-    if (snprintf(
-            headerauth,
-            sizeof(headerauth),
-            "Authorization: %s",
-            client->mobileKey) < 0)
-    {
-        LD_LOG(
-            LD_LOG_CRITICAL,
-            "snprintf during Authorization header creation failed");
-
-        goto error;
-    }
-
-    if (!(headerstmp = curl_slist_append(headers, headerauth))) {
-        LD_LOG(LD_LOG_CRITICAL, "curl_slist_append failed for headerauth");
-
-        goto error;
-    }
-    headers = headerstmp;
-
-    if (!(headerstmp = curl_slist_append(headers, LD_USER_AGENT_HEADER))) {
-        LD_LOG(LD_LOG_CRITICAL, "curl_slist_append failed for headeragent");
+    if (curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers) != CURLE_OK) {
+        LD_LOG(LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_HTTPHEADER failed");
 
         goto error;
     }
-    headers = headerstmp;
 
     if (curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headercb) != CURLE_OK) {
         LD_LOG(
@@ -277,18 +256,51 @@ prepareShared(
         goto error;
     }
 
-    *r_curl    = curl;
-    *r_headers = headers;
+    *r_curl = curl;
 
     return LDBooleanTrue;
 
 error:
     curl_easy_cleanup(curl);
-    curl_slist_free_all(headers);
 
     return LDBooleanFalse;
 }
 
+/* configures a REPORT request if the template requires one */
+static LDBoolean
+prepareReport(CURL *const curl, const struct LDRequestTemplate *const requests)
+{
+    if (!requests->reportBody) {
+        return LDBooleanTrue;
+    }
+
+    if (curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "REPORT") != CURLE_OK) {
+        LD_LOG(LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_CUSTOMREQUEST failed");
+
+        return LDBooleanFalse;
+    }
+
+    if (curl_easy_setopt(
+            curl, CURLOPT_POSTFIELDSIZE, (long)requests->reportBodySize) !=
+        CURLE_OK)
+    {
+        LD_LOG(
+            LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_POSTFIELDSIZE failed");
+
+        return LDBooleanFalse;
+    }
+
+    if (curl_easy_setopt(curl, CURLOPT_POSTFIELDS, requests->reportBody) !=
+        CURLE_OK)
+    {
+        LD_LOG(LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_POSTFIELDS failed");
+
+        return LDBooleanFalse;
+    }
+
+    return LDBooleanTrue;
+}
+
 void
 LDi_cancelread(const int handle)
 {
@@ -308,26 +320,23 @@ LDi_readstream(
     struct LDClient *const    client,
     long *                     response,
     struct LDSSEParser *const parser,
-    void                      cbhandle(struct LDClient *, int))
+    void                      cbhandle(struct LDClient *, int),
+    void                      cbread(void *))
 {
-    CURLcode               res;
-    struct MemoryStruct    headers;
-    struct streamdata      streamdata;
-    struct cbhandlecontext handledata;
-    CURL *                 curl;
-    struct curl_slist *    headerlist, *headertmp;
-    struct LDJSON *        userJSON;
-    char *                 userJSONText;
-    char                   url[4096];
+    CURLcode                  res;
+    struct MemoryStruct       headers;
+    struct streamdata         streamdata;
+    struct cbhandlecontext    handledata;
+    CURL *                    curl;
+    struct LDRequestTemplate *requests;
 
     LD_ASSERT(client);
     LD_ASSERT(response);
     LD_ASSERT(parser);
     LD_ASSERT(cbhandle);
+    LD_ASSERT(cbread);
 
-    curl       = NULL;
-    headerlist = NULL;
-    headertmp  = NULL;
+    curl = NULL;
 
     handledata.client = client;
     handledata.cb     = cbhandle;
@@ -336,136 +345,35 @@ LDi_readstream(
     memset(&streamdata, 0, sizeof(streamdata));
 
     streamdata.parser       = parser;
+    streamdata.cbread       = cbread;
     streamdata.lastdataamt  = 0;
     streamdata.client       = client;
 
     LDi_getMonotonicMilliseconds(&streamdata.lastdatatime);
 
-    LDi_rwlock_rdlock(&client->shared->sharedUserLock);
-    LDi_rwlock_rdlock(&client->clientLock);
-
-    userJSON = LDi_userToJSON(
-        client->shared->sharedUser, LDBooleanFalse, LDBooleanFalse, NULL);
-
-    LDi_rwlock_rdunlock(&client->clientLock);
-    LDi_rwlock_rdunlock(&client->shared->sharedUserLock);
-
-    if (userJSON == NULL) {
-        LD_LOG(LD_LOG_CRITICAL, "failed to convert user to user");
+    if (!(requests = LDi_clientRequestTemplate(client))) {
+        LD_LOG(LD_LOG_CRITICAL, "no request template in LDi_readstream");
 
         return;
     }
 
-    userJSONText = LDJSONSerialize(userJSON);
-    LDJSONFree(userJSON);
-
-    if (userJSONText == NULL) {
-        LD_LOG(LD_LOG_CRITICAL, "failed to serialize user");
-
-        return;
-    }
-
-    if (client->shared->sharedConfig->useReport) {
-        if (snprintf(
-                url,
-                sizeof(url),
-                "%s/meval",
-                client->shared->sharedConfig->streamURI) < 0)
-        {
-            LDFree(userJSONText);
-
-            LD_LOG(LD_LOG_CRITICAL, "snprintf usereport failed");
-
-            return;
-        }
-    } else {
-        int                  status;
-        size_t               b64len;
-        unsigned char *const b64text = LDi_base64_encode(
-            (unsigned char *)userJSONText, strlen(userJSONText), &b64len);
-
-        if (!b64text) {
-            LDFree(userJSONText);
-
-            LD_LOG(LD_LOG_ERROR, "LDi_base64_encode == NULL in LDi_readstream");
-
-            return;
-        }
-
-        status = snprintf(
-            url,
-            sizeof(url),
-            "%s/meval/%s",
-            client->shared->sharedConfig->streamURI,
-            b64text);
-
-        LDFree(b64text);
-
-        if (status < 0) {
-            LDFree(userJSONText);
-
-            LD_LOG(LD_LOG_ERROR, "snprintf !usereport failed");
-
-            return;
-        }
-    }
-
-    if (client->shared->sharedConfig->useReasons) {
-        const size_t len = strlen(url);
-
-        if (snprintf(
-                url + len, sizeof(url) - len, "?withReasons=true") < 0)
-        {
-            LDFree(userJSONText);
-
-            LD_LOG(LD_LOG_ERROR, "snprintf useReason failed");
-
-            return;
-        }
-    }
-
     if (!prepareShared(
-            url,
+            requests->streamURL,
+            requests->flagHeaders,
             client->shared->sharedConfig,
             &curl,
-            &headerlist,
             &WriteMemoryCallback,
             &headers,
             &StreamWriteCallback,
-            &streamdata,
-            client))
+            &streamdata))
     {
-        LDFree(userJSONText);
+        LDi_rc_decrement(&requests->rc);
 
         return;
     }
 
-    if (client->shared->sharedConfig->useReport) {
-        if (curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "REPORT") != CURLE_OK)
-        {
-            LD_LOG(
-                LD_LOG_CRITICAL,
-                "curl_easy_setopt CURLOPT_CUSTOMREQUEST failed");
-
-            goto cleanup;
-        }
-
-        if (!(headertmp = curl_slist_append(
-                  headerlist, "Content-Type: application/json")))
-        {
-            LD_LOG(LD_LOG_CRITICAL, "curl_slist_append failed for headermime");
-
-            goto cleanup;
-        }
-        headerlist = headertmp;
-
-        if (curl_easy_setopt(curl, CURLOPT_POSTFIELDS, userJSONText) !=
-            CURLE_OK) {
-            LD_LOG(
-                LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_POSTFIELDS failed");
-
-            goto cleanup;
-        }
+    if (!prepareReport(curl, requests)) {
+        goto cleanup;
     }
 
     if (curl_easy_setopt(curl, CURLOPT_OPENSOCKETFUNCTION, SocketCallback) !=
@@ -486,12 +394,6 @@ LDi_readstream(
         goto cleanup;
     }
 
-    if (curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist) != CURLE_OK) {
-        LD_LOG(LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_HTTPHEADER failed");
-
-        goto cleanup;
-    }
-
     /* This needs set or progress callbacks will not be made. */
     if (curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0)) {
         LD_LOG(LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_NOPROGRESS failed");
@@ -514,7 +416,7 @@ LDi_readstream(
         goto cleanup;
     }
 
-    LD_LOG_1(LD_LOG_INFO, "connecting to stream %s", url);
+    LD_LOG_1(LD_LOG_INFO, "connecting to stream %s", requests->streamURL);
     res = curl_easy_perform(curl);
 
     /* CURL_LAST = 99 so the union of curl responses + http response codes should have no overlap. */
@@ -530,158 +432,44 @@ LDi_readstream(
 cleanup:
     LDFree(streamdata.mem.memory);
     LDFree(headers.memory);
-    LDFree(userJSONText);
-
-    curl_slist_free_all(headerlist);
 
     curl_easy_cleanup(curl);
+
+    LDi_rc_decrement(&requests->rc);
 }
 
 char *
 LDi_fetchfeaturemap(struct LDClient *const client, int *response)
 {
-    struct MemoryStruct headers, data;
-    CURL *              curl       = NULL;
-    struct curl_slist * headerlist = NULL, *headertmp = NULL;
-    struct LDJSON *     userJSON;
-    char *              userJSONText;
-    char                url[4096];
+    struct MemoryStruct       headers, data;
+    CURL *                    curl = NULL;
+    struct LDRequestTemplate *requests;
 
     memset(&headers, 0, sizeof(headers));
     memset(&data, 0, sizeof(data));
 
-    LDi_rwlock_rdlock(&client->shared->sharedUserLock);
-    LDi_rwlock_rdlock(&client->clientLock);
-
-    userJSON = LDi_userToJSON(
-        client->shared->sharedUser, LDBooleanFalse, LDBooleanFalse, NULL);
-
-    LDi_rwlock_rdunlock(&client->clientLock);
-    LDi_rwlock_rdunlock(&client->shared->sharedUserLock);
-
-    if (userJSON == NULL) {
-        LD_LOG(LD_LOG_CRITICAL, "failed to convert user to user");
+    if (!(requests = LDi_clientRequestTemplate(client))) {
+        LD_LOG(LD_LOG_CRITICAL, "no request template in LDi_fetchfeaturemap");
 
         return NULL;
     }
 
-    userJSONText = LDJSONSerialize(userJSON);
-    LDJSONFree(userJSON);
-
-    if (userJSONText == NULL) {
-        LD_LOG(LD_LOG_CRITICAL, "failed to serialize user");
-
-        return NULL;
-    }
-
-    if (client->shared->sharedConfig->useReport) {
-        if (snprintf(
-                url,
-                sizeof(url),
-                "%s/msdk/evalx/user",
-                client->shared->sharedConfig->appURI) < 0)
-        {
-            LDFree(userJSONText);
-
-            LD_LOG(LD_LOG_CRITICAL, "snprintf usereport failed");
-
-            return NULL;
-        }
-    } else {
-        int                  status;
-        size_t               b64len;
-        unsigned char *const b64text = LDi_base64_encode(
-            (unsigned char *)userJSONText, strlen(userJSONText), &b64len);
-
-        if (!b64text) {
-            LDFree(userJSONText);
-
-            LD_LOG(
-                LD_LOG_CRITICAL,
-                "LDi_base64_encode == NULL in LDi_fetchfeaturemap");
-
-            return NULL;
-        }
-
-        status = snprintf(
-            url,
-            sizeof(url),
-            "%s/msdk/evalx/users/%s",
-            client->shared->sharedConfig->appURI,
-            b64text);
-
-        LDFree(b64text);
-
-        if (status < 0) {
-            LDFree(userJSONText);
-
-            LD_LOG(LD_LOG_ERROR, "snprintf !usereport failed");
-
-            return NULL;
-        }
-    }
-
-    if (client->shared->sharedConfig->useReasons) {
-        const size_t len = strlen(url);
-        if (snprintf(
-                url + len, sizeof(url) - len, "?withReasons=true") < 0)
-        {
-            LDFree(userJSONText);
-
-            LD_LOG(LD_LOG_ERROR, "snprintf useReason failed");
-
-            return NULL;
-        }
-    }
-
     if (!prepareShared(
-            url,
+            requests->pollURL,
+            requests->flagHeaders,
             client->shared->sharedConfig,
             &curl,
-            &headerlist,
             &WriteMemoryCallback,
             &headers,
             &WriteMemoryCallback,
-            &data,
-            client))
+            &data))
     {
-        LDFree(userJSONText);
+        LDi_rc_decrement(&requests->rc);
 
         return NULL;
     }
 
-    LDFree(userJSONText);
-
-    if (client->shared->sharedConfig->useReport) {
-        if (curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "REPORT") != CURLE_OK)
-        {
-            LD_LOG(
-                LD_LOG_CRITICAL,
-                "curl_easy_setopt CURLOPT_CUSTOMREQUEST failed");
-
-            goto error;
-        }
-
-        if (!(headertmp = curl_slist_append(
-                  headerlist, "Content-Type: application/json")))
-        {
-            LD_LOG(LD_LOG_CRITICAL, "curl_slist_append failed for headermime");
-
-            goto error;
-        }
-        headerlist = headertmp;
-
-        if (curl_easy_setopt(curl, CURLOPT_POSTFIELDS, userJSONText) !=
-            CURLE_OK) {
-            LD_LOG(
-                LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_POSTFIELDS failed");
-
-            goto error;
-        }
-    }
-
-    if (curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist) != CURLE_OK) {
-        LD_LOG(LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_HTTPHEADER failed");
+    if (!prepareReport(curl, requests)) {
         goto error;
     }
 
@@ -699,22 +487,24 @@ LDi_fetchfeaturemap(struct LDClient *const client, int *response)
         *response = -1;
     }
 
-    LDFree(headers.memory);
+    LDi_atomicAdd(&client->counters.bytesReceived, (long)data.size);
 
-    curl_slist_free_all(headerlist);
+    LDFree(headers.memory);
 
     curl_easy_cleanup(curl);
 
+    LDi_rc_decrement(&requests->rc);
+
     return data.memory;
 
 error:
     LDFree(data.memory);
     LDFree(headers.memory);
 
-    curl_slist_free_all(headerlist);
-
     curl_easy_cleanup(curl);
 
+    LDi_rc_decrement(&requests->rc);
+
     return NULL;
 }
 
@@ -722,13 +512,15 @@ void
 LDi_sendevents(
     struct LDClient *const client,
     const char *const      eventdata,
+    const size_t           eventdataSize,
     const char *const      payloadUUID,
     int *const             response)
 {
-    struct MemoryStruct headers, data;
-    CURL *              curl       = NULL;
-    struct curl_slist * headerlist = NULL, *headertmp = NULL;
-    char                url[4096];
+    struct MemoryStruct       headers, data;
+    CURL *                    curl = NULL;
+    struct LDRequestTemplate *requests;
+    /* links the payload ID in front of the shared headers without copying */
+    struct curl_slist         payloadIdNode;
 
 /* This is done as a macro so that the string is a literal */
 #define LD_PAYLOAD_ID_HEADER "X-LaunchDarkly-Payload-ID: "
@@ -739,49 +531,6 @@ LDi_sendevents(
     memset(&headers, 0, sizeof(headers));
     memset(&data, 0, sizeof(data));
 
-    if (snprintf(
-            url,
-            sizeof(url),
-            "%s/mobile",
-            client->shared->sharedConfig->eventsURI) < 0)
-    {
-        LD_LOG(LD_LOG_CRITICAL, "snprintf config->eventsURI failed");
-
-        return;
-    }
-
-    if (!prepareShared(
-            url,
-            client->shared->sharedConfig,
-            &curl,
-            &headerlist,
-            &WriteMemoryCallback,
-            &headers,
-            &WriteMemoryCallback,
-            &data,
-            client))
-    {
-        return;
-    }
-
-    if (!(headertmp =
-              curl_slist_append(headerlist, "Content-Type: application/json")))
-    {
-        LD_LOG(LD_LOG_CRITICAL, "curl_slist_append failed for headermime");
-
-        goto cleanup;
-    }
-    headerlist = headertmp;
-
-    if (!(headertmp =
-              curl_slist_append(headerlist, "X-LaunchDarkly-Event-Schema: 3")))
-    {
-        LD_LOG(LD_LOG_CRITICAL, "curl_slist_append failed for headerschema");
-
-        goto cleanup;
-    }
-    headerlist = headertmp;
-
     {
         int len;
 
@@ -794,19 +543,42 @@ LDi_sendevents(
 
         if (len != sizeof(payloadIdHeader) - 1) {
             LD_LOG(LD_LOG_CRITICAL, "unable to generate payload ID header");
-            goto cleanup;
+
+            return;
         }
     }
 
 #undef LD_PAYLOAD_ID_HEADER
 
-    if (!(headertmp = curl_slist_append(headerlist, payloadIdHeader))) {
-        goto cleanup;
+    if (!(requests = LDi_clientRequestTemplate(client))) {
+        LD_LOG(LD_LOG_CRITICAL, "no request template in LDi_sendevents");
+
+        return;
     }
-    headerlist = headertmp;
 
-    if (curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist) != CURLE_OK) {
-        LD_LOG(LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_HTTPHEADER failed");
+    payloadIdNode.data = payloadIdHeader;
+    payloadIdNode.next = requests->eventHeaders;
+
+    if (!prepareShared(
+            requests->eventsURL,
+            &payloadIdNode,
+            client->shared->sharedConfig,
+            &curl,
+            &WriteMemoryCallback,
+            &headers,
+            &WriteMemoryCallback,
+            &data))
+    {
+        LDi_rc_decrement(&requests->rc);
+
+        return;
+    }
+
+    if (curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)eventdataSize) !=
+        CURLE_OK)
+    {
+        LD_LOG(
+            LD_LOG_CRITICAL, "curl_easy_setopt CURLOPT_POSTFIELDSIZE failed");
 
         goto cleanup;
     }
@@ -835,7 +607,7 @@ cleanup:
     LDFree(data.memory);
     LDFree(headers.memory);
 
-    curl_slist_free_all(headerlist);
-
     curl_easy_cleanup(curl);
+
+    LDi_rc_decrement(&requests->rc);
 }
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #ifndef _WINDOWS
 #include <unistd.h>
 #else
@@ -12,6 +13,7 @@
 #include <curl/curl.h>
 
 #include "flag.h"
+#include "flag_decoder.h"
 #include "ldinternal.h"
 
 /*
@@ -19,313 +21,336 @@
  * plus the server event parser and streaming update handler.
  */
 
-THREAD_RETURN
-LDi_bgeventsender(void *const v)
+static LDBoolean
+LDi_eventDeliveryEnabled(struct LDClient *const client)
 {
-    struct LDClient *const client     = v;
-    LDBoolean              finalflush = LDBooleanFalse;
-
-    while (LDBooleanTrue) {
-        struct LDJSON *payloadJSON;
-        char *         payloadSerialized;
-        LDStatus       status;
-        int            ms;
-        char           payloadId[LD_UUID_SIZE + 1];
-        LDBoolean      sendFailed;
+    const LDStatus status = (LDStatus)LDi_atomicLoad(&client->status);
 
-        LDi_rwlock_wrlock(&client->clientLock);
-
-        status = client->status;
-
-        if (status == LDStatusFailed || finalflush) {
-            LD_LOG(LD_LOG_TRACE, "killing thread LDi_bgeventsender");
-            LDi_rwlock_wrunlock(&client->clientLock);
-            return THREAD_RETURN_DEFAULT;
-        }
-
-        ms = client->shared->sharedConfig->eventsFlushIntervalMillis;
+    return status != LDStatusFailed && status != LDStatusShuttingdown &&
+        !LDi_atomicLoad(&client->offline);
+}
 
-        if (status != LDStatusShuttingdown) {
-            LDi_mutex_lock(&client->condMtx);
-            LDi_rwlock_wrunlock(&client->clientLock);
-            LDi_cond_wait(&client->eventCond, &client->condMtx, ms);
-            LDi_mutex_unlock(&client->condMtx);
-        } else {
-            LDi_rwlock_wrunlock(&client->clientLock);
-        }
+/* builds a payload of the queued events unless one is awaiting its retry,
+then makes one attempt to deliver it. Returns true if it should be retried. */
+static LDBoolean
+LDi_sendEventPayload(struct LDClient *const client)
+{
+    int    response;
+    double sendStarted, sendFinished;
 
-        LD_LOG(LD_LOG_TRACE, "bgsender running");
+    if (!client->eventPayloadRetry) {
+        struct LDJSON *payloadJSON;
 
-        LDi_rwlock_rdlock(&client->clientLock);
-        if (client->status == LDStatusShuttingdown) {
-            finalflush = LDBooleanTrue;
-        }
+        if (!client->eventPayload &&
+            !(client->eventPayload = LDBufferNew()))
+        {
+            LD_LOG(
+                LD_LOG_ERROR, "LDi_sendEventPayload failed to allocate buffer");
 
-        if (client->offline) {
-            LDi_rwlock_rdunlock(&client->clientLock);
-            continue;
+            return LDBooleanFalse;
         }
-        LDi_rwlock_rdunlock(&client->clientLock);
 
-        payloadId[LD_UUID_SIZE] = 0;
+        client->eventPayloadId[LD_UUID_SIZE] = 0;
 
-        if (!LDi_UUIDv4(payloadId)) {
+        if (!LDi_UUIDv4(client->eventPayloadId)) {
             LD_LOG(LD_LOG_ERROR, "failed to generate payload identifier");
 
-            continue;
+            return LDBooleanFalse;
         }
 
         if (!LDi_bundleEventPayload(client->eventProcessor, &payloadJSON)) {
             LD_LOG(
                 LD_LOG_ERROR,
-                "LDi_bgeventsender failed to bundle event payload");
+                "LDi_sendEventPayload failed to bundle event payload");
 
-            continue;
+            return LDBooleanFalse;
         }
 
         if (payloadJSON == NULL) {
-            continue;
+            return LDBooleanFalse;
         }
 
-        if (!(payloadSerialized = LDJSONSerialize(payloadJSON))) {
+        LDBufferClear(client->eventPayload);
+
+        if (!LDJSONSerializeTo(payloadJSON, client->eventPayload)) {
             LD_LOG(
                 LD_LOG_ERROR,
-                "LDi_bgeventsender failed to serialize event payload");
+                "LDi_sendEventPayload failed to serialize event payload");
 
             LDJSONFree(payloadJSON);
 
-            continue;
+            return LDBooleanFalse;
         }
 
+        client->eventPayloadCount = LDCollectionGetSize(payloadJSON);
+
         LDJSONFree(payloadJSON);
+    }
 
-        sendFailed = LDBooleanFalse;
-        while (LDBooleanTrue) {
-            int response = 0;
+    response = 0;
 
-            LDi_sendevents(client, payloadSerialized, payloadId, &response);
+    LDi_getMonotonicMilliseconds(&sendStarted);
 
-            if (response == 200 || response == 202) {
-                LD_LOG(LD_LOG_TRACE, "successfuly sent event batch");
+    LDi_sendevents(
+        client,
+        LDBufferData(client->eventPayload),
+        LDBufferSize(client->eventPayload),
+        client->eventPayloadId,
+        &response);
 
-                sendFailed = LDBooleanFalse;
+    LDi_getMonotonicMilliseconds(&sendFinished);
 
-                break;
-            } else {
-                if (sendFailed == LDBooleanTrue) {
-                    break;
-                }
+    if (response == 200 || response == 202) {
+        LD_LOG(LD_LOG_TRACE, "successfuly sent event batch");
 
-                sendFailed = LDBooleanTrue;
+        LDi_atomicIncrement(&client->counters.flushes);
+        LDi_atomicAdd(
+            &client->counters.eventsFlushed, client->eventPayloadCount);
+        LDi_atomicAdd(
+            &client->counters.bytesSent,
+            (long)LDBufferSize(client->eventPayload));
+        LDi_atomicStore(
+            &client->counters.lastFlushMilliseconds,
+            (long)(sendFinished - sendStarted));
 
-                if (response == 401 || response == 403) {
-                    LDi_rwlock_wrlock(&client->clientLock);
-                    LDi_updatestatus(client, LDStatusFailed);
-                    LDi_rwlock_wrunlock(&client->clientLock);
+        client->eventPayloadRetry = LDBooleanFalse;
 
-                    LD_LOG(
-                        LD_LOG_ERROR,
-                        "mobile key not authorized, event sending failed");
-
-                    break;
-                }
+        return LDBooleanFalse;
+    }
 
-                LDi_mutex_lock(&client->condMtx);
-                LDi_cond_wait(&client->eventCond, &client->condMtx, 1000);
-                LDi_mutex_unlock(&client->condMtx);
-            }
-        }
+    if (response == 401 || response == 403) {
+        LDi_rwlock_wrlock(&client->clientLock);
+        LDi_updatestatus(client, LDStatusFailed);
+        LDi_rwlock_wrunlock(&client->clientLock);
 
-        if (sendFailed) {
-            LD_LOG(
-                LD_LOG_WARNING, "sending events failed deleting event batch");
-        }
+        LD_LOG(LD_LOG_ERROR, "mobile key not authorized, event sending failed");
+    } else if (!client->eventPayloadRetry) {
+        client->eventPayloadRetry = LDBooleanTrue;
 
-        LDFree(payloadSerialized);
+        return LDBooleanTrue;
     }
+
+    LD_LOG(LD_LOG_WARNING, "sending events failed deleting event batch");
+
+    client->eventPayloadRetry = LDBooleanFalse;
+
+    return LDBooleanFalse;
 }
 
-/*
- * this thread always runs, even when using streaming, but then it just sleeps
- */
-THREAD_RETURN
-LDi_bgfeaturepoller(void *const v)
+static void
+LDi_onFlushTimer(void *const v)
 {
     struct LDClient *const client = v;
+    LDBoolean              retry;
 
-    while (LDBooleanTrue) {
-        LDBoolean skippolling;
-        int       ms, response;
-        char *    data;
+    if (!LDi_eventDeliveryEnabled(client)) {
+        /* scheduled again when that changes */
+        return;
+    }
 
-        LDi_rwlock_wrlock(&client->clientLock);
+    LD_LOG(LD_LOG_TRACE, "bgsender running");
 
-        if (client->status == LDStatusFailed ||
-            client->status == LDStatusShuttingdown) {
-            LD_LOG(LD_LOG_TRACE, "killing thread LDi_bgfeaturepoller");
-            LDi_rwlock_wrunlock(&client->clientLock);
-            return THREAD_RETURN_DEFAULT;
-        }
+    retry = LDi_sendEventPayload(client);
 
-        skippolling = client->offline;
-        ms          = client->shared->sharedConfig->pollingIntervalMillis;
-        if (client->background) {
-            ms = client->shared->sharedConfig->backgroundPollingIntervalMillis;
-            skippolling =
-                skippolling ||
-                client->shared->sharedConfig->disableBackgroundUpdating;
-        } else {
-            skippolling =
-                skippolling || client->shared->sharedConfig->streaming;
-        }
+    if (LDi_eventDeliveryEnabled(client)) {
+        LDi_timerStart(
+            &client->shared->timers,
+            &client->flushTimer,
+            retry ? 1000
+                  : client->shared->sharedConfig->eventsFlushIntervalMillis);
+    }
+}
 
-        /* this triggers the first time the thread runs, so we don't have
-        to wait */
-        if (!skippolling && client->status == LDStatusInitializing) {
-            ms = 0;
-        }
+/* polling runs while offline or in the background only if configured, and in
+the foreground only without streaming */
+static LDBoolean
+LDi_pollingEnabled(struct LDClient *const client, int *const interval)
+{
+    const struct LDConfig *const config = client->shared->sharedConfig;
+    const LDStatus status = (LDStatus)LDi_atomicLoad(&client->status);
 
-        if (ms > 0) {
-            LDi_mutex_lock(&client->condMtx);
-            LDi_rwlock_wrunlock(&client->clientLock);
-            LDi_cond_wait(&client->pollCond, &client->condMtx, ms);
-            LDi_mutex_unlock(&client->condMtx);
-        } else {
-            LDi_rwlock_wrunlock(&client->clientLock);
-        }
+    if (status == LDStatusFailed || status == LDStatusShuttingdown ||
+        LDi_atomicLoad(&client->offline))
+    {
+        return LDBooleanFalse;
+    }
 
-        if (skippolling) {
-            continue;
-        }
+    if (LDi_atomicLoad(&client->background)) {
+        *interval = config->backgroundPollingIntervalMillis;
 
-        LDi_rwlock_rdlock(&client->clientLock);
-        if (client->status == LDStatusFailed ||
-            client->status == LDStatusShuttingdown) {
-            LDi_rwlock_rdunlock(&client->clientLock);
-            continue;
-        }
-        LDi_rwlock_rdunlock(&client->clientLock);
+        return !config->disableBackgroundUpdating;
+    }
 
-        response = 0;
-        data     = LDi_fetchfeaturemap(client, &response);
+    *interval = config->pollingIntervalMillis;
 
-        if (response == 200) {
-            if (!data) {
-                continue;
-            }
+    return !config->streaming;
+}
 
-            LDi_onstreameventput(client, data);
-        } else if (response == 401 || response == 403) {
-            LDi_rwlock_wrlock(&client->clientLock);
-            LDi_updatestatus(client, LDStatusFailed);
-            LDi_rwlock_wrunlock(&client->clientLock);
+static void
+LDi_onPollTimer(void *const v)
+{
+    struct LDClient *const client = v;
+    int                    interval, response;
+    char *                 data;
 
-            LD_LOG(LD_LOG_ERROR, "mobile key not authorized, polling failed");
-        } else {
-            LD_LOG(LD_LOG_ERROR, "poll failed will retry again");
+    if (!LDi_pollingEnabled(client, &interval)) {
+        /* scheduled again when that changes */
+        return;
+    }
+
+    response = 0;
+    data     = LDi_fetchfeaturemap(client, &response);
+
+    if (response == 200) {
+        if (data) {
+            LDi_onstreameventput(client, data);
         }
+    } else if (response == 401 || response == 403) {
+        LDi_rwlock_wrlock(&client->clientLock);
+        LDi_updatestatus(client, LDStatusFailed);
+        LDi_rwlock_wrunlock(&client->clientLock);
+
+        LD_LOG(LD_LOG_ERROR, "mobile key not authorized, polling failed");
+    } else {
+        LD_LOG(LD_LOG_ERROR, "poll failed will retry again");
+    }
 
-        LDFree(data);
+    LDFree(data);
+
+    /* a failed poll waits out the interval even while initializing */
+    if (LDi_pollingEnabled(client, &interval)) {
+        LDi_timerStart(&client->shared->timers, &client->pollTimer, interval);
     }
 }
 
 void
-LDi_onstreameventput(struct LDClient *const client, const char *const data)
+LDi_initializeTimers(struct LDClient *const client)
 {
-    struct LDJSON *payload, *payloadIter;
-    struct LDFlag *flags, *flagsIter;
-    unsigned int   flagCount;
+    const struct LDConfig *const config = client->shared->sharedConfig;
 
-    payload = NULL;
+    /* polls and deliveries of environments sharing a host are coalesced */
+    LDi_timerInitialize(
+        &client->pollTimer, LDi_onPollTimer, client, config->appURI);
+    LDi_timerInitialize(
+        &client->flushTimer, LDi_onFlushTimer, client, config->eventsURI);
+}
 
-    if (!(payload = LDJSONDeserialize(data))) {
-        goto cleanup;
-    }
+void
+LDi_cancelTimers(struct LDClient *const client)
+{
+    LDi_timerCancelAndWait(&client->shared->timers, &client->pollTimer);
+    LDi_timerCancelAndWait(&client->shared->timers, &client->flushTimer);
+}
 
-    if (LDJSONGetType(payload) != LDObject) {
-        goto cleanup;
+void
+LDi_flushEventsOnClose(struct LDClient *const client)
+{
+    if (LDi_atomicLoad(&client->offline)) {
+        return;
     }
 
-    flagCount = LDCollectionGetSize(payload);
-
-    if (flagCount == 0) {
-        LDi_storePut(&client->store, NULL, 0);
-
-        goto cleanup;
+    /* a payload awaiting its retry gets it, then the events queued since are
+    sent with a retry of their own */
+    if (client->eventPayloadRetry) {
+        LDi_sendEventPayload(client);
     }
 
-    if (!(flags = LDAlloc(sizeof(struct LDFlag) * flagCount))) {
-        goto cleanup;
+    if (LDi_sendEventPayload(client)) {
+        LDi_sleepMilliseconds(1000);
+        LDi_sendEventPayload(client);
     }
+}
 
-    flagsIter = flags;
+/* per connection state of the streaming thread */
+struct LDStreamContext
+{
+    struct LDClient *    client;
+    /* put event whose data is still arriving */
+    struct LDFlagDecoder put;
+    LDBoolean            putActive;
+    /* patches and deletes waiting to be applied as one store update */
+    struct LDFlag *      pending;
+    unsigned int         pendingCount;
+    unsigned int         pendingCapacity;
+    double               pendingSince;
+};
 
-    for (payloadIter = LDGetIter(payload); payloadIter != NULL;
-         payloadIter = LDIterNext(payloadIter))
-    {
-        if (!LDi_flag_parse(flagsIter, LDIterKey(payloadIter), payloadIter)) {
-            goto cleanup;
-        }
+static void
+LDi_applyPut(struct LDClient *const client, struct LDFlagDecoder *const decoder)
+{
+    struct LDFlag *flags;
+    unsigned int   flagCount;
+
+    LD_ASSERT(client);
+    LD_ASSERT(decoder);
+
+    if (!LDi_flagDecoderFinish(decoder, &flags, &flagCount)) {
+        LD_LOG(LD_LOG_ERROR, "failed to parse put discarding update");
 
-        flagsIter++;
+        return;
     }
 
     LDi_storePut(&client->store, flags, flagCount);
 
+    if (flagCount == 0) {
+        return;
+    }
+
     LDi_rwlock_wrlock(&client->clientLock);
     LDi_updatestatus(client, LDStatusInitialized);
     LDi_rwlock_wrunlock(&client->clientLock);
-
-cleanup:
-    LDJSONFree(payload);
 }
 
 void
-LDi_onstreameventpatch(struct LDClient *const client, const char *const data)
+LDi_onstreameventput(struct LDClient *const client, const char *const data)
 {
-    struct LDJSON *payload;
-    struct LDFlag  flag;
+    struct LDFlagDecoder decoder;
 
     LD_ASSERT(client);
     LD_ASSERT(data);
 
-    payload = NULL;
-
-    if (!(payload = LDJSONDeserialize(data))) {
-        LD_LOG(LD_LOG_ERROR, "failed to deserialize patch discarding update");
+    LDi_flagDecoderInitialize(&decoder);
 
-        goto cleanup;
+    if (LDi_flagDecoderProcess(&decoder, data, strlen(data))) {
+        LDi_applyPut(client, &decoder);
+    } else {
+        LD_LOG(LD_LOG_ERROR, "failed to parse put discarding update");
     }
 
-    if (!LDi_flag_parse(&flag, NULL, payload)) {
-        LD_LOG(LD_LOG_ERROR, "failed to parse flag patch discarding update");
+    LDi_flagDecoderDestroy(&decoder);
+}
 
-        goto cleanup;
-    }
+/* on success the caller owns the contents of result */
+static LDBoolean
+LDi_parsePatch(const char *const data, struct LDFlag *const result)
+{
+    LD_ASSERT(data);
+    LD_ASSERT(result);
 
-    if (!LDi_storeUpsert(&client->store, flag)) {
-        LD_LOG(LD_LOG_ERROR, "failed to upsert flag");
+    if (!LDi_flagDecode(result, data, strlen(data))) {
+        LD_LOG(LD_LOG_ERROR, "failed to parse flag patch discarding update");
 
-        goto cleanup;
+        return LDBooleanFalse;
     }
 
-cleanup:
-    LDJSONFree(payload);
+    return LDBooleanTrue;
 }
 
-void
-LDi_onstreameventdelete(struct LDClient *const client, const char *const data)
+/* on success the caller owns the contents of result */
+static LDBoolean
+LDi_parseDelete(const char *const data, struct LDFlag *const result)
 {
     struct LDJSON *payload, *tmp;
     const char *   key;
     unsigned int   version;
+    LDBoolean      status;
 
-    LD_ASSERT(client);
     LD_ASSERT(data);
+    LD_ASSERT(result);
 
-    payload = NULL;
+    status = LDBooleanFalse;
 
-    if (!(payload = LDJSONDeserialize(data))) {
+    if (!(payload = LDJSONDeserializeArena(data))) {
         LD_LOG(LD_LOG_ERROR, "failed to parse delete discarding update");
 
         goto cleanup;
@@ -355,14 +380,18 @@ LDi_onstreameventdelete(struct LDClient *const client, const char *const data)
 
     key = LDGetText(tmp);
 
-    if (!LDi_storeDelete(&client->store, key, version)) {
+    if (!LDi_flag_tombstone(result, key, version)) {
         LD_LOG(LD_LOG_ERROR, "failed to delete flag");
 
         goto cleanup;
     }
 
+    status = LDBooleanTrue;
+
 cleanup:
     LDJSONFree(payload);
+
+    return status;
 }
 
 void
@@ -370,8 +399,70 @@ LDi_startstopstreaming(
     struct LDClient *const client, const LDBoolean stopstreaming)
 {
     client->shouldstopstreaming = stopstreaming;
-    LDi_cond_signal(&client->pollCond);
+    LDi_clientStateChanged(client);
+}
+
+void
+LDi_clientStateChanged(struct LDClient *const client)
+{
+    int interval;
+
+    LDi_mutex_lock(&client->condMtx);
+    LDi_atomicIncrement(&client->stateGeneration);
     LDi_cond_signal(&client->streamCond);
+    LDi_mutex_unlock(&client->condMtx);
+
+    /* a pending poll or delivery keeps its deadline, so that frequent state
+    changes cannot postpone it. Neither is enabled once the client is shutting
+    down, a status it never leaves. */
+    if (LDi_pollingEnabled(client, &interval)) {
+        /* the first poll after connecting is immediate */
+        LDi_timerStartBefore(
+            &client->shared->timers,
+            &client->pollTimer,
+            LDi_atomicLoad(&client->status) == LDStatusInitializing
+                ? 0
+                : interval);
+    } else {
+        LDi_timerCancel(&client->shared->timers, &client->pollTimer);
+    }
+
+    if (LDi_eventDeliveryEnabled(client)) {
+        LDi_timerStartIfIdle(
+            &client->shared->timers,
+            &client->flushTimer,
+            client->shared->sharedConfig->eventsFlushIntervalMillis);
+    } else {
+        LDi_timerCancel(&client->shared->timers, &client->flushTimer);
+    }
+}
+
+LDBoolean
+LDi_awaitStateChange(
+    struct LDClient *const client,
+    ld_cond_t *const       cond,
+    const long             generation,
+    const int              milliseconds)
+{
+    LDBoolean changed;
+
+    LDi_mutex_lock(&client->condMtx);
+
+    changed = LDi_atomicLoad(&client->stateGeneration) != generation;
+
+    if (!changed) {
+        /* only an untimed wait ignores other signals, a timed wait is also
+        ended by requests such as a flush */
+        do {
+            LDi_cond_wait(cond, &client->condMtx, milliseconds);
+
+            changed = LDi_atomicLoad(&client->stateGeneration) != generation;
+        } while (!changed && milliseconds == LD_WAIT_FOREVER);
+    }
+
+    LDi_mutex_unlock(&client->condMtx);
+
+    return changed;
 }
 
 static void
@@ -394,30 +485,186 @@ LDi_reinitializeconnection(struct LDClient *const client)
         LDi_cancelread(socketHandle);
         LDi_socketClose(&client->streamhandle);
     }
-    LDi_cond_signal(&client->pollCond);
-    LDi_cond_signal(&client->streamCond);
+    LDi_clientStateChanged(client);
+}
+
+static void
+LDi_queueUpdate(struct LDStreamContext *const context, struct LDFlag flag)
+{
+    LD_ASSERT(context);
+
+    if (context->pendingCount == context->pendingCapacity) {
+        struct LDFlag *pendingTmp;
+        unsigned int   capacity;
+
+        capacity = context->pendingCapacity ? context->pendingCapacity * 2 : 16;
+
+        if (!(pendingTmp = (struct LDFlag *)LDRealloc(
+                  context->pending, sizeof(struct LDFlag) * capacity)))
+        {
+            LD_LOG(LD_LOG_ERROR, "failed to queue flag update");
+
+            LDi_flag_destroy(&flag);
+
+            return;
+        }
+
+        context->pending         = pendingTmp;
+        context->pendingCapacity = capacity;
+    }
+
+    if (context->pendingCount == 0) {
+        LDi_getMonotonicMilliseconds(&context->pendingSince);
+    }
+
+    context->pending[context->pendingCount++] = flag;
+}
+
+static void
+LDi_flushUpdates(struct LDStreamContext *const context)
+{
+    LD_ASSERT(context);
+
+    if (context->pendingCount == 0) {
+        return;
+    }
+
+    if (!LDi_storeUpsertBatch(
+            &context->client->store, context->pending, context->pendingCount))
+    {
+        LD_LOG(LD_LOG_ERROR, "failed to upsert flags");
+    }
+
+    context->pendingCount = 0;
+}
+
+/* called by the reader after each network read, and periodically while the
+connection is idle */
+static void
+LDi_onStreamRead(void *const rawContext)
+{
+    struct LDStreamContext *context;
+    unsigned int            windowMicros;
+
+    LD_ASSERT(rawContext);
+
+    context = (struct LDStreamContext *)rawContext;
+
+    if (context->pendingCount == 0) {
+        return;
+    }
+
+    windowMicros = context->client->shared->sharedConfig->patchCoalescingMicros;
+
+    if (windowMicros) {
+        double now;
+
+        LDi_getMonotonicMilliseconds(&now);
+
+        if ((now - context->pendingSince) * 1000 < windowMicros) {
+            return;
+        }
+    }
+
+    LDi_flushUpdates(context);
+}
+
+/* put events are decoded as their data arrives instead of being buffered */
+static LDBoolean
+LDi_onStreamBegin(
+    const char *const eventName,
+    const size_t      eventNameSize,
+    void *const       rawContext)
+{
+    struct LDStreamContext *context;
+
+    (void)eventNameSize;
+
+    LD_ASSERT(eventName);
+    LD_ASSERT(rawContext);
+
+    context = (struct LDStreamContext *)rawContext;
+
+    if (strcmp(eventName, "put") != 0) {
+        return LDBooleanFalse;
+    }
+
+    if (context->putActive) {
+        LDi_flagDecoderDestroy(&context->put);
+    }
+
+    LDi_flagDecoderInitialize(&context->put);
+
+    context->putActive = LDBooleanTrue;
+
+    return LDBooleanTrue;
+}
+
+static LDBoolean
+LDi_onStreamData(
+    const char *const data, const size_t dataSize, void *const rawContext)
+{
+    struct LDStreamContext *context;
+
+    LD_ASSERT(data);
+    LD_ASSERT(rawContext);
+
+    context = (struct LDStreamContext *)rawContext;
+
+    LD_ASSERT(context->putActive);
+
+    /* a malformed put is reported and discarded once it is complete, the
+    connection itself is still usable */
+    LDi_flagDecoderProcess(&context->put, data, dataSize);
+
+    return LDBooleanTrue;
 }
 
 static LDBoolean
 LDi_onEvent(
     const char *const eventName,
+    const size_t      eventNameSize,
     const char *const eventBuffer,
+    const size_t      eventBufferSize,
     void *const       rawContext)
 {
-    struct LDClient *client;
+    struct LDStreamContext *context;
+    struct LDClient *       client;
+
+    (void)eventNameSize;
+    (void)eventBufferSize;
 
     LD_ASSERT(eventName);
     LD_ASSERT(eventBuffer);
     LD_ASSERT(rawContext);
 
-    client = (struct LDClient *)rawContext;
+    context = (struct LDStreamContext *)rawContext;
+    client  = context->client;
 
     if (strcmp(eventName, "put") == 0) {
-        LDi_onstreameventput(client, eventBuffer);
+        /* updates that came before the put must not be applied after it */
+        LDi_flushUpdates(context);
+
+        if (context->putActive) {
+            LDi_applyPut(client, &context->put);
+            LDi_flagDecoderDestroy(&context->put);
+
+            context->putActive = LDBooleanFalse;
+        } else {
+            LDi_onstreameventput(client, eventBuffer);
+        }
     } else if (strcmp(eventName, "patch") == 0) {
-        LDi_onstreameventpatch(client, eventBuffer);
+        struct LDFlag flag;
+
+        if (LDi_parsePatch(eventBuffer, &flag)) {
+            LDi_queueUpdate(context, flag);
+        }
     } else if (strcmp(eventName, "delete") == 0) {
-        LDi_onstreameventdelete(client, eventBuffer);
+        struct LDFlag flag;
+
+        if (LDi_parseDelete(eventBuffer, &flag)) {
+            LDi_queueUpdate(context, flag);
+        }
     } else {
         LD_LOG_1(LD_LOG_ERROR, "sse unknown event name: %s", eventName);
     }
@@ -463,60 +710,82 @@ LDi_bgfeaturestreamer(void *const v)
 
     while (LDBooleanTrue) {
         time_t    startedOn;
-        long       response;
+        long      response, generation;
+        LDStatus  status;
         LDBoolean intentionallyClosed;
 
+        generation = LDi_atomicLoad(&client->stateGeneration);
+
         /* Wait on any retry delays required. Status change such as shut down
         will cause a short circuit */
         if (retries) {
-            LDi_mutex_lock(&client->condMtx);
-            LDi_cond_wait(
-                &client->streamCond,
-                &client->condMtx,
-                LDi_calculateStreamDelay(retries));
-            LDi_mutex_unlock(&client->condMtx);
+            const double delay = LDi_calculateStreamDelay(retries);
+
+            LDi_atomicIncrement(&client->counters.streamReconnects);
+            LDi_atomicStore(
+                &client->counters.lastStreamBackoffMilliseconds, (long)delay);
+
+            LDi_awaitStateChange(
+                client, &client->streamCond, generation, (int)delay);
         }
 
-        LDi_rwlock_wrlock(&client->clientLock);
+        status = (LDStatus)LDi_atomicLoad(&client->status);
 
         /* Handle shutdown if initialized */
-        if (client->status == LDStatusFailed ||
-            client->status == LDStatusShuttingdown) {
+        if (status == LDStatusFailed || status == LDStatusShuttingdown) {
             LD_LOG(LD_LOG_TRACE, "killing thread LDi_bgfeaturestreamer");
 
-            LDi_rwlock_wrunlock(&client->clientLock);
-
             return THREAD_RETURN_DEFAULT;
         }
 
-        /* If we are actually not supposed to be streaming just wait */
-        if (!client->shared->sharedConfig->streaming || client->offline ||
-            client->background)
+        /* If we are actually not supposed to be streaming wait until that
+        changes */
+        if (!client->shared->sharedConfig->streaming ||
+            LDi_atomicLoad(&client->offline) ||
+            LDi_atomicLoad(&client->background))
         {
             /* Ensures we skip directly to shutdown handler */
             retries = 0;
 
-            LDi_mutex_lock(&client->condMtx);
-            LDi_rwlock_wrunlock(&client->clientLock);
-            LDi_cond_wait(&client->streamCond, &client->condMtx, 1000);
-            LDi_mutex_unlock(&client->condMtx);
+            LDi_awaitStateChange(
+                client, &client->streamCond, generation, LD_WAIT_FOREVER);
 
             continue;
         }
 
-        LDi_rwlock_wrunlock(&client->clientLock);
-
         startedOn = time(NULL);
 
         {
-            struct LDSSEParser parser;
+            struct LDSSEParser     parser;
+            struct LDStreamContext context;
 
-            LDSSEParserInitialize(&parser, LDi_onEvent, (void *)client);
+            context.client          = client;
+            context.putActive       = LDBooleanFalse;
+            context.pending         = NULL;
+            context.pendingCount    = 0;
+            context.pendingCapacity = 0;
+
+            LDSSEParserInitialize(&parser, LDi_onEvent, (void *)&context);
+            LDSSEParserSetStreaming(
+                &parser, LDi_onStreamBegin, LDi_onStreamData);
 
             /* this won't return until it disconnects */
-            LDi_readstream(client, &response, &parser, LDi_updatehandle);
+            LDi_readstream(
+                client,
+                &response,
+                &parser,
+                LDi_updatehandle,
+                LDi_onStreamRead);
 
             LDSSEParserDestroy(&parser);
+
+            LDi_flushUpdates(&context);
+            LDFree(context.pending);
+
+            /* connection dropped part way through a put */
+            if (context.putActive) {
+                LDi_flagDecoderDestroy(&context.put);
+            }
         }
 
         if (response == CURLE_COULDNT_RESOLVE_HOST) {
@@ -42,6 +42,7 @@ LDi_initializerng(void)
 {
 #ifndef _WINDOWS
     LDi_mutex_init(&LDi_rngmtx);
+    LDi_lockProfileLabel(&LDi_rngmtx, "random");
     LDi_rngstate = time(NULL);
 #endif
 }
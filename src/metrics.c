@@ -0,0 +1,437 @@
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+
+#include "ldinternal.h"
+#include "number_format.h"
+
+/* Renders LDClientStats and the evaluation latency histograms of every
+environment in the OpenMetrics text format. Each family is written once with
+a sample per environment, as the format requires the samples of a family to
+be contiguous. Everything is read through LDClientGetStats and the atomic
+histogram buckets, so a scrape takes no lock and allocates nothing. */
+
+struct LDMetricsWriter
+{
+    char * buffer;
+    size_t capacity;
+    /* of the complete text, which may exceed capacity */
+    size_t length;
+};
+
+/* a family with one sample per environment for each field, distinguished by
+a label when there is more than one */
+struct LDMetricFamily
+{
+    const char * name;
+    const char * type;
+    /* NULL if the family has no unit */
+    const char * unit;
+    const char * help;
+    const char * label;
+    const char * labelValues[4];
+    size_t       fields[4];
+    unsigned int fieldCount;
+    /* the field is divided by it, 1 for counts which are written as integers
+    and 1000 for milliseconds written as seconds */
+    unsigned int divisor;
+};
+
+#define LD_METRIC_FIELD(field) offsetof(struct LDClientStats, field)
+
+static const struct LDMetricFamily families[] = {
+    {"launchdarkly_evaluations",
+     "counter",
+     NULL,
+     "Flag evaluations by requested type",
+     "type",
+     {"bool", "number", "string", "json"},
+     {LD_METRIC_FIELD(boolEvaluations),
+      LD_METRIC_FIELD(numberEvaluations),
+      LD_METRIC_FIELD(stringEvaluations),
+      LD_METRIC_FIELD(jsonEvaluations)},
+     4,
+     1},
+    {"launchdarkly_evaluation_errors",
+     "counter",
+     NULL,
+     "Evaluations that returned the fallback value",
+     "reason",
+     {"flag_not_found", "wrong_type"},
+     {LD_METRIC_FIELD(flagNotFound), LD_METRIC_FIELD(wrongType)},
+     2,
+     1},
+    {"launchdarkly_events_queued",
+     "counter",
+     NULL,
+     "Analytics events accepted into the queue",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(eventsQueued)},
+     1,
+     1},
+    {"launchdarkly_events_dropped",
+     "counter",
+     NULL,
+     "Analytics events discarded because the queue was full",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(eventsDropped)},
+     1,
+     1},
+    {"launchdarkly_events_flushed",
+     "counter",
+     NULL,
+     "Analytics events delivered, including summary events",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(eventsFlushed)},
+     1,
+     1},
+    {"launchdarkly_event_flushes",
+     "counter",
+     NULL,
+     "Successful event deliveries",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(flushes)},
+     1,
+     1},
+    {"launchdarkly_event_flush_duration_seconds",
+     "gauge",
+     "seconds",
+     "Duration of the most recent successful event delivery",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(lastFlushMilliseconds)},
+     1,
+     1000},
+    {"launchdarkly_sent_bytes",
+     "counter",
+     "bytes",
+     "Event payload bytes delivered",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(bytesSent)},
+     1,
+     1},
+    {"launchdarkly_received_bytes",
+     "counter",
+     "bytes",
+     "Flag data bytes received by polling and streaming",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(bytesReceived)},
+     1,
+     1},
+    {"launchdarkly_stream_reconnects",
+     "counter",
+     NULL,
+     "Stream connection attempts after a failure",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(streamReconnects)},
+     1,
+     1},
+    {"launchdarkly_stream_backoff_seconds",
+     "gauge",
+     "seconds",
+     "Delay before the most recent stream reconnection",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(lastStreamBackoffMilliseconds)},
+     1,
+     1000},
+    {"launchdarkly_store_flags",
+     "gauge",
+     NULL,
+     "Flags in the store, including deleted flags retained to order updates",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(storeSize)},
+     1,
+     1},
+    {"launchdarkly_store_changes",
+     "counter",
+     NULL,
+     "Changes applied to the store",
+     NULL,
+     {NULL},
+     {LD_METRIC_FIELD(storeGeneration)},
+     1,
+     1}};
+
+/* histogram bounds as exponents of two nanoseconds, from 256ns to 1s */
+static const unsigned int latencyExponents[] = {
+    8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30};
+
+#define LD_LATENCY_BOUND_COUNT                                                 \
+    (sizeof(latencyExponents) / sizeof(latencyExponents[0]))
+
+static const char *const latencyTypes[LDLatencyKindCount] = {
+    "bool", "number", "string", "json"};
+
+static void
+LDi_metricsAppend(
+    struct LDMetricsWriter *const writer, const char *const format, ...)
+{
+    va_list va;
+    size_t  room;
+    int     written;
+
+    room = writer->length < writer->capacity
+        ? writer->capacity - writer->length
+        : 0;
+
+    va_start(va, format);
+    written = vsnprintf(
+        room ? writer->buffer + writer->length : NULL, room, format, va);
+    va_end(va);
+
+    if (written > 0) {
+        writer->length += (size_t)written;
+    }
+}
+
+/* a label value, escaped as the format requires */
+static void
+LDi_metricsAppendLabel(
+    struct LDMetricsWriter *const writer,
+    const char *const             text,
+    const size_t                  length)
+{
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        switch (text[i]) {
+        case '\\':
+            LDi_metricsAppend(writer, "\\\\");
+            break;
+        case '"':
+            LDi_metricsAppend(writer, "\\\"");
+            break;
+        case '\n':
+            LDi_metricsAppend(writer, "\\n");
+            break;
+        default:
+            LDi_metricsAppend(writer, "%c", text[i]);
+            break;
+        }
+    }
+}
+
+/* every environment configured with client, in table order, or the client
+alone if it is not in the table */
+static struct LDClient *
+LDi_metricsFirstEnvironment(struct LDClient *const client)
+{
+    return client->shared->clientTable ? client->shared->clientTable : client;
+}
+
+static struct LDClient *
+LDi_metricsNextEnvironment(
+    struct LDClient *const client, struct LDClient *const environment)
+{
+    if (!client->shared->clientTable) {
+        return NULL;
+    }
+
+    return (struct LDClient *)environment->hh.next;
+}
+
+/* the start of a sample through the environment label */
+static void
+LDi_metricsAppendSample(
+    struct LDMetricsWriter *const writer,
+    const char *const             name,
+    const char *const             suffix,
+    struct LDClient *const        environment)
+{
+    LDi_metricsAppend(writer, "%s%s{environment=\"", name, suffix);
+
+    if (environment->hh.key) {
+        LDi_metricsAppendLabel(
+            writer,
+            (const char *)environment->hh.key,
+            environment->hh.keylen);
+    } else {
+        LDi_metricsAppendLabel(
+            writer,
+            LDPrimaryEnvironmentName,
+            strlen(LDPrimaryEnvironmentName));
+    }
+
+    LDi_metricsAppend(writer, "\"");
+}
+
+static void
+LDi_metricsAppendFamily(
+    struct LDMetricsWriter *const      writer,
+    struct LDClient *const             client,
+    const struct LDMetricFamily *const family)
+{
+    struct LDClient *environment;
+    const char *     suffix;
+    char             number[LD_NUMBER_FORMAT_SIZE];
+
+    suffix = strcmp(family->type, "counter") == 0 ? "_total" : "";
+
+    LDi_metricsAppend(writer, "# TYPE %s %s\n", family->name, family->type);
+
+    if (family->unit) {
+        LDi_metricsAppend(writer, "# UNIT %s %s\n", family->name, family->unit);
+    }
+
+    LDi_metricsAppend(writer, "# HELP %s %s.\n", family->name, family->help);
+
+    for (environment = LDi_metricsFirstEnvironment(client); environment;
+         environment = LDi_metricsNextEnvironment(client, environment))
+    {
+        struct LDClientStats stats;
+        unsigned int         i;
+
+        if (!LDClientGetStats(environment, &stats)) {
+            continue;
+        }
+
+        for (i = 0; i < family->fieldCount; i++) {
+            const unsigned long value = *(const unsigned long *)(
+                (const char *)&stats + family->fields[i]);
+
+            LDi_metricsAppendSample(writer, family->name, suffix, environment);
+
+            if (family->label) {
+                LDi_metricsAppend(
+                    writer,
+                    ",%s=\"%s\"",
+                    family->label,
+                    family->labelValues[i]);
+            }
+
+            if (family->divisor == 1) {
+                LDi_metricsAppend(writer, "} %lu\n", value);
+            } else {
+                LDi_formatNumber((double)value / family->divisor, number);
+
+                LDi_metricsAppend(writer, "} %s\n", number);
+            }
+        }
+    }
+}
+
+static void
+LDi_metricsAppendLatency(
+    struct LDMetricsWriter *const writer, struct LDClient *const client)
+{
+    const char *const name = "launchdarkly_evaluation_duration_seconds";
+    struct LDClient * environment;
+    LDBoolean         sampled;
+    char              number[LD_NUMBER_FORMAT_SIZE];
+
+    sampled = LDBooleanFalse;
+
+    for (environment = LDi_metricsFirstEnvironment(client); environment;
+         environment = LDi_metricsNextEnvironment(client, environment))
+    {
+        sampled = sampled || environment->latency != NULL;
+    }
+
+    if (!sampled) {
+        return;
+    }
+
+    LDi_metricsAppend(writer, "# TYPE %s histogram\n", name);
+    LDi_metricsAppend(writer, "# UNIT %s seconds\n", name);
+    LDi_metricsAppend(
+        writer, "# HELP %s Sampled flag evaluation durations.\n", name);
+
+    for (environment = LDi_metricsFirstEnvironment(client); environment;
+         environment = LDi_metricsNextEnvironment(client, environment))
+    {
+        unsigned int kind;
+
+        if (!environment->latency) {
+            continue;
+        }
+
+        for (kind = 0; kind < LDLatencyKindCount; kind++) {
+            unsigned long below[LD_LATENCY_BOUND_COUNT], total;
+            unsigned int  bound;
+
+            LDi_latencyCumulative(
+                &environment->latency[kind],
+                latencyExponents,
+                LD_LATENCY_BOUND_COUNT,
+                below,
+                &total);
+
+            /* durations are whole nanoseconds, so those below two to the
+            exponent are exactly those at most one less */
+            for (bound = 0; bound < LD_LATENCY_BOUND_COUNT; bound++) {
+                LDi_formatNumber(
+                    (ldexp(1, latencyExponents[bound]) - 1) / 1e9, number);
+
+                LDi_metricsAppendSample(writer, name, "_bucket", environment);
+                LDi_metricsAppend(
+                    writer,
+                    ",type=\"%s\",le=\"%s\"} %lu\n",
+                    latencyTypes[kind],
+                    number,
+                    below[bound]);
+            }
+
+            LDi_metricsAppendSample(writer, name, "_bucket", environment);
+            LDi_metricsAppend(
+                writer,
+                ",type=\"%s\",le=\"+Inf\"} %lu\n",
+                latencyTypes[kind],
+                total);
+        }
+    }
+}
+
+size_t
+LDClientWriteMetrics(
+    struct LDClient *const client, char *const buffer, const size_t capacity)
+{
+    struct LDMetricsWriter writer;
+    unsigned int           i;
+
+    LD_ASSERT_API(client);
+    LD_ASSERT_API(buffer || capacity == 0);
+
+#ifdef LAUNCHDARKLY_DEFENSIVE
+    if (client == NULL) {
+        LD_LOG(LD_LOG_WARNING, "LDClientWriteMetrics NULL client");
+
+        return 0;
+    }
+
+    if (buffer == NULL && capacity != 0) {
+        LD_LOG(LD_LOG_WARNING, "LDClientWriteMetrics NULL buffer");
+
+        return 0;
+    }
+#endif
+
+    writer.buffer   = buffer;
+    writer.capacity = capacity;
+    writer.length   = 0;
+
+    if (capacity) {
+        buffer[0] = '\0';
+    }
+
+    for (i = 0; i < sizeof(families) / sizeof(families[0]); i++) {
+        LDi_metricsAppendFamily(&writer, client, &families[i]);
+    }
+
+    LDi_metricsAppendLatency(&writer, client);
+
+    LDi_metricsAppend(&writer, "# EOF\n");
+
+    return writer.length;
+}
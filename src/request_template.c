@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <launchdarkly/api.h>
+#include <launchdarkly/memory.h>
+
+#include "assertion.h"
+#include "buffer.h"
+#include "ldinternal.h"
+#include "request_template.h"
+
+#define LD_USER_AGENT_HEADER "User-Agent: CClient/" LD_SDK_VERSION
+#define LD_AUTHORIZATION_HEADER "Authorization: "
+#define LD_CONTENT_TYPE_HEADER "Content-Type: application/json"
+#define LD_EVENT_SCHEMA_HEADER "X-LaunchDarkly-Event-Schema: 3"
+#define LD_WITH_REASONS "?withReasons=true"
+
+static void
+LDi_requestTemplateDestroy(void *const rawTemplate)
+{
+    struct LDRequestTemplate *requestTemplate;
+
+    requestTemplate = (struct LDRequestTemplate *)rawTemplate;
+
+    if (requestTemplate) {
+        LDi_rc_destroy(&requestTemplate->rc);
+        LDFree(requestTemplate->pollURL);
+        LDFree(requestTemplate->streamURL);
+        LDFree(requestTemplate->eventsURL);
+        LDFree(requestTemplate->reportBody);
+        curl_slist_free_all(requestTemplate->flagHeaders);
+        curl_slist_free_all(requestTemplate->eventHeaders);
+        LDFree(requestTemplate);
+    }
+}
+
+/* concatenates base, path, and the optional user and reasons suffixes */
+static char *
+LDi_buildURL(
+    const char *const base,
+    const char *const path,
+    const char *const encodedUser,
+    const LDBoolean   withReasons)
+{
+    char * url;
+    size_t size;
+
+    size = strlen(base) + strlen(path) + 1;
+
+    if (encodedUser) {
+        size += strlen(encodedUser) + 1;
+    }
+
+    if (withReasons) {
+        size += sizeof(LD_WITH_REASONS) - 1;
+    }
+
+    if (!(url = (char *)LDAlloc(size))) {
+        return NULL;
+    }
+
+    if (snprintf(
+            url,
+            size,
+            "%s%s%s%s%s",
+            base,
+            path,
+            encodedUser ? "/" : "",
+            encodedUser ? encodedUser : "",
+            withReasons ? LD_WITH_REASONS : "") < 0)
+    {
+        LDFree(url);
+
+        return NULL;
+    }
+
+    return url;
+}
+
+/* returns LDBooleanFalse on failure, the list is freed */
+static LDBoolean
+LDi_appendHeader(struct curl_slist **const headers, const char *const header)
+{
+    struct curl_slist *headersTmp;
+
+    if (!(headersTmp = curl_slist_append(*headers, header))) {
+        curl_slist_free_all(*headers);
+        *headers = NULL;
+
+        return LDBooleanFalse;
+    }
+
+    *headers = headersTmp;
+
+    return LDBooleanTrue;
+}
+
+static struct curl_slist *
+LDi_buildHeaders(
+    const char *const authorization, const char *const contentType)
+{
+    struct curl_slist *headers;
+
+    headers = NULL;
+
+    if (!LDi_appendHeader(&headers, authorization)) {
+        return NULL;
+    }
+
+    if (!LDi_appendHeader(&headers, LD_USER_AGENT_HEADER)) {
+        return NULL;
+    }
+
+    if (contentType && !LDi_appendHeader(&headers, contentType)) {
+        return NULL;
+    }
+
+    return headers;
+}
+
+struct LDRequestTemplate *
+LDi_requestTemplateNew(
+    const struct LDConfig *const config,
+    const char *const            mobileKey,
+    const struct LDUser *const   user)
+{
+    struct LDRequestTemplate *requestTemplate;
+    struct LDJSON *           userJSON;
+    struct LDBuffer *         userBuffer;
+    char *                    userJSONText, *authorization;
+    unsigned char *           encodedUser;
+    size_t userJSONTextSize, encodedUserSize, authorizationSize;
+
+    LD_ASSERT(config);
+    LD_ASSERT(mobileKey);
+    LD_ASSERT(user);
+
+    requestTemplate  = NULL;
+    userJSONText     = NULL;
+    userJSONTextSize = 0;
+    authorization    = NULL;
+    encodedUser      = NULL;
+
+    if (!(requestTemplate = (struct LDRequestTemplate *)LDAlloc(
+              sizeof(struct LDRequestTemplate))))
+    {
+        LD_LOG(LD_LOG_CRITICAL, "no memory for request template");
+
+        return NULL;
+    }
+
+    memset(requestTemplate, 0, sizeof(struct LDRequestTemplate));
+
+    if (!LDi_rc_initialize(
+            &requestTemplate->rc,
+            (void *)requestTemplate,
+            LDi_requestTemplateDestroy))
+    {
+        LDFree(requestTemplate);
+
+        return NULL;
+    }
+
+    if (!(userJSON = LDi_userToJSON(
+              user, LDBooleanFalse, LDBooleanFalse, NULL)))
+    {
+        LD_LOG(LD_LOG_CRITICAL, "failed to convert user to user");
+
+        goto error;
+    }
+
+    if ((userBuffer = LDBufferNew())) {
+        if (LDJSONSerializeTo(userJSON, userBuffer)) {
+            userJSONTextSize = LDBufferSize(userBuffer);
+            userJSONText     = LDi_bufferDetach(userBuffer);
+        }
+
+        LDBufferFree(userBuffer);
+    }
+
+    LDJSONFree(userJSON);
+
+    if (!userJSONText) {
+        LD_LOG(LD_LOG_CRITICAL, "failed to serialize user");
+
+        goto error;
+    }
+
+    if (!config->useReport) {
+        if (!(encodedUser = LDi_base64_encode(
+                  (unsigned char *)userJSONText,
+                  userJSONTextSize,
+                  &encodedUserSize)))
+        {
+            LD_LOG(LD_LOG_CRITICAL, "failed to base64 encode user");
+
+            goto error;
+        }
+    }
+
+    if (!(requestTemplate->pollURL = LDi_buildURL(
+              config->appURI,
+              encodedUser ? "/msdk/evalx/users" : "/msdk/evalx/user",
+              (const char *)encodedUser,
+              config->useReasons)))
+    {
+        goto error;
+    }
+
+    if (!(requestTemplate->streamURL = LDi_buildURL(
+              config->streamURI,
+              "/meval",
+              (const char *)encodedUser,
+              config->useReasons)))
+    {
+        goto error;
+    }
+
+    if (!(requestTemplate->eventsURL = LDi_buildURL(
+              config->eventsURI, "/mobile", NULL, LDBooleanFalse)))
+    {
+        goto error;
+    }
+
+    authorizationSize = sizeof(LD_AUTHORIZATION_HEADER) + strlen(mobileKey);
+
+    if (!(authorization = (char *)LDAlloc(authorizationSize))) {
+        goto error;
+    }
+
+    if (snprintf(
+            authorization,
+            authorizationSize,
+            "%s%s",
+            LD_AUTHORIZATION_HEADER,
+            mobileKey) < 0)
+    {
+        goto error;
+    }
+
+    if (!(requestTemplate->flagHeaders = LDi_buildHeaders(
+              authorization,
+              config->useReport ? LD_CONTENT_TYPE_HEADER : NULL)))
+    {
+        goto error;
+    }
+
+    if (!(requestTemplate->eventHeaders =
+              LDi_buildHeaders(authorization, LD_CONTENT_TYPE_HEADER)))
+    {
+        goto error;
+    }
+
+    if (!LDi_appendHeader(
+            &requestTemplate->eventHeaders, LD_EVENT_SCHEMA_HEADER))
+    {
+        goto error;
+    }
+
+    if (config->useReport) {
+        requestTemplate->reportBody     = userJSONText;
+        requestTemplate->reportBodySize = userJSONTextSize;
+        userJSONText                    = NULL;
+    }
+
+    LDFree(authorization);
+    LDFree(encodedUser);
+    LDFree(userJSONText);
+
+    return requestTemplate;
+
+error:
+    LD_LOG(LD_LOG_CRITICAL, "failed to build request template");
+
+    LDFree(authorization);
+    LDFree(encodedUser);
+    LDFree(userJSONText);
+    LDi_requestTemplateDestroy(requestTemplate);
+
+    return NULL;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <launchdarkly/boolean.h>
+
+#include "config.h"
+#include "reference_count.h"
+#include "user.h"
+
+/* Everything describing the requests a client makes that only changes when
+the user is identified. Built once so that polling, reconnecting, and sending
+events allocate nothing to describe the request. Shared between threads by
+reference count, a template in use by a request in flight outlives the
+identify that replaced it. Immutable after construction. */
+struct LDRequestTemplate
+{
+    struct ld_rc_t     rc;
+    char *             pollURL;
+    char *             streamURL;
+    char *             eventsURL;
+    /* serialized user for REPORT requests, NULL when users are in the URL */
+    char *             reportBody;
+    size_t             reportBodySize;
+    /* headers for fetching and streaming flags */
+    struct curl_slist *flagHeaders;
+    /* headers for sending events, without the payload ID */
+    struct curl_slist *eventHeaders;
+};
+
+/* returned with a reference count of one, returns NULL on failure */
+struct LDRequestTemplate *
+LDi_requestTemplateNew(
+    const struct LDConfig *const config,
+    const char *const            mobileKey,
+    const struct LDUser *const   user);
@@ -13,6 +13,8 @@ LDi_destroyStoreNode(void *const nodeRaw)
 
     if (node) {
         LDi_rc_destroy(&node->rc);
+        LDi_flagKeyRelease(node->flag.key);
+        node->flag.key = NULL;
         LDi_flag_destroy(&node->flag);
         LDFree(nodeRaw);
     }
@@ -39,6 +41,8 @@ LDi_storeFreeFlags(struct LDStore *const store)
     LDi_storeFreeHash(store->flags);
 
     store->flags = NULL;
+
+    LDi_atomicStore(&store->size, 0);
 }
 
 LDBoolean
@@ -46,12 +50,22 @@ LDi_storeInitialize(struct LDStore *const store)
 {
     LD_ASSERT(store);
 
+    if (!LDi_flagKeyTableInitialize(&store->keys)) {
+        return LDBooleanFalse;
+    }
+
     if (!LDi_rwlock_init(&store->lock)) {
+        LDi_flagKeyTableDestroy(&store->keys);
+
         return LDBooleanFalse;
     }
 
+    LDi_lockProfileLabel(&store->lock, "store");
+
     store->flags       = NULL;
     store->initialized = LDBooleanFalse;
+    store->generation  = 0;
+    store->size        = 0;
 
     LDi_initListeners(&store->listeners);
 
@@ -65,25 +79,48 @@ LDi_storeDestroy(struct LDStore *const store)
         LDi_storeFreeHash(store->flags);
         LDi_rwlock_destroy(&store->lock);
         LDi_freeListeners(&store->listeners);
+        LDi_flagKeyTableDestroy(&store->keys);
     }
 }
 
+/* on success the node owns the contents of flag, otherwise the caller does */
 static struct LDStoreNode *
-LDi_allocateStoreNode(struct LDFlag flag)
+LDi_allocateStoreNode(struct LDStore *const store, struct LDFlag flag)
 {
     struct LDStoreNode *node;
+    const char *        key;
+
+    if (!(key = LDi_flagKeyIntern(&store->keys, flag.key))) {
+        return NULL;
+    }
 
     if (!(node = LDAlloc(sizeof(struct LDStoreNode)))) {
+        LDi_flagKeyRelease(key);
+
         return NULL;
     }
 
     if (!LDi_rc_initialize(&node->rc, (void *)node, LDi_destroyStoreNode)) {
+        LDi_flagKeyRelease(key);
         LDFree(node);
 
         return NULL;
     }
 
-    node->flag = flag;
+    LDFree(flag.key);
+
+    node->flag     = flag;
+    node->flag.key = (char *)key;
+
+    /* evaluations and events duplicate these constantly, share them instead.
+    Failing to freeze only means duplicates are deep copies. */
+    if (node->flag.value) {
+        LDJSONFreeze(node->flag.value);
+    }
+
+    if (node->flag.reason) {
+        LDJSONFreeze(node->flag.reason);
+    }
 
     return node;
 }
@@ -98,17 +135,58 @@ LDi_fireListenersFor(
     LDi_listenersDispatch(store->listeners, key, deleted);
 }
 
+/* expects the write lock, returns true if the node replaced the current state
+of the flag, in which case the store owns the node */
+static LDBoolean
+LDi_storeApplyLocked(struct LDStore *const store, struct LDStoreNode *const node)
+{
+    struct LDStoreNode *existing;
+
+    LD_ASSERT(store);
+    LD_ASSERT(node);
+
+    HASH_FIND_BYHASHVALUE(
+        hh,
+        store->flags,
+        node->flag.key,
+        LDi_flagKeyLength(node->flag.key),
+        LDi_flagKeyHash(node->flag.key),
+        existing);
+
+    if (existing && node->flag.version < existing->flag.version) {
+        return LDBooleanFalse;
+    }
+
+    if (existing) {
+        HASH_DEL(store->flags, existing);
+        LDi_rc_decrement(&existing->rc);
+    }
+
+    HASH_ADD_KEYPTR_BYHASHVALUE(
+        hh,
+        store->flags,
+        node->flag.key,
+        LDi_flagKeyLength(node->flag.key),
+        LDi_flagKeyHash(node->flag.key),
+        node);
+
+    LDi_atomicIncrement(&store->generation);
+    LDi_atomicStore(&store->size, (long)HASH_COUNT(store->flags));
+
+    return LDBooleanTrue;
+}
+
 LDBoolean
 LDi_storeUpsert(struct LDStore *const store, struct LDFlag flag)
 {
-    struct LDStoreNode *existing, *replacement;
+    struct LDStoreNode *replacement;
 
     LD_ASSERT(store);
     LD_ASSERT(flag.key);
 
     /* Allocate before lock even though it may be throw away to reduce lock
     contention as old flags should be rare */
-    if (!(replacement = LDi_allocateStoreNode(flag))) {
+    if (!(replacement = LDi_allocateStoreNode(store, flag))) {
         LDi_flag_destroy(&flag);
 
         return LDBooleanFalse;
@@ -116,25 +194,108 @@ LDi_storeUpsert(struct LDStore *const store, struct LDFlag flag)
 
     LDi_rwlock_wrlock(&store->lock);
 
-    HASH_FIND_STR(store->flags, flag.key, existing);
+    if (LDi_storeApplyLocked(store, replacement)) {
+        LDi_fireListenersFor(
+            store, replacement->flag.key, replacement->flag.deleted);
+    } else {
+        LDi_destroyStoreNode(replacement);
+    }
+
+    LDi_rwlock_wrunlock(&store->lock);
+
+    return LDBooleanTrue;
+}
+
+LDBoolean
+LDi_storeUpsertBatch(
+    struct LDStore *const store,
+    struct LDFlag *const  flags,
+    const unsigned int    flagCount)
+{
+    unsigned int         i;
+    LDBoolean            failed;
+    struct LDStoreNode **nodes;
+
+    LD_ASSERT(store);
+    LD_ASSERT(flags || flagCount == 0);
+
+    failed = LDBooleanFalse;
+
+    if (flagCount == 0) {
+        return LDBooleanTrue;
+    }
+
+    if (!(nodes = (struct LDStoreNode **)LDAlloc(
+              sizeof(struct LDStoreNode *) * flagCount)))
+    {
+        for (i = 0; i < flagCount; i++) {
+            LDi_flag_destroy(&flags[i]);
+        }
+
+        return LDBooleanFalse;
+    }
+
+    /* allocate everything before taking the lock */
+    for (i = 0; i < flagCount; i++) {
+        LD_ASSERT(flags[i].key);
+
+        if (!(nodes[i] = LDi_allocateStoreNode(store, flags[i]))) {
+            LDi_flag_destroy(&flags[i]);
+
+            failed = LDBooleanTrue;
+        }
+    }
+
+    LDi_rwlock_wrlock(&store->lock);
+
+    for (i = 0; i < flagCount; i++) {
+        if (!nodes[i]) {
+            continue;
+        }
+
+        if (LDi_storeApplyLocked(store, nodes[i])) {
+            /* keeps the node alive until listeners have run even if a later
+            update in the same batch replaces it */
+            LDi_rc_increment(&nodes[i]->rc);
+        } else {
+            LDi_destroyStoreNode(nodes[i]);
 
-    if ((existing && (flag.version >= existing->flag.version)) || !existing) {
-        if (existing) {
-            HASH_DEL(store->flags, existing);
-            LDi_rc_decrement(&existing->rc);
+            nodes[i] = NULL;
         }
+    }
 
-        HASH_ADD_KEYPTR(
-            hh, store->flags, flag.key, strlen(flag.key), replacement);
+    /* once per key, with the state of its last update. keys are atoms so
+    equal keys are the same pointer */
+    for (i = 0; i < flagCount; i++) {
+        unsigned int later;
 
-        LDi_fireListenersFor(store, flag.key, flag.deleted);
-    } else {
-        LDi_rc_destroy(&replacement->rc);
+        if (!nodes[i]) {
+            continue;
+        }
+
+        for (later = i + 1; later < flagCount; later++) {
+            if (nodes[later] && nodes[later]->flag.key == nodes[i]->flag.key) {
+                break;
+            }
+        }
+
+        if (later == flagCount) {
+            LDi_fireListenersFor(
+                store, nodes[i]->flag.key, nodes[i]->flag.deleted);
+        }
     }
 
     LDi_rwlock_wrunlock(&store->lock);
 
-    return LDBooleanTrue;
+    for (i = 0; i < flagCount; i++) {
+        if (nodes[i]) {
+            LDi_rc_decrement(&nodes[i]->rc);
+        }
+    }
+
+    LDFree(nodes);
+
+    return !failed;
 }
 
 struct LDStoreNode *
@@ -173,19 +334,10 @@ LDi_storeDelete(
     LD_ASSERT(store);
     LD_ASSERT(key);
 
-    if (!(flag.key = LDStrDup(key))) {
+    if (!LDi_flag_tombstone(&flag, key, version)) {
         return LDBooleanFalse;
     }
 
-    flag.value                = NULL;
-    flag.version              = version;
-    flag.variation            = 0;
-    flag.trackEvents          = LDBooleanFalse;
-    flag.trackReason          = LDBooleanFalse;
-    flag.reason               = NULL;
-    flag.debugEventsUntilDate = 0;
-    flag.deleted              = LDBooleanTrue;
-
     return LDi_storeUpsert(store, flag);
 }
 
@@ -210,14 +362,21 @@ LDi_storePut(
         } else {
             struct LDStoreNode *node;
 
-            if (!(node = LDi_allocateStoreNode(flags[i]))) {
+            if (!(node = LDi_allocateStoreNode(store, flags[i]))) {
+                LDi_flag_destroy(&flags[i]);
+
                 failed = LDBooleanTrue;
 
                 continue;
             }
 
-            HASH_ADD_KEYPTR(
-                hh, flagsHash, node->flag.key, strlen(node->flag.key), node);
+            HASH_ADD_KEYPTR_BYHASHVALUE(
+                hh,
+                flagsHash,
+                node->flag.key,
+                LDi_flagKeyLength(node->flag.key),
+                LDi_flagKeyHash(node->flag.key),
+                node);
         }
     }
 
@@ -234,6 +393,9 @@ LDi_storePut(
         store->flags       = flagsHash;
         store->initialized = LDBooleanTrue;
 
+        LDi_atomicIncrement(&store->generation);
+        LDi_atomicStore(&store->size, (long)HASH_COUNT(store->flags));
+
         HASH_ITER(hh, store->flags, node, tmp)
         {
             LDi_fireListenersFor(store, node->flag.key, LDBooleanFalse);
@@ -247,6 +409,20 @@ LDi_storePut(
     return !failed;
 }
 
+void
+LDi_storeStats(
+    struct LDStore *const store,
+    unsigned long *const  size,
+    unsigned long *const  generation)
+{
+    LD_ASSERT(store);
+    LD_ASSERT(size);
+    LD_ASSERT(generation);
+
+    *size       = LDi_atomicLoad(&store->size);
+    *generation = LDi_atomicLoad(&store->generation);
+}
+
 LDBoolean
 LDi_storeGetAll(
     struct LDStore *const       store,
@@ -336,16 +512,23 @@ error:
 LDBoolean
 LDi_storeRegisterListener(struct LDStore *const store, const char *const flagKey, LDlistenerfn op)
 {
-    LDBoolean status;
+    LDBoolean   status;
+    const char *key;
 
     LD_ASSERT(store);
     LD_ASSERT(flagKey);
     LD_ASSERT(op);
 
+    if (!(key = LDi_flagKeyIntern(&store->keys, flagKey))) {
+        return LDBooleanFalse;
+    }
+
     LDi_rwlock_wrlock(&store->lock);
-    status = LDi_listenerAdd(&store->listeners, flagKey, op);
+    status = LDi_listenerAdd(&store->listeners, key, op);
     LDi_rwlock_wrunlock(&store->lock);
 
+    LDi_flagKeyRelease(key);
+
     return status;
 }
 
@@ -2,12 +2,15 @@
 
 #include <launchdarkly/api.h>
 
+#include "atomic.h"
 #include "concurrency.h"
 #include "flag.h"
+#include "flag_key.h"
 #include "reference_count.h"
 #include "uthash.h"
 #include "flag_change_listener.h"
 
+/* the key of a stored flag is an atom of the store's key table */
 struct LDStoreNode
 {
     struct LDFlag  flag;
@@ -21,6 +24,11 @@ struct LDStore
     struct ChangeListener  *listeners;
     LDBoolean               initialized;
     ld_rwlock_t             lock;
+    struct LDFlagKeyTable   keys;
+    /* changes applied and flags held, written under lock and read without
+    it for LDi_storeStats */
+    ld_atomic_t             generation;
+    ld_atomic_t             size;
 };
 
 LDBoolean
@@ -32,6 +40,15 @@ LDi_storeDestroy(struct LDStore *const store);
 LDBoolean
 LDi_storeUpsert(struct LDStore *const store, struct LDFlag flag);
 
+/* Applies a sequence of upserts and deletes with one acquisition of the write
+lock, then notifies listeners for every change that was applied. Ownership of
+the contents of each flag is transferred, the array itself is not. */
+LDBoolean
+LDi_storeUpsertBatch(
+    struct LDStore *const store,
+    struct LDFlag *const  flags,
+    const unsigned int    flagCount);
+
 LDBoolean
 LDi_storePut(
     struct LDStore *const store,
@@ -64,5 +81,12 @@ void
 LDi_storeUnregisterListener(
     struct LDStore *const store, const char *const flagKey, LDlistenerfn op);
 
+/* does not take the lock */
+void
+LDi_storeStats(
+    struct LDStore *const store,
+    unsigned long *const  size,
+    unsigned long *const  generation);
+
 void
 LDi_storeFreeFlags(struct LDStore *const store);
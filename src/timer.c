@@ -0,0 +1,514 @@
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#include "assertion.h"
+#include "lock_profile.h"
+#include "timer.h"
+#include "utility.h"
+
+/* Timers are kept in the style of the classic Linux timer wheel. A timer due
+within 64 ticks sits in the first level at its deadline modulo 64, one due
+later in the slot of a higher level covering its deadline. Each time the
+first level wraps, the next slot of the level above is cascaded: its timers
+are linked again relative to the current tick, moving them down. */
+
+#define LD_TIMER_SLOT_MASK (LD_TIMER_SLOTS - 1)
+/* the longest delay the wheel can hold, in ticks, longer ones are clamped */
+#define LD_TIMER_RANGE (1UL << (LD_TIMER_LEVELS * LD_TIMER_SLOT_BITS))
+
+/* the tick containing the time in milliseconds, or the first starting after
+it */
+static unsigned long
+LDi_timerTickAt(
+    const struct LDTimerWheel *const wheel,
+    const unsigned int               milliseconds,
+    const LDBoolean                  roundUp)
+{
+    double now, ticks;
+
+    if (!LDi_getMonotonicMilliseconds(&now)) {
+        return wheel->now;
+    }
+
+    ticks = (now + milliseconds - wheel->originMilliseconds) /
+        LD_TIMER_TICK_MILLISECONDS;
+
+    return (unsigned long)(roundUp ? ceil(ticks) : ticks);
+}
+
+static unsigned int
+LDi_timerHash(const char *text)
+{
+    unsigned long hash;
+
+    /* FNV-1a */
+    for (hash = 2166136261UL; *text; text++) {
+        hash = (hash ^ (unsigned char)*text) * 16777619UL;
+    }
+
+    return (unsigned int)hash;
+}
+
+static void
+LDi_timerUnlink(struct LDTimer *const timer)
+{
+    *timer->link = timer->next;
+
+    if (timer->next) {
+        timer->next->link = timer->link;
+    }
+
+    timer->next    = NULL;
+    timer->link    = NULL;
+    timer->pending = LDBooleanFalse;
+}
+
+static void
+LDi_timerLink(struct LDTimerWheel *const wheel, struct LDTimer *const timer)
+{
+    struct LDTimer **slot;
+    unsigned long    delta;
+    unsigned int     level;
+
+    delta = timer->deadline - wheel->now;
+
+    /* already due, or beyond the range of the wheel */
+    if ((long)delta < 0) {
+        timer->deadline = wheel->now;
+        delta           = 0;
+    } else if (delta >= LD_TIMER_RANGE) {
+        timer->deadline = wheel->now + LD_TIMER_RANGE - 1;
+        delta           = LD_TIMER_RANGE - 1;
+    }
+
+    for (level = 0;
+         delta >= 1UL << ((level + 1) * LD_TIMER_SLOT_BITS);
+         level++)
+    {}
+
+    slot = &wheel->slots[level][(timer->deadline >>
+                                 (level * LD_TIMER_SLOT_BITS)) &
+                                LD_TIMER_SLOT_MASK];
+
+    timer->next = *slot;
+
+    if (*slot) {
+        (*slot)->link = &timer->next;
+    }
+
+    *slot          = timer;
+    timer->link    = slot;
+    timer->pending = LDBooleanTrue;
+}
+
+static void
+LDi_timerCascade(
+    struct LDTimerWheel *const wheel,
+    const unsigned int         level,
+    const unsigned int         index)
+{
+    struct LDTimer *timer;
+
+    while ((timer = wheel->slots[level][index])) {
+        LDi_timerUnlink(timer);
+        LDi_timerLink(wheel, timer);
+    }
+}
+
+/* expects the lock, which is released while callbacks run */
+static void
+LDi_timerProcessTick(struct LDTimerWheel *const wheel)
+{
+    struct LDTimer *due, *timer;
+    unsigned int    index, level;
+
+    index = (unsigned int)(wheel->now & LD_TIMER_SLOT_MASK);
+
+    if (index == 0) {
+        for (level = 1; level < LD_TIMER_LEVELS; level++) {
+            const unsigned int cascaded =
+                (unsigned int)(wheel->now >> (level * LD_TIMER_SLOT_BITS)) &
+                LD_TIMER_SLOT_MASK;
+
+            LDi_timerCascade(wheel, level, cascaded);
+
+            if (cascaded != 0) {
+                break;
+            }
+        }
+    }
+
+    /* detached so that timers scheduled by the callbacks for this tick wait
+    for the next, while callbacks may still cancel timers in it */
+    if ((due = wheel->slots[0][index])) {
+        wheel->slots[0][index] = NULL;
+        due->link              = &due;
+    }
+
+    while ((timer = due)) {
+        LDi_timerUnlink(timer);
+
+        wheel->running = timer;
+
+        LDi_mutex_unlock(&wheel->lock);
+        timer->callback(timer->context);
+        LDi_mutex_lock(&wheel->lock);
+
+        wheel->running = NULL;
+
+        LDi_cond_signal(&wheel->idle);
+    }
+
+    wheel->now++;
+}
+
+/* the next tick with something to do, a deadline or a cascade */
+static LDBoolean
+LDi_timerNextTick(
+    const struct LDTimerWheel *const wheel, unsigned long *const next)
+{
+    LDBoolean    found;
+    unsigned int level, offset;
+
+    found = LDBooleanFalse;
+
+    for (offset = 0; offset < LD_TIMER_SLOTS; offset++) {
+        if (wheel->slots[0][(wheel->now + offset) & LD_TIMER_SLOT_MASK]) {
+            *next = wheel->now + offset;
+            found = LDBooleanTrue;
+
+            break;
+        }
+    }
+
+    for (level = 1; level < LD_TIMER_LEVELS; level++) {
+        const unsigned int  shift = level * LD_TIMER_SLOT_BITS;
+        const unsigned long base  = wheel->now >> shift;
+        /* the slot of the current tick is still to be cascaded if the tick
+        starts it */
+        const unsigned int first =
+            (wheel->now & ((1UL << shift) - 1)) == 0 ? 0 : 1;
+
+        for (offset = first; offset < first + LD_TIMER_SLOTS; offset++) {
+            if (wheel->slots[level][(base + offset) & LD_TIMER_SLOT_MASK]) {
+                const unsigned long cascade = (base + offset) << shift;
+
+                if (!found || (long)(cascade - *next) < 0) {
+                    *next = cascade;
+                    found = LDBooleanTrue;
+                }
+
+                break;
+            }
+        }
+    }
+
+    return found;
+}
+
+static THREAD_RETURN
+LDi_timerThread(void *const argument)
+{
+    struct LDTimerWheel *const wheel = (struct LDTimerWheel *)argument;
+
+    LDi_mutex_lock(&wheel->lock);
+
+    while (!wheel->stopping) {
+        unsigned long current, next;
+
+        wheel->wakeAt = 0;
+
+        current = LDi_timerTickAt(wheel, 0, LDBooleanFalse);
+
+        while ((long)(current - wheel->now) >= 0 && !wheel->stopping) {
+            /* ticks without a deadline or a cascade are skipped */
+            if (!LDi_timerNextTick(wheel, &next) ||
+                (long)(next - current) > 0)
+            {
+                wheel->now = current + 1;
+
+                break;
+            }
+
+            wheel->now = next;
+
+            LDi_timerProcessTick(wheel);
+        }
+
+        if (wheel->stopping) {
+            break;
+        }
+
+        if (LDi_timerNextTick(wheel, &next)) {
+            double now, milliseconds;
+
+            wheel->wakeAt = next;
+
+            if (!LDi_getMonotonicMilliseconds(&now)) {
+                now = wheel->originMilliseconds +
+                    (double)current * LD_TIMER_TICK_MILLISECONDS;
+            }
+
+            milliseconds = wheel->originMilliseconds +
+                (double)next * LD_TIMER_TICK_MILLISECONDS - now;
+
+            if (milliseconds >= 1) {
+                LDi_cond_wait(&wheel->wake, &wheel->lock, (int)milliseconds);
+            }
+        } else {
+            wheel->wakeAt = ULONG_MAX;
+
+            LDi_cond_wait(&wheel->wake, &wheel->lock, LD_WAIT_FOREVER);
+        }
+    }
+
+    LDi_mutex_unlock(&wheel->lock);
+
+    return THREAD_RETURN_DEFAULT;
+}
+
+void
+LDi_timerInitialize(
+    struct LDTimer *const timer,
+    LDTimerCallback       callback,
+    void *const           context,
+    const char *const     key)
+{
+    LD_ASSERT(timer);
+    LD_ASSERT(callback);
+
+    memset(timer, 0, sizeof(*timer));
+
+    timer->callback = callback;
+    timer->context  = context;
+    timer->key      = key;
+    timer->pending  = LDBooleanFalse;
+}
+
+LDBoolean
+LDi_timerWheelStart(struct LDTimerWheel *const wheel)
+{
+    LD_ASSERT(wheel);
+
+    memset(wheel, 0, sizeof(*wheel));
+
+    if (!LDi_getMonotonicMilliseconds(&wheel->originMilliseconds)) {
+        return LDBooleanFalse;
+    }
+
+    if (!LDi_random(&wheel->seed)) {
+        wheel->seed = 0;
+    }
+
+    wheel->stopping = LDBooleanFalse;
+
+    if (!LDi_mutex_init(&wheel->lock)) {
+        goto err1;
+    }
+
+    LDi_lockProfileLabel(&wheel->lock, "timers");
+
+    if (!LDi_cond_init(&wheel->wake)) {
+        goto err2;
+    }
+
+    if (!LDi_cond_init(&wheel->idle)) {
+        goto err3;
+    }
+
+    if (!LDi_thread_create(&wheel->thread, LDi_timerThread, wheel)) {
+        goto err4;
+    }
+
+    wheel->started = LDBooleanTrue;
+
+    return LDBooleanTrue;
+
+err4:
+    LDi_cond_destroy(&wheel->idle);
+err3:
+    LDi_cond_destroy(&wheel->wake);
+err2:
+    LDi_mutex_destroy(&wheel->lock);
+err1:
+    return LDBooleanFalse;
+}
+
+void
+LDi_timerWheelStop(struct LDTimerWheel *const wheel)
+{
+    unsigned int level, index;
+
+    LD_ASSERT(wheel);
+
+    if (!wheel->started) {
+        return;
+    }
+
+    LDi_mutex_lock(&wheel->lock);
+    wheel->stopping = LDBooleanTrue;
+    LDi_cond_signal(&wheel->wake);
+    LDi_mutex_unlock(&wheel->lock);
+
+    LDi_thread_join(&wheel->thread);
+
+    for (level = 0; level < LD_TIMER_LEVELS; level++) {
+        for (index = 0; index < LD_TIMER_SLOTS; index++) {
+            while (wheel->slots[level][index]) {
+                LDi_timerUnlink(wheel->slots[level][index]);
+            }
+        }
+    }
+
+    LDi_cond_destroy(&wheel->idle);
+    LDi_cond_destroy(&wheel->wake);
+    LDi_mutex_destroy(&wheel->lock);
+
+    wheel->started = LDBooleanFalse;
+}
+
+/* the tick a timer started now would run at */
+static unsigned long
+LDi_timerDeadline(
+    const struct LDTimerWheel *const wheel,
+    const struct LDTimer *const      timer,
+    const unsigned int               milliseconds)
+{
+    unsigned long deadline, ticks, slack, granularity;
+
+    ticks    = milliseconds / LD_TIMER_TICK_MILLISECONDS;
+    deadline = LDi_timerTickAt(wheel, milliseconds, LDBooleanTrue);
+
+    /* move the deadline up to a sixteenth later, onto the next tick in the
+    phase of its key, a power of two ticks apart */
+    if (timer->key) {
+        slack = ticks / 16;
+
+        for (granularity = 1; granularity * 2 <= slack; granularity *= 2) {}
+
+        if (granularity > 1) {
+            const unsigned long phase =
+                (LDi_timerHash(timer->key) ^ wheel->seed) & (granularity - 1);
+
+            deadline += (phase - deadline) & (granularity - 1);
+        }
+    }
+
+    return deadline;
+}
+
+/* expects the lock */
+static void
+LDi_timerSchedule(
+    struct LDTimerWheel *const wheel,
+    struct LDTimer *const      timer,
+    const unsigned long        deadline)
+{
+    if (timer->pending) {
+        LDi_timerUnlink(timer);
+    }
+
+    timer->deadline = deadline;
+
+    LDi_timerLink(wheel, timer);
+
+    if ((long)(timer->deadline - wheel->wakeAt) < 0 ||
+        wheel->wakeAt == ULONG_MAX)
+    {
+        LDi_cond_signal(&wheel->wake);
+    }
+}
+
+void
+LDi_timerStart(
+    struct LDTimerWheel *const wheel,
+    struct LDTimer *const      timer,
+    const unsigned int         milliseconds)
+{
+    LD_ASSERT(wheel);
+    LD_ASSERT(timer);
+
+    LDi_mutex_lock(&wheel->lock);
+    LDi_timerSchedule(
+        wheel, timer, LDi_timerDeadline(wheel, timer, milliseconds));
+    LDi_mutex_unlock(&wheel->lock);
+}
+
+void
+LDi_timerStartIfIdle(
+    struct LDTimerWheel *const wheel,
+    struct LDTimer *const      timer,
+    const unsigned int         milliseconds)
+{
+    LD_ASSERT(wheel);
+    LD_ASSERT(timer);
+
+    LDi_mutex_lock(&wheel->lock);
+
+    if (!timer->pending && wheel->running != timer) {
+        LDi_timerSchedule(
+            wheel, timer, LDi_timerDeadline(wheel, timer, milliseconds));
+    }
+
+    LDi_mutex_unlock(&wheel->lock);
+}
+
+void
+LDi_timerStartBefore(
+    struct LDTimerWheel *const wheel,
+    struct LDTimer *const      timer,
+    const unsigned int         milliseconds)
+{
+    unsigned long deadline;
+
+    LD_ASSERT(wheel);
+    LD_ASSERT(timer);
+
+    LDi_mutex_lock(&wheel->lock);
+
+    deadline = LDi_timerDeadline(wheel, timer, milliseconds);
+
+    if (wheel->running != timer &&
+        (!timer->pending || (long)(deadline - timer->deadline) < 0))
+    {
+        LDi_timerSchedule(wheel, timer, deadline);
+    }
+
+    LDi_mutex_unlock(&wheel->lock);
+}
+
+void
+LDi_timerCancel(struct LDTimerWheel *const wheel, struct LDTimer *const timer)
+{
+    LD_ASSERT(wheel);
+    LD_ASSERT(timer);
+
+    LDi_mutex_lock(&wheel->lock);
+
+    if (timer->pending) {
+        LDi_timerUnlink(timer);
+    }
+
+    LDi_mutex_unlock(&wheel->lock);
+}
+
+void
+LDi_timerCancelAndWait(
+    struct LDTimerWheel *const wheel, struct LDTimer *const timer)
+{
+    LD_ASSERT(wheel);
+    LD_ASSERT(timer);
+
+    LDi_mutex_lock(&wheel->lock);
+
+    while (wheel->running == timer) {
+        LDi_cond_wait(&wheel->idle, &wheel->lock, LD_WAIT_FOREVER);
+    }
+
+    if (timer->pending) {
+        LDi_timerUnlink(timer);
+    }
+
+    LDi_mutex_unlock(&wheel->lock);
+}
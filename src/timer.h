@@ -0,0 +1,105 @@
+#pragma once
+
+#include <launchdarkly/boolean.h>
+
+#include "concurrency.h"
+
+/* Hierarchical timing wheel run by a single thread, scheduling the periodic
+work of every environment. Four levels of 64 slots cover delays of up to two
+to the twenty-fourth ticks, about 46 hours at 10ms a tick; a level is only
+visited when its slot is due to be cascaded into the level below, so the
+thread wakes when something is due rather than on every tick. */
+#define LD_TIMER_TICK_MILLISECONDS 10
+#define LD_TIMER_SLOT_BITS 6
+#define LD_TIMER_SLOTS (1 << LD_TIMER_SLOT_BITS)
+#define LD_TIMER_LEVELS 4
+
+/* run on the timer thread without any lock held, every environment shares the
+thread so a callback should not block for longer than a request */
+typedef void (*LDTimerCallback)(void *const context);
+
+struct LDTimer
+{
+    LDTimerCallback callback;
+    void *          context;
+    /* timers with the same key and similar delays are given the same
+    deadline, so they run on one wakeup; the alignment is randomized per
+    process so that processes do not reach a host at once. NULL runs the timer
+    at the tick its delay ends. */
+    const char *key;
+    /* the remaining fields are protected by the lock of the wheel */
+    unsigned long    deadline;
+    LDBoolean        pending;
+    struct LDTimer * next;
+    /* the pointer to this timer in its list */
+    struct LDTimer **link;
+};
+
+struct LDTimerWheel
+{
+    ld_mutex_t  lock;
+    /* wakes the thread when a deadline precedes the one it sleeps until */
+    ld_cond_t   wake;
+    /* signaled when a callback returns */
+    ld_cond_t   idle;
+    ld_thread_t thread;
+    LDBoolean   started;
+    LDBoolean   stopping;
+    /* the next tick to process */
+    unsigned long now;
+    /* the tick the thread sleeps until, zero while it is processing and the
+    maximum when nothing is pending */
+    unsigned long wakeAt;
+    double        originMilliseconds;
+    unsigned int  seed;
+    /* the timer whose callback is running */
+    struct LDTimer *running;
+    struct LDTimer *slots[LD_TIMER_LEVELS][LD_TIMER_SLOTS];
+};
+
+void
+LDi_timerInitialize(
+    struct LDTimer *const timer,
+    LDTimerCallback       callback,
+    void *const           context,
+    const char *const     key);
+
+LDBoolean
+LDi_timerWheelStart(struct LDTimerWheel *const wheel);
+
+/* waits for a running callback, pending timers are discarded */
+void
+LDi_timerWheelStop(struct LDTimerWheel *const wheel);
+
+/* schedules timer to run in milliseconds, replacing any pending deadline */
+void
+LDi_timerStart(
+    struct LDTimerWheel *const wheel,
+    struct LDTimer *const      timer,
+    const unsigned int         milliseconds);
+
+/* as LDi_timerStart, unless timer is pending or its callback is running and
+so will decide when it next runs */
+void
+LDi_timerStartIfIdle(
+    struct LDTimerWheel *const wheel,
+    struct LDTimer *const      timer,
+    const unsigned int         milliseconds);
+
+/* as LDi_timerStartIfIdle, except a pending deadline is moved earlier if
+milliseconds ends before it, so that repeated calls never postpone the timer */
+void
+LDi_timerStartBefore(
+    struct LDTimerWheel *const wheel,
+    struct LDTimer *const      timer,
+    const unsigned int         milliseconds);
+
+/* a running callback may still schedule timer again */
+void
+LDi_timerCancel(struct LDTimerWheel *const wheel, struct LDTimer *const timer);
+
+/* also waits for a running callback, then cancels anything it scheduled. Must
+not be called from the callback or with a lock it takes. */
+void
+LDi_timerCancelAndWait(
+    struct LDTimerWheel *const wheel, struct LDTimer *const timer);
@@ -39,6 +39,7 @@ TEST_F(AllFlagsWithClientFixture, BasicAllFlags) {
 
     flag.key = LDStrDup("test");
     flag.value = LDNewText("alice");
+    flag.valueText = NULL;
     flag.version = 2;
     flag.variation = 3;
     flag.trackEvents = LDBooleanFalse;
@@ -5,6 +5,7 @@ extern "C" {
 #include <launchdarkly/api.h>
 
 #include "client.h"
+#include "ldinternal.h"
 }
 
 // Inherit from the CommonFixture to give a reasonable name for the test output.
@@ -45,3 +46,64 @@ TEST_F(ClientFixture, ClientMisc) {
 
     LDClientClose(client);
 }
+
+TEST_F(ClientFixture, StateChangesWakeThreads) {
+    struct LDUser *user;
+    struct LDConfig *config;
+    struct LDClient *client;
+    long generation;
+    double started, finished;
+
+    ASSERT_TRUE(user = LDUserNew("a"));
+    ASSERT_TRUE(config = LDConfigNew("b"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    ASSERT_TRUE(client = LDClientInit(config, user, 0));
+
+    generation = LDi_atomicLoad(&client->stateGeneration);
+
+    LDClientSetBackground(client, LDBooleanTrue);
+    ASSERT_GT(LDi_atomicLoad(&client->stateGeneration), generation);
+
+    /* a stale generation returns without waiting */
+    ASSERT_TRUE(LDi_awaitStateChange(
+        client, &client->streamCond, generation, LD_WAIT_FOREVER));
+
+    /* a current one waits out a timed wait */
+    generation = LDi_atomicLoad(&client->stateGeneration);
+    ASSERT_FALSE(LDi_awaitStateChange(
+        client, &client->streamCond, generation, 10));
+
+    LDClientSetOffline(client);
+    ASSERT_GT(LDi_atomicLoad(&client->stateGeneration), generation);
+
+    /* the idle threads sleep without a timeout, so they must be woken */
+    ASSERT_TRUE(LDi_getMonotonicMilliseconds(&started));
+    LDClientClose(client);
+    ASSERT_TRUE(LDi_getMonotonicMilliseconds(&finished));
+
+    ASSERT_LT(finished - started, 1000);
+}
+
+TEST_F(ClientFixture, ShuttingDownIsFinal) {
+    struct LDUser *user;
+    struct LDConfig *config;
+    struct LDClient *client;
+
+    ASSERT_TRUE(user = LDUserNew("a"));
+    ASSERT_TRUE(config = LDConfigNew("b"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    ASSERT_TRUE(client = LDClientInit(config, user, 0));
+
+    /* as when a put arrives while the client is closed */
+    LDi_rwlock_wrlock(&client->clientLock);
+    LDi_updatestatus(client, LDStatusShuttingdown);
+    LDi_updatestatus(client, LDStatusInitialized);
+    LDi_rwlock_wrunlock(&client->clientLock);
+
+    ASSERT_EQ(LDi_atomicLoad(&client->status), LDStatusShuttingdown);
+    ASSERT_FALSE(LDClientIsInitialized(client));
+    ASSERT_FALSE(client->pollTimer.pending);
+    ASSERT_FALSE(client->flushTimer.pending);
+
+    LDClientClose(client);
+}
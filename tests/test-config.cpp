@@ -95,5 +95,8 @@ TEST_F(ConfigFixture, Setters) {
     LDConfigSetInlineUsersInEvents(config, LDBooleanTrue);
     ASSERT_TRUE(config->inlineUsersInEvents);
 
+    LDConfigSetStreamPatchCoalescingMicros(config, 500);
+    ASSERT_EQ(config->patchCoalescingMicros, 500);
+
     LDConfigFree(config);
 }
@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "ldinternal.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class EvaluationHookFixture : public CommonFixture {
+protected:
+    struct LDClient *client;
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        struct LDConfig *config;
+        struct LDUser *user;
+
+        LD_ASSERT(config = LDConfigNew("abc"));
+        LDConfigSetOffline(config, LDBooleanTrue);
+
+        LD_ASSERT(user = LDUserNew("test-user"));
+
+        LD_ASSERT(client = LDClientInit(config, user, 0));
+    }
+
+    void TearDown() override {
+        LDClientClose(client);
+        CommonFixture::TearDown();
+    }
+};
+
+struct RecordedEvaluation {
+    std::string flagKey;
+    int variationIndex;
+    LDJSONType type;
+    std::string reasonKind;
+    double durationNanoseconds;
+};
+
+static void
+recordEvaluation(const struct LDEvaluationHookData *const data,
+    void *const context)
+{
+    std::vector<RecordedEvaluation> *const recorded =
+        (std::vector<RecordedEvaluation> *)context;
+    RecordedEvaluation evaluation;
+
+    evaluation.flagKey = data->flagKey;
+    evaluation.variationIndex = data->variationIndex;
+    evaluation.type = data->type;
+    evaluation.reasonKind = data->reasonKind ? data->reasonKind : "<none>";
+    evaluation.durationNanoseconds = data->durationNanoseconds;
+
+    recorded->push_back(evaluation);
+}
+
+static void
+countEvaluation(const struct LDEvaluationHookData *const data,
+    void *const context)
+{
+    (void)data;
+
+    (*(int *)context)++;
+}
+
+static struct LDFlag
+makeFlag(const char *const key, struct LDJSON *const value,
+    struct LDJSON *const reason)
+{
+    struct LDFlag flag;
+
+    flag.key = LDStrDup(key);
+    flag.value = value;
+    flag.valueText = NULL;
+    flag.version = 1;
+    flag.flagVersion = -1;
+    flag.variation = 2;
+    flag.trackEvents = LDBooleanFalse;
+    flag.trackReason = LDBooleanFalse;
+    flag.reason = reason;
+    flag.debugEventsUntilDate = 0;
+    flag.deleted = LDBooleanFalse;
+
+    return flag;
+}
+
+TEST_F(EvaluationHookFixture, ReceivesEvaluations) {
+    std::vector<RecordedEvaluation> recorded;
+    struct LDJSON *reason;
+    char buffer[16];
+
+    ASSERT_TRUE(reason = LDNewObject());
+    ASSERT_TRUE(LDObjectSetKey(reason, "kind", LDNewText("RULE_MATCH")));
+
+    ASSERT_TRUE(LDi_storeUpsert(&client->store,
+        makeFlag("bool", LDNewBool(LDBooleanTrue), reason)));
+    ASSERT_TRUE(LDi_storeUpsert(&client->store,
+        makeFlag("text", LDNewText("a"), NULL)));
+
+    ASSERT_TRUE(LDClientSetEvaluationHook(client, recordEvaluation, &recorded));
+
+    ASSERT_TRUE(LDBoolVariation(client, "bool", LDBooleanFalse));
+    ASSERT_STREQ(LDStringVariation(
+        client, "text", "b", buffer, sizeof(buffer)), "a");
+    ASSERT_EQ(LDIntVariation(client, "text", 3), 3);
+    ASSERT_EQ(LDIntVariation(client, "missing", 4), 4);
+
+    ASSERT_EQ(recorded.size(), 4);
+
+    ASSERT_EQ(recorded[0].flagKey, "bool");
+    ASSERT_EQ(recorded[0].variationIndex, 2);
+    ASSERT_EQ(recorded[0].type, LDBool);
+    ASSERT_EQ(recorded[0].reasonKind, "RULE_MATCH");
+    ASSERT_GT(recorded[0].durationNanoseconds, 0);
+
+    ASSERT_EQ(recorded[1].type, LDText);
+    ASSERT_EQ(recorded[1].variationIndex, 2);
+    ASSERT_EQ(recorded[1].reasonKind, "<none>");
+
+    /* wrong type */
+    ASSERT_EQ(recorded[2].type, LDNumber);
+    ASSERT_EQ(recorded[2].variationIndex, -1);
+    ASSERT_EQ(recorded[2].reasonKind, "ERROR");
+
+    ASSERT_EQ(recorded[3].flagKey, "missing");
+    ASSERT_EQ(recorded[3].variationIndex, -1);
+    ASSERT_EQ(recorded[3].reasonKind, "ERROR");
+}
+
+TEST_F(EvaluationHookFixture, ReplacesAndRemovesHook) {
+    int first, second;
+
+    first = 0;
+    second = 0;
+
+    ASSERT_TRUE(LDClientSetEvaluationHook(client, countEvaluation, &first));
+
+    LDBoolVariation(client, "flag", LDBooleanFalse);
+
+    ASSERT_TRUE(LDClientSetEvaluationHook(client, countEvaluation, &second));
+
+    LDBoolVariation(client, "flag", LDBooleanFalse);
+    LDBoolVariation(client, "flag", LDBooleanFalse);
+
+    ASSERT_TRUE(LDClientSetEvaluationHook(client, NULL, NULL));
+
+    LDBoolVariation(client, "flag", LDBooleanFalse);
+
+    ASSERT_EQ(first, 1);
+    ASSERT_EQ(second, 2);
+}
@@ -103,6 +103,7 @@ TEST_F(EventsWithClientFixture, BasicSummary) {
 
     flag.key = LDStrDup("test");
     flag.value = LDNewBool(LDBooleanTrue);
+    flag.valueText = NULL;
     flag.version = 2;
     flag.flagVersion = -1;
     flag.variation = 3;
@@ -265,6 +266,7 @@ TEST_F(EventsWithClientFixture, VariationSendsFeatureEventWithReasonIfTrackReaso
 
     flag.key = LDStrDup("flag");
     flag.value = LDNewBool(LDBooleanTrue);
+    flag.valueText = NULL;
     flag.version = 1000;
     flag.flagVersion = -1;
     flag.variation = 3;
@@ -304,6 +306,7 @@ TEST_F(EventsWithClientFixture, VariationSendsFeatureEventWithoutReasonIfTrackRe
 
     flag.key = LDStrDup("flag");
     flag.value = LDNewBool(LDBooleanTrue);
+    flag.valueText = NULL;
     flag.version = 1000;
     flag.flagVersion = -1;
     flag.variation = 3;
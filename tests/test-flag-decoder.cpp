@@ -0,0 +1,217 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "flag_decoder.h"
+#include "ldinternal.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class FlagDecoderFixture : public CommonFixture {
+};
+
+static const char *const payload =
+    "{\n"
+    "\"a\": {\n"
+    "  \"value\": {\"nested\": [1, \"two\", null, {\"x\": false}]},\n"
+    "  \"version\": 53,\n"
+    "  \"variation\": 3,\n"
+    "  \"flagVersion\": 45,\n"
+    "  \"trackEvents\": true,\n"
+    "  \"trackReason\": true,\n"
+    "  \"unknown\": {\"ignored\": [[], {}]},\n"
+    "  \"reason\": {\"kind\": \"ERROR\", \"errorKind\": \"WRONG_TYPE\"},\n"
+    "  \"debugEventsUntilDate\": 5000,\n"
+    "  \"deleted\": true\n"
+    "},\n"
+    "\"b\": {\"value\": \"caf\\u00e9 \\ud83d\\ude00\", \"variation\": null}\n"
+    "}";
+
+static void
+expectMatchesTreeParse(struct LDFlag *const flags, const unsigned int flagCount)
+{
+    struct LDJSON *tree, *iter;
+    unsigned int   i;
+
+    ASSERT_TRUE(tree = LDJSONDeserialize(payload));
+    ASSERT_EQ(flagCount, LDCollectionGetSize(tree));
+
+    for (iter = LDGetIter(tree), i = 0; iter; iter = LDIterNext(iter), i++) {
+        struct LDFlag  expected;
+        struct LDJSON *expectedJSON, *actualJSON;
+
+        ASSERT_TRUE(LDi_flag_parse(&expected, LDIterKey(iter), iter));
+        ASSERT_TRUE(expectedJSON = LDi_flag_to_json(&expected));
+        ASSERT_TRUE(actualJSON = LDi_flag_to_json(&flags[i]));
+
+        ASSERT_TRUE(LDJSONCompare(expectedJSON, actualJSON));
+
+        LDJSONFree(expectedJSON);
+        LDJSONFree(actualJSON);
+        LDi_flag_destroy(&expected);
+    }
+
+    LDJSONFree(tree);
+}
+
+TEST_F(FlagDecoderFixture, DecodesWholePayload) {
+    struct LDFlagDecoder decoder;
+    struct LDFlag *flags;
+    unsigned int flagCount, i;
+
+    LDi_flagDecoderInitialize(&decoder);
+
+    ASSERT_TRUE(LDi_flagDecoderProcess(&decoder, payload, strlen(payload)));
+    ASSERT_TRUE(LDi_flagDecoderFinish(&decoder, &flags, &flagCount));
+
+    ASSERT_EQ(flagCount, 2);
+    ASSERT_STREQ(flags[0].key, "a");
+    ASSERT_EQ(flags[0].version, 53);
+    ASSERT_EQ(flags[0].flagVersion, 45);
+    ASSERT_EQ(flags[0].variation, 3);
+    ASSERT_TRUE(flags[0].trackEvents);
+    ASSERT_TRUE(flags[0].deleted);
+    ASSERT_STREQ(flags[1].key, "b");
+    ASSERT_EQ(flags[1].variation, -1);
+    ASSERT_STREQ(LDGetText(flags[1].value), "caf\xc3\xa9 \xf0\x9f\x98\x80");
+
+    expectMatchesTreeParse(flags, flagCount);
+
+    for (i = 0; i < flagCount; i++) {
+        LDi_flag_destroy(&flags[i]);
+    }
+
+    LDFree(flags);
+    LDi_flagDecoderDestroy(&decoder);
+}
+
+TEST_F(FlagDecoderFixture, DecodesPayloadSplitAtEveryByte) {
+    struct LDFlagDecoder decoder;
+    struct LDFlag *flags;
+    unsigned int flagCount, i;
+    size_t offset;
+
+    LDi_flagDecoderInitialize(&decoder);
+
+    for (offset = 0; offset < strlen(payload); offset++) {
+        ASSERT_TRUE(LDi_flagDecoderProcess(&decoder, payload + offset, 1));
+    }
+
+    ASSERT_TRUE(LDi_flagDecoderFinish(&decoder, &flags, &flagCount));
+
+    expectMatchesTreeParse(flags, flagCount);
+
+    for (i = 0; i < flagCount; i++) {
+        LDi_flag_destroy(&flags[i]);
+    }
+
+    LDFree(flags);
+    LDi_flagDecoderDestroy(&decoder);
+}
+
+TEST_F(FlagDecoderFixture, EmptyPayload) {
+    struct LDFlagDecoder decoder;
+    struct LDFlag *flags;
+    unsigned int flagCount;
+
+    LDi_flagDecoderInitialize(&decoder);
+
+    ASSERT_TRUE(LDi_flagDecoderProcess(&decoder, " {} ", 4));
+    ASSERT_TRUE(LDi_flagDecoderFinish(&decoder, &flags, &flagCount));
+    ASSERT_EQ(flagCount, 0);
+
+    LDFree(flags);
+    LDi_flagDecoderDestroy(&decoder);
+}
+
+TEST_F(FlagDecoderFixture, RejectsInvalidPayloads) {
+    const char *const invalid[] = {
+        "[]",
+        "{\"a\": 5}",
+        "{\"a\": {\"variation\": 1}}",
+        "{\"a\": {\"value\": 1}}",
+        "{\"a\": {\"value\": 1, \"variation\": \"x\"}}",
+        "{\"a\": {\"value\": 1, \"variation\": 1, \"reason\": 5}}",
+        "{\"a\": {\"value\": tru, \"variation\": 1}}",
+        "{\"a\": {\"value\": 1, \"variation\": 1}",
+        "{\"a\": {\"value\": 1, \"variation\": 1}} x",
+        "{\"a\": {\"value\": \"\\ud83d\", \"variation\": 1}}"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        struct LDFlagDecoder decoder;
+        struct LDFlag *flags;
+        unsigned int flagCount;
+
+        LDi_flagDecoderInitialize(&decoder);
+
+        if (LDi_flagDecoderProcess(&decoder, invalid[i], strlen(invalid[i]))) {
+            ASSERT_FALSE(LDi_flagDecoderFinish(&decoder, &flags, &flagCount))
+                << invalid[i];
+        }
+
+        LDi_flagDecoderDestroy(&decoder);
+    }
+}
+
+TEST_F(FlagDecoderFixture, DecodesSingleFlag) {
+    const char *const text =
+        "{\"trackReason\": false, \"key\": \"a\", \"value\": [1, {\"b\": 2}],"
+        " \"variation\": 2, \"version\": 7, \"flagVersion\": 3,"
+        " \"trackEvents\": true, \"reason\": {\"kind\": \"OFF\"},"
+        " \"debugEventsUntilDate\": 10, \"keys\": {\"key\": 5}}";
+    struct LDFlag flag, expected;
+    struct LDJSON *tree, *expectedJSON, *actualJSON;
+
+    ASSERT_TRUE(LDi_flagDecode(&flag, text, strlen(text)));
+
+    ASSERT_TRUE(tree = LDJSONDeserialize(text));
+    ASSERT_TRUE(LDi_flag_parse(&expected, NULL, tree));
+    ASSERT_TRUE(expectedJSON = LDi_flag_to_json(&expected));
+    ASSERT_TRUE(actualJSON = LDi_flag_to_json(&flag));
+    ASSERT_STREQ(flag.key, "a");
+    ASSERT_TRUE(LDJSONCompare(expectedJSON, actualJSON));
+
+    LDJSONFree(expectedJSON);
+    LDJSONFree(actualJSON);
+    LDJSONFree(tree);
+    LDi_flag_destroy(&expected);
+    LDi_flag_destroy(&flag);
+}
+
+TEST_F(FlagDecoderFixture, SingleFlagRequiresKey) {
+    struct LDFlag flag;
+    const char *const missing = "{\"value\": 1, \"variation\": 1}";
+    const char *const notText = "{\"key\": 1, \"value\": 1, \"variation\": 1}";
+    const char *const twice = "{\"key\": \"a\", \"value\": 1, \"variation\": 1}{}";
+
+    ASSERT_FALSE(LDi_flagDecode(&flag, missing, strlen(missing)));
+    ASSERT_FALSE(LDi_flagDecode(&flag, notText, strlen(notText)));
+    ASSERT_FALSE(LDi_flagDecode(&flag, twice, strlen(twice)));
+}
+
+TEST_F(FlagDecoderFixture, ContainerValuesParsedOnFirstUse) {
+    const char *const text =
+        "{\"key\": \"a\", \"value\": {\"b\": [1, \"c\"]}, \"variation\": 0}";
+    struct LDFlag flag;
+    struct LDJSON *value, *expected;
+
+    ASSERT_TRUE(LDi_flagDecode(&flag, text, strlen(text)));
+
+    ASSERT_EQ(flag.value, nullptr);
+    ASSERT_STREQ(flag.valueText, "{\"b\": [1, \"c\"]}");
+    ASSERT_EQ(LDi_flag_value_type(&flag), LDObject);
+
+    ASSERT_TRUE(value = LDi_flag_value(&flag));
+    ASSERT_EQ(LDi_flag_value(&flag), value);
+
+    ASSERT_TRUE(expected = LDJSONDeserialize("{\"b\": [1, \"c\"]}"));
+    ASSERT_TRUE(LDJSONCompare(expected, value));
+
+    LDJSONFree(expected);
+    LDi_flag_destroy(&flag);
+}
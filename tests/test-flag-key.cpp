@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "flag_key.h"
+#include "ldinternal.h"
+#include "uthash.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class FlagKeyFixture : public CommonFixture {
+protected:
+    struct LDFlagKeyTable keys;
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        LD_ASSERT(LDi_flagKeyTableInitialize(&keys));
+    }
+
+    void TearDown() override {
+        LDi_flagKeyTableDestroy(&keys);
+        CommonFixture::TearDown();
+    }
+};
+
+TEST_F(FlagKeyFixture, EqualKeysShareAnAtom) {
+    const char *a, *b, *c;
+    char        copy[] = "alpha";
+
+    ASSERT_TRUE(a = LDi_flagKeyIntern(&keys, "alpha"));
+    ASSERT_TRUE(b = LDi_flagKeyIntern(&keys, copy));
+    ASSERT_TRUE(c = LDi_flagKeyIntern(&keys, "beta"));
+
+    ASSERT_EQ(a, b);
+    ASSERT_NE(a, c);
+    ASSERT_NE(a, copy);
+    ASSERT_STREQ(a, "alpha");
+    ASSERT_STREQ(c, "beta");
+
+    LDi_flagKeyRelease(a);
+    LDi_flagKeyRelease(b);
+    LDi_flagKeyRelease(c);
+}
+
+TEST_F(FlagKeyFixture, HashMatchesUthash) {
+    const char  *key;
+    unsigned int expected;
+
+    ASSERT_TRUE(key = LDi_flagKeyIntern(&keys, "some-flag"));
+
+    HASH_VALUE("some-flag", strlen("some-flag"), expected);
+
+    ASSERT_EQ(LDi_flagKeyHash(key), expected);
+    ASSERT_EQ(LDi_flagKeyLength(key), strlen("some-flag"));
+
+    LDi_flagKeyRelease(key);
+}
+
+TEST_F(FlagKeyFixture, AtomLivesUntilLastRelease) {
+    const char *key;
+
+    ASSERT_TRUE(key = LDi_flagKeyIntern(&keys, "alpha"));
+
+    LDi_flagKeyRetain(key);
+    LDi_flagKeyRelease(key);
+
+    ASSERT_EQ(HASH_COUNT(keys.atoms), 1);
+    ASSERT_STREQ(key, "alpha");
+
+    LDi_flagKeyRelease(key);
+
+    ASSERT_EQ(HASH_COUNT(keys.atoms), 0);
+}
+
+TEST_F(FlagKeyFixture, StoreInternsKeys) {
+    struct LDStore      store;
+    struct LDFlag       flag;
+    struct LDStoreNode *node;
+
+    ASSERT_TRUE(LDi_storeInitialize(&store));
+
+    memset(&flag, 0, sizeof(flag));
+    flag.key      = LDStrDup("alpha");
+    flag.value    = LDNewBool(true);
+    flag.variation = 1;
+
+    ASSERT_TRUE(LDi_storeUpsert(&store, flag));
+    ASSERT_TRUE(node = LDi_storeGet(&store, "alpha"));
+
+    ASSERT_EQ(HASH_COUNT(store.keys.atoms), 1);
+    ASSERT_STREQ(node->flag.key, "alpha");
+    ASSERT_EQ(LDi_flagKeyLength(node->flag.key), 5);
+
+    LDi_rc_decrement(&node->rc);
+
+    ASSERT_TRUE(LDi_storeDelete(&store, "alpha", 2));
+    ASSERT_EQ(HASH_COUNT(store.keys.atoms), 1);
+
+    LDi_storeFreeFlags(&store);
+    ASSERT_EQ(HASH_COUNT(store.keys.atoms), 0);
+
+    LDi_storeDestroy(&store);
+}
@@ -5,6 +5,7 @@
 extern "C" {
 #include <launchdarkly/api.h>
 
+#include "flag_key.h"
 #include "ldinternal.h"
 }
 
@@ -43,7 +44,24 @@ static void name(const char* const flagKey, const int status) { spy.record(#name
 static callbackSpy spy;
 
 // Used for unit testing the ChangeListener implementation detail.
-class ChangeListenerFixture : public CommonFixture {};
+class ChangeListenerFixture : public CommonFixture {
+protected:
+    struct LDFlagKeyTable keys;
+    const char *flag1;
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        LD_ASSERT(LDi_flagKeyTableInitialize(&keys));
+        LD_ASSERT(flag1 = LDi_flagKeyIntern(&keys, "flag1"));
+    }
+
+    void TearDown() override {
+        LDi_flagKeyRelease(flag1);
+        LDi_flagKeyTableDestroy(&keys);
+        CommonFixture::TearDown();
+    }
+};
 
 TEST_F(ChangeListenerFixture, TestInitFreeDoesNotLeak) {
     struct ChangeListener *listeners;
@@ -54,14 +72,14 @@ TEST_F(ChangeListenerFixture, TestInitFreeDoesNotLeak) {
 TEST_F(ChangeListenerFixture, TestInsertWithoutDeleteDoesNotLeak) {
     struct ChangeListener *listeners;
     LDi_initListeners(&listeners);
-    LDi_listenerAdd(&listeners, "flag1", nullptr);
+    LDi_listenerAdd(&listeners, flag1, nullptr);
     LDi_freeListeners(&listeners);
 }
 
 TEST_F(ChangeListenerFixture, TestDeleteNoop) {
     struct ChangeListener *listeners;
     LDi_initListeners(&listeners);
-    LDi_listenerRemove(&listeners, "flag1", nullptr);
+    LDi_listenerRemove(&listeners, flag1, nullptr);
     LDi_freeListeners(&listeners);
 }
 
@@ -71,8 +89,8 @@ TEST_F(ChangeListenerFixture, TestDispatchAfterInsert) {
     struct ChangeListener *listeners;
     LDi_initListeners(&listeners);
 
-    LDi_listenerAdd(&listeners, "flag1", testDispatchAfterInsert);
-    LDi_listenersDispatch(listeners, "flag1", 0);
+    LDi_listenerAdd(&listeners, flag1, testDispatchAfterInsert);
+    LDi_listenersDispatch(listeners, flag1, 0);
 
     LDi_freeListeners(&listeners);
 
@@ -89,10 +107,10 @@ TEST_F(ChangeListenerFixture, TestDispatchNoopAfterDelete) {
     struct ChangeListener *listeners;
     LDi_initListeners(&listeners);
 
-    LDi_listenerAdd(&listeners, "flag1", testDispatchAfterDelete);
-    LDi_listenerRemove(&listeners, "flag1", testDispatchAfterDelete);
+    LDi_listenerAdd(&listeners, flag1, testDispatchAfterDelete);
+    LDi_listenerRemove(&listeners, flag1, testDispatchAfterDelete);
 
-    LDi_listenersDispatch(listeners, "flag1", 0);
+    LDi_listenersDispatch(listeners, flag1, 0);
     LDi_freeListeners(&listeners);
 
     ASSERT_TRUE(spy.test("testDispatchAfterDelete").empty());
@@ -105,10 +123,10 @@ TEST_F(ChangeListenerFixture, TestMultiDispatch) {
     struct ChangeListener *listeners;
     LDi_initListeners(&listeners);
 
-    LDi_listenerAdd(&listeners, "flag1", testMultiDispatch1);
-    LDi_listenerAdd(&listeners, "flag1", testMultiDispatch2);
+    LDi_listenerAdd(&listeners, flag1, testMultiDispatch1);
+    LDi_listenerAdd(&listeners, flag1, testMultiDispatch2);
 
-    LDi_listenersDispatch(listeners, "flag1", 0);
+    LDi_listenersDispatch(listeners, flag1, 0);
     LDi_freeListeners(&listeners);
 
     ASSERT_EQ(spy.test("testMultiDispatch1").size(), 1);
@@ -144,6 +162,7 @@ static LDFlag makeFlag(const char* name) {
     struct LDFlag flag;
     flag.key = LDStrDup(name);
     flag.value = LDNewBool(LDBooleanTrue);
+    flag.valueText = NULL;
     flag.version = 2;
     flag.flagVersion = -1;
     flag.variation = 3;
@@ -169,7 +188,7 @@ TEST_F(FlagListenerFixture, TestListenerAddedReceivesCallbacks) {
     LDFlag flag = makeFlag("flag1");
 
     ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
-    ASSERT_TRUE(LDi_storeDelete(&client->store, flag.key, flag.version));
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "flag1", flag.version));
 
     LDClientUnregisterFeatureFlagListener(client, "flag1", listenerAdded);
 
@@ -29,6 +29,7 @@ TEST_F(HooksFixture, BasicHookUpsert) {
 
     flag.key = LDStrDup("test");
     flag.value = LDNewBool(LDBooleanTrue);
+    flag.valueText = NULL;
     flag.version = 2;
     flag.variation = 3;
     flag.trackEvents = LDBooleanFalse;
@@ -65,6 +66,7 @@ TEST_F(HooksFixture, BasicHookPut) {
 
     flag->key = LDStrDup("test");
     flag->value = LDNewBool(LDBooleanTrue);
+    flag->valueText = NULL;
     flag->version = 2;
     flag->variation = 3;
     flag->trackEvents = LDBooleanFalse;
@@ -0,0 +1,158 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "latency.h"
+#include "ldinternal.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class LatencyFixture : public CommonFixture {
+};
+
+static struct LDClient *
+makeClient(const unsigned int sampling)
+{
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDClient *client;
+
+    LD_ASSERT(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetEvaluationLatencySampling(config, sampling);
+
+    LD_ASSERT(user = LDUserNew("test-user"));
+
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    return client;
+}
+
+TEST_F(LatencyFixture, EmptySnapshot) {
+    struct LDLatencyHistogram histogram;
+    struct LDLatencySnapshot snapshot;
+
+    LDi_latencyInitialize(&histogram);
+    LDi_latencySnapshot(&histogram, &snapshot);
+
+    ASSERT_EQ(snapshot.count, 0);
+    ASSERT_EQ(snapshot.p50, 0);
+    ASSERT_EQ(snapshot.p999, 0);
+    ASSERT_EQ(snapshot.max, 0);
+}
+
+TEST_F(LatencyFixture, PercentilesWithinBucketPrecision) {
+    struct LDLatencyHistogram histogram;
+    struct LDLatencySnapshot snapshot;
+    unsigned long i;
+
+    LDi_latencyInitialize(&histogram);
+
+    for (i = 1; i <= 100000; i++) {
+        LDi_latencyRecord(&histogram, i);
+    }
+
+    LDi_latencySnapshot(&histogram, &snapshot);
+
+    ASSERT_EQ(snapshot.count, 100000);
+    ASSERT_EQ(snapshot.max, 100000);
+
+    ASSERT_GE(snapshot.p50, 50000);
+    ASSERT_LE(snapshot.p50, 50000 * 1.125);
+    ASSERT_GE(snapshot.p90, 90000);
+    ASSERT_LE(snapshot.p90, 90000 * 1.125);
+    ASSERT_GE(snapshot.p99, 99000);
+    ASSERT_LE(snapshot.p99, 100000);
+    ASSERT_GE(snapshot.p999, 99900);
+    ASSERT_LE(snapshot.p999, 100000);
+}
+
+TEST_F(LatencyFixture, SmallDurationsAreExact) {
+    struct LDLatencyHistogram histogram;
+    struct LDLatencySnapshot snapshot;
+
+    LDi_latencyInitialize(&histogram);
+
+    LDi_latencyRecord(&histogram, 3);
+    LDi_latencyRecord(&histogram, 3);
+    LDi_latencyRecord(&histogram, 5);
+
+    LDi_latencySnapshot(&histogram, &snapshot);
+
+    ASSERT_EQ(snapshot.p50, 3);
+    ASSERT_EQ(snapshot.p99, 5);
+    ASSERT_EQ(snapshot.max, 5);
+}
+
+TEST_F(LatencyFixture, LongDurationsAreClamped) {
+    struct LDLatencyHistogram histogram;
+    struct LDLatencySnapshot snapshot;
+
+    LDi_latencyInitialize(&histogram);
+
+    LDi_latencyRecord(&histogram, (unsigned long)-1);
+
+    LDi_latencySnapshot(&histogram, &snapshot);
+
+    ASSERT_EQ(snapshot.count, 1);
+    ASSERT_GT(snapshot.p50, 0);
+}
+
+TEST_F(LatencyFixture, SamplesOncePerInterval) {
+    unsigned int i, sampled;
+
+    /* align the countdown of this thread */
+    while (!LDi_latencySample(1)) {}
+
+    for (i = 0, sampled = 0; i < 40; i++) {
+        if (LDi_latencySample(4)) {
+            sampled++;
+        }
+    }
+
+    ASSERT_EQ(sampled, 10);
+}
+
+TEST_F(LatencyFixture, DisabledByDefault) {
+    struct LDClient *client;
+    struct LDEvaluationLatency latency;
+
+    client = makeClient(0);
+
+    LDBoolVariation(client, "flag", LDBooleanFalse);
+
+    ASSERT_FALSE(LDClientGetEvaluationLatency(client, &latency));
+
+    LDClientClose(client);
+}
+
+TEST_F(LatencyFixture, RecordsByVariationType) {
+    struct LDClient *client;
+    struct LDEvaluationLatency latency;
+    char buffer[8];
+    unsigned int i;
+
+    client = makeClient(1);
+
+    for (i = 0; i < 5; i++) {
+        LDBoolVariation(client, "flag", LDBooleanFalse);
+    }
+
+    LDIntVariation(client, "flag", 1);
+    LDDoubleVariation(client, "flag", 1.5);
+    LDStringVariation(client, "flag", "a", buffer, sizeof(buffer));
+
+    ASSERT_TRUE(LDClientGetEvaluationLatency(client, &latency));
+
+    ASSERT_EQ(latency.boolVariations.count, 5);
+    ASSERT_EQ(latency.numberVariations.count, 2);
+    ASSERT_EQ(latency.stringVariations.count, 1);
+    ASSERT_EQ(latency.jsonVariations.count, 0);
+    ASSERT_GT(latency.boolVariations.max, 0);
+    ASSERT_LE(latency.boolVariations.p50, latency.boolVariations.max);
+
+    LDClientClose(client);
+}
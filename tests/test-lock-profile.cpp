@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "ldinternal.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class LockProfileFixture : public CommonFixture {
+};
+
+#ifdef LAUNCHDARKLY_LOCK_PROFILE
+TEST_F(LockProfileFixture, ReportsLabeledLocks) {
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDClient *client;
+    char *report;
+
+    ASSERT_TRUE(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    ASSERT_TRUE(user = LDUserNew("test-user"));
+    ASSERT_TRUE(client = LDClientInit(config, user, 0));
+
+    LDBoolVariation(client, "flag", LDBooleanFalse);
+
+    ASSERT_TRUE(report = LDLockProfileReport(100));
+    ASSERT_TRUE(strstr(report, "store "));
+    ASSERT_TRUE(strstr(report, "events "));
+    ASSERT_TRUE(strstr(report, "sharedUser "));
+    LDFree(report);
+
+    ASSERT_TRUE(report = LDLockProfileReport(1));
+    ASSERT_EQ(strchr(report, '\n'), report + strlen(report) - 1);
+    LDFree(report);
+
+    LDClientClose(client);
+}
+
+TEST_F(LockProfileFixture, CountsContention) {
+    ld_mutex_t mutex;
+    char *report, *line;
+
+    ASSERT_TRUE(LDi_mutex_init(&mutex));
+    LDi_lockProfileLabel(&mutex, "contention-test");
+
+    ASSERT_TRUE(LDi_mutex_lock(&mutex));
+    ASSERT_TRUE(LDi_mutex_unlock(&mutex));
+
+    ASSERT_TRUE(report = LDLockProfileReport(1000));
+    ASSERT_TRUE(line = strstr(report, "contention-test "));
+    ASSERT_TRUE(strstr(line, "acquisitions=1 contended=0 "));
+    LDFree(report);
+
+    ASSERT_TRUE(LDi_mutex_destroy(&mutex));
+}
+
+TEST_F(LockProfileFixture, RelabelingResetsStatistics) {
+    ld_mutex_t mutex;
+    char *report, *line;
+
+    ASSERT_TRUE(LDi_mutex_init(&mutex));
+    LDi_lockProfileLabel(&mutex, "relabel-test");
+
+    ASSERT_TRUE(LDi_mutex_lock(&mutex));
+    ASSERT_TRUE(LDi_mutex_unlock(&mutex));
+    ASSERT_TRUE(LDi_mutex_destroy(&mutex));
+
+    /* a new lock at the same address starts from zero */
+    ASSERT_TRUE(LDi_mutex_init(&mutex));
+    LDi_lockProfileLabel(&mutex, "relabel-test");
+
+    ASSERT_TRUE(LDi_mutex_lock(&mutex));
+    ASSERT_TRUE(LDi_mutex_unlock(&mutex));
+
+    ASSERT_TRUE(report = LDLockProfileReport(1000));
+    ASSERT_TRUE(line = strstr(report, "relabel-test "));
+    ASSERT_TRUE(strstr(line, "acquisitions=1 contended=0 "));
+    LDFree(report);
+
+    ASSERT_TRUE(LDi_mutex_destroy(&mutex));
+}
+#else
+TEST_F(LockProfileFixture, UnavailableWithoutProfiling) {
+    ASSERT_EQ(LDLockProfileReport(10), nullptr);
+}
+#endif
@@ -0,0 +1,198 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+#include <clocale>
+#include <string>
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "ldinternal.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class MetricsFixture : public CommonFixture {
+};
+
+static struct LDClient *
+makeClient(const char *const secondaryName, const unsigned int sampling)
+{
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDClient *client;
+
+    LD_ASSERT(config = LDConfigNew("abc"));
+    LDConfigSetOffline(config, LDBooleanTrue);
+    LDConfigSetEvaluationLatencySampling(config, sampling);
+
+    if (secondaryName) {
+        LD_ASSERT(LDConfigAddSecondaryMobileKey(
+            config, secondaryName, "secondary-key"));
+    }
+
+    LD_ASSERT(user = LDUserNew("test-user"));
+
+    LD_ASSERT(client = LDClientInit(config, user, 0));
+
+    return client;
+}
+
+static std::string
+writeMetrics(struct LDClient *const client)
+{
+    char buffer[16384];
+    size_t length;
+
+    length = LDClientWriteMetrics(client, buffer, sizeof(buffer));
+
+    EXPECT_LT(length, sizeof(buffer));
+    EXPECT_EQ(length, strlen(buffer));
+
+    return std::string(buffer);
+}
+
+TEST_F(MetricsFixture, WritesCounters) {
+    struct LDClient *client;
+    std::string text;
+
+    client = makeClient(NULL, 0);
+
+    LDBoolVariation(client, "a", LDBooleanFalse);
+    LDBoolVariation(client, "b", LDBooleanFalse);
+    LDIntVariation(client, "c", 1);
+
+    text = writeMetrics(client);
+
+    ASSERT_NE(text.find("# TYPE launchdarkly_evaluations counter\n"),
+        std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_evaluations_total"
+        "{environment=\"default\",type=\"bool\"} 2\n"), std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_evaluations_total"
+        "{environment=\"default\",type=\"number\"} 1\n"), std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_evaluation_errors_total"
+        "{environment=\"default\",reason=\"flag_not_found\"} 3\n"),
+        std::string::npos);
+    ASSERT_NE(text.find("# UNIT launchdarkly_sent_bytes bytes\n"),
+        std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_store_flags"
+        "{environment=\"default\"} 0\n"), std::string::npos);
+
+    /* histograms are only written when sampling is enabled */
+    ASSERT_EQ(text.find("launchdarkly_evaluation_duration_seconds"),
+        std::string::npos);
+
+    ASSERT_EQ(text.substr(text.size() - 6), "# EOF\n");
+
+    LDClientClose(client);
+}
+
+TEST_F(MetricsFixture, LabelsEveryEnvironment) {
+    struct LDClient *client, *secondary;
+    std::string text;
+    char buffer[8];
+
+    client = makeClient("second \"env\"", 0);
+
+    ASSERT_TRUE(secondary = LDClientGetForMobileKey("second \"env\""));
+
+    LDStringVariation(secondary, "a", "b", buffer, sizeof(buffer));
+
+    text = writeMetrics(client);
+
+    ASSERT_NE(text.find("launchdarkly_evaluations_total"
+        "{environment=\"default\",type=\"string\"} 0\n"), std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_evaluations_total"
+        "{environment=\"second \\\"env\\\"\",type=\"string\"} 1\n"),
+        std::string::npos);
+
+    /* each family is written once */
+    ASSERT_EQ(text.find("# TYPE launchdarkly_evaluations counter"),
+        text.rfind("# TYPE launchdarkly_evaluations counter"));
+
+    LDClientClose(client);
+}
+
+TEST_F(MetricsFixture, WritesLatencyHistograms) {
+    struct LDClient *client;
+    std::string text;
+
+    client = makeClient(NULL, 1);
+
+    LDBoolVariation(client, "a", LDBooleanFalse);
+    LDBoolVariation(client, "a", LDBooleanFalse);
+
+    text = writeMetrics(client);
+
+    ASSERT_NE(text.find(
+        "# TYPE launchdarkly_evaluation_duration_seconds histogram\n"),
+        std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_evaluation_duration_seconds_bucket"
+        "{environment=\"default\",type=\"bool\",le=\"1.073741823\"} 2\n"),
+        std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_evaluation_duration_seconds_bucket"
+        "{environment=\"default\",type=\"bool\",le=\"+Inf\"} 2\n"),
+        std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_evaluation_duration_seconds_bucket"
+        "{environment=\"default\",type=\"json\",le=\"2.55e-07\"} 0\n"),
+        std::string::npos);
+
+    LDClientClose(client);
+}
+
+/* numbers use a point whatever the locale of the host application */
+TEST_F(MetricsFixture, IgnoresTheLocale) {
+    const char *const locales[] = {
+        "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "German"};
+    struct LDClient *client;
+    std::string text;
+    size_t i;
+
+    for (i = 0; i < sizeof(locales) / sizeof(locales[0]); i++) {
+        if (setlocale(LC_NUMERIC, locales[i])) {
+            break;
+        }
+    }
+
+    /* no locale with a comma is installed */
+    if (i == sizeof(locales) / sizeof(locales[0])) {
+        return;
+    }
+
+    client = makeClient(NULL, 1);
+
+    LDBoolVariation(client, "a", LDBooleanFalse);
+
+    text = writeMetrics(client);
+
+    setlocale(LC_NUMERIC, "C");
+
+    ASSERT_NE(text.find("launchdarkly_evaluation_duration_seconds_bucket"
+        "{environment=\"default\",type=\"bool\",le=\"1.073741823\"} 1\n"),
+        std::string::npos);
+    ASSERT_NE(text.find("launchdarkly_event_flush_duration_seconds"
+        "{environment=\"default\"} 0\n"), std::string::npos);
+
+    LDClientClose(client);
+}
+
+TEST_F(MetricsFixture, TruncatesLikeSnprintf) {
+    struct LDClient *client;
+    std::string text;
+    char small[32];
+    size_t length;
+
+    client = makeClient(NULL, 0);
+
+    text = writeMetrics(client);
+
+    length = LDClientWriteMetrics(client, small, sizeof(small));
+
+    ASSERT_EQ(length, text.size());
+    ASSERT_EQ(strlen(small), sizeof(small) - 1);
+    ASSERT_EQ(text.compare(0, sizeof(small) - 1, small), 0);
+
+    ASSERT_EQ(LDClientWriteMetrics(client, NULL, 0), text.size());
+
+    LDClientClose(client);
+}
@@ -48,6 +48,7 @@ makeMinimalFlag(const char *const key, struct LDJSON *const value) {
 
     flag.key = (char *) key;
     flag.value = value;
+    flag.valueText = NULL;
     flag.version = 3;
     flag.flagVersion = 4;
     flag.variation = 2;
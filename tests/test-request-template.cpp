@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "ldinternal.h"
+#include "request_template.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class RequestTemplateFixture : public CommonFixture {
+};
+
+static size_t
+countHeaders(const struct curl_slist *headers)
+{
+    size_t count;
+
+    for (count = 0; headers; headers = headers->next) {
+        count++;
+    }
+
+    return count;
+}
+
+TEST_F(RequestTemplateFixture, GetRequests) {
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDRequestTemplate *requests;
+
+    ASSERT_TRUE(config = LDConfigNew("key"));
+    ASSERT_TRUE(LDConfigSetAppURI(config, "https://app"));
+    ASSERT_TRUE(LDConfigSetStreamURI(config, "https://stream"));
+    ASSERT_TRUE(LDConfigSetEventsURI(config, "https://events"));
+    LDConfigSetUseEvaluationReasons(config, LDBooleanTrue);
+    ASSERT_TRUE(user = LDUserNew("a"));
+
+    ASSERT_TRUE(requests = LDi_requestTemplateNew(config, "other-key", user));
+
+    ASSERT_STREQ(requests->pollURL,
+        "https://app/msdk/evalx/users/eyJrZXkiOiJhIn0=?withReasons=true");
+    ASSERT_STREQ(requests->streamURL,
+        "https://stream/meval/eyJrZXkiOiJhIn0=?withReasons=true");
+    ASSERT_STREQ(requests->eventsURL, "https://events/mobile");
+    ASSERT_FALSE(requests->reportBody);
+
+    ASSERT_EQ(countHeaders(requests->flagHeaders), 2);
+    ASSERT_STREQ(requests->flagHeaders->data, "Authorization: other-key");
+    ASSERT_EQ(countHeaders(requests->eventHeaders), 4);
+
+    LDi_rc_decrement(&requests->rc);
+    LDUserFree(user);
+    LDConfigFree(config);
+}
+
+TEST_F(RequestTemplateFixture, ReportRequests) {
+    struct LDConfig *config;
+    struct LDUser *user;
+    struct LDRequestTemplate *requests;
+
+    ASSERT_TRUE(config = LDConfigNew("key"));
+    ASSERT_TRUE(LDConfigSetAppURI(config, "https://app"));
+    ASSERT_TRUE(LDConfigSetStreamURI(config, "https://stream"));
+    LDConfigSetUseReport(config, LDBooleanTrue);
+    ASSERT_TRUE(user = LDUserNew("a"));
+
+    ASSERT_TRUE(requests = LDi_requestTemplateNew(config, "key", user));
+
+    ASSERT_STREQ(requests->pollURL, "https://app/msdk/evalx/user");
+    ASSERT_STREQ(requests->streamURL, "https://stream/meval");
+    ASSERT_STREQ(requests->reportBody, "{\"key\":\"a\"}");
+    ASSERT_EQ(requests->reportBodySize, strlen(requests->reportBody));
+    ASSERT_EQ(countHeaders(requests->flagHeaders), 3);
+
+    LDi_rc_decrement(&requests->rc);
+    LDUserFree(user);
+    LDConfigFree(config);
+}
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "ldinternal.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class StatsWithClientFixture : public CommonFixture {
+protected:
+    struct LDClient *client;
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        struct LDConfig *config;
+        struct LDUser *user;
+
+        LD_ASSERT(config = LDConfigNew("abc"));
+        LDConfigSetOffline(config, LDBooleanTrue);
+        LDConfigSetEventsCapacity(config, 3);
+
+        LD_ASSERT(user = LDUserNew("test-user"));
+
+        LD_ASSERT(client = LDClientInit(config, user, 0));
+    }
+
+    void TearDown() override {
+        LDClientClose(client);
+        CommonFixture::TearDown();
+    }
+};
+
+static struct LDFlag
+makeFlag(const char *const key, struct LDJSON *const value)
+{
+    struct LDFlag flag;
+
+    flag.key = LDStrDup(key);
+    flag.value = value;
+    flag.valueText = NULL;
+    flag.version = 1;
+    flag.flagVersion = -1;
+    flag.variation = 0;
+    flag.trackEvents = LDBooleanFalse;
+    flag.trackReason = LDBooleanFalse;
+    flag.reason = NULL;
+    flag.debugEventsUntilDate = 0;
+    flag.deleted = LDBooleanFalse;
+
+    return flag;
+}
+
+TEST_F(StatsWithClientFixture, CountsEvaluations) {
+    struct LDClientStats stats;
+    struct LDJSON *fallback, *result;
+    char buffer[16];
+
+    ASSERT_TRUE(LDi_storeUpsert(
+        &client->store, makeFlag("bool", LDNewBool(LDBooleanTrue))));
+
+    ASSERT_TRUE(LDBoolVariation(client, "bool", LDBooleanFalse));
+    ASSERT_TRUE(LDBoolVariation(client, "bool", LDBooleanFalse));
+    ASSERT_EQ(LDIntVariation(client, "bool", 3), 3);
+    ASSERT_STREQ(LDStringVariation(
+        client, "missing", "a", buffer, sizeof(buffer)), "a");
+
+    ASSERT_TRUE(fallback = LDNewNull());
+    ASSERT_TRUE(result = LDJSONVariation(client, "bool", fallback));
+
+    LDJSONFree(fallback);
+    LDJSONFree(result);
+
+    ASSERT_TRUE(LDClientGetStats(client, &stats));
+
+    ASSERT_EQ(stats.boolEvaluations, 2);
+    ASSERT_EQ(stats.numberEvaluations, 1);
+    ASSERT_EQ(stats.stringEvaluations, 1);
+    ASSERT_EQ(stats.jsonEvaluations, 1);
+    ASSERT_EQ(stats.flagNotFound, 1);
+    ASSERT_EQ(stats.wrongType, 1);
+}
+
+TEST_F(StatsWithClientFixture, CountsQueuedAndDroppedEvents) {
+    struct LDClientStats stats;
+    unsigned long queued;
+
+    ASSERT_TRUE(LDClientGetStats(client, &stats));
+    ASSERT_EQ(stats.eventsDropped, 0);
+
+    queued = stats.eventsQueued;
+
+    LDClientTrack(client, "a");
+    LDClientTrack(client, "b");
+    LDClientTrack(client, "c");
+    LDClientTrack(client, "d");
+
+    ASSERT_TRUE(LDClientGetStats(client, &stats));
+
+    /* the identify event queued on initialization counts toward capacity */
+    ASSERT_EQ(stats.eventsQueued + stats.eventsDropped, queued + 4);
+    ASSERT_EQ(stats.eventsQueued, 3);
+    ASSERT_EQ(stats.eventsFlushed, 0);
+    ASSERT_EQ(stats.flushes, 0);
+}
+
+TEST_F(StatsWithClientFixture, TracksStore) {
+    struct LDClientStats before, after;
+
+    ASSERT_TRUE(LDClientGetStats(client, &before));
+    ASSERT_EQ(before.storeSize, 0);
+
+    ASSERT_TRUE(LDi_storeUpsert(
+        &client->store, makeFlag("a", LDNewBool(LDBooleanTrue))));
+    ASSERT_TRUE(LDi_storeUpsert(
+        &client->store, makeFlag("b", LDNewNumber(2))));
+    ASSERT_TRUE(LDi_storeDelete(&client->store, "a", 2));
+
+    ASSERT_TRUE(LDClientGetStats(client, &after));
+
+    ASSERT_EQ(after.storeSize, 2);
+    ASSERT_EQ(after.storeGeneration, before.storeGeneration + 3);
+}
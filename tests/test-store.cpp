@@ -48,6 +48,7 @@ TEST_F(StoreFixture, RestoreAndSaveBasic) {
 
     flag.key = LDStrDup("test");
     flag.value = LDNewBool(LDBooleanTrue);
+    flag.valueText = NULL;
     flag.version = 2;
     flag.flagVersion = -1;
     flag.variation = 3;
@@ -72,3 +73,76 @@ TEST_F(StoreFixture, RestoreAndSaveBasic) {
     LDFree(bundle1);
     LDFree(bundle2);
 }
+
+static struct LDFlag
+makeFlag(const char *const key, const unsigned int version, const double value)
+{
+    struct LDFlag flag;
+
+    flag.key = LDStrDup(key);
+    flag.value = LDNewNumber(value);
+    flag.valueText = NULL;
+    flag.version = version;
+    flag.flagVersion = -1;
+    flag.variation = 0;
+    flag.trackEvents = LDBooleanFalse;
+    flag.trackReason = LDBooleanFalse;
+    flag.reason = NULL;
+    flag.debugEventsUntilDate = 0;
+    flag.deleted = LDBooleanFalse;
+
+    return flag;
+}
+
+TEST_F(StoreFixture, UpsertBatch) {
+    struct LDFlag flags[4];
+    struct LDStoreNode *node;
+
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, makeFlag("a", 5, 1)));
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, makeFlag("b", 5, 1)));
+
+    /* older than the stored version so ignored */
+    flags[0] = makeFlag("a", 4, 2);
+    flags[1] = makeFlag("b", 6, 2);
+    flags[2] = makeFlag("c", 1, 2);
+    ASSERT_TRUE(LDi_flag_tombstone(&flags[3], "c", 2));
+
+    ASSERT_TRUE(LDi_storeUpsertBatch(&client->store, flags, 4));
+
+    ASSERT_TRUE(node = LDi_storeGet(&client->store, "a"));
+    ASSERT_EQ(LDGetNumber(node->flag.value), 1);
+    LDi_rc_decrement(&node->rc);
+
+    ASSERT_TRUE(node = LDi_storeGet(&client->store, "b"));
+    ASSERT_EQ(LDGetNumber(node->flag.value), 2);
+    LDi_rc_decrement(&node->rc);
+
+    ASSERT_FALSE(LDi_storeGet(&client->store, "c"));
+}
+
+static int batchListenerCalls;
+
+static void
+batchListener(const char *const flagKey, const int status)
+{
+    batchListenerCalls++;
+
+    ASSERT_STREQ(flagKey, "a");
+    ASSERT_EQ(status, 0);
+}
+
+TEST_F(StoreFixture, UpsertBatchNotifiesOncePerKey) {
+    struct LDFlag flags[2];
+
+    batchListenerCalls = 0;
+
+    ASSERT_TRUE(LDClientRegisterFeatureFlagListener(
+        client, "a", batchListener));
+
+    flags[0] = makeFlag("a", 1, 1);
+    flags[1] = makeFlag("a", 2, 2);
+
+    ASSERT_TRUE(LDi_storeUpsertBatch(&client->store, flags, 2));
+
+    ASSERT_EQ(batchListenerCalls, 1);
+}
@@ -0,0 +1,279 @@
+#include "gtest/gtest.h"
+#include "commonfixture.h"
+
+extern "C" {
+#include <launchdarkly/api.h>
+
+#include "atomic.h"
+#include "timer.h"
+#include "utility.h"
+}
+
+// Inherit from the CommonFixture to give a reasonable name for the test output.
+// Any custom setup and teardown would happen in this derived class.
+class TimerFixture : public CommonFixture {
+protected:
+    struct LDTimerWheel wheel;
+
+    void SetUp() override {
+        CommonFixture::SetUp();
+
+        ASSERT_TRUE(LDi_timerWheelStart(&wheel));
+    }
+
+    void TearDown() override {
+        LDi_timerWheelStop(&wheel);
+        CommonFixture::TearDown();
+    }
+};
+
+struct TimerRecord {
+    ld_atomic_t *calls;
+    ld_atomic_t *order;
+    long position;
+    double firedAt;
+};
+
+static void
+recordTimer(void *const context)
+{
+    struct TimerRecord *const record = (struct TimerRecord *)context;
+
+    record->position = LDi_atomicIncrement(record->order);
+    LDi_getMonotonicMilliseconds(&record->firedAt);
+    LDi_atomicIncrement(record->calls);
+}
+
+static void
+awaitCalls(ld_atomic_t *const calls, const long expected)
+{
+    int i;
+
+    for (i = 0; i < 500 && LDi_atomicLoad(calls) < expected; i++) {
+        LDi_sleepMilliseconds(10);
+    }
+
+    ASSERT_EQ(LDi_atomicLoad(calls), expected);
+}
+
+TEST_F(TimerFixture, RunsInDeadlineOrder) {
+    ld_atomic_t calls = 0, order = 0;
+    struct TimerRecord records[3];
+    struct LDTimer timers[3];
+    double started;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        records[i].calls = &calls;
+        records[i].order = &order;
+        LDi_timerInitialize(&timers[i], recordTimer, &records[i], NULL);
+    }
+
+    ASSERT_TRUE(LDi_getMonotonicMilliseconds(&started));
+
+    LDi_timerStart(&wheel, &timers[0], 90);
+    LDi_timerStart(&wheel, &timers[1], 30);
+    LDi_timerStart(&wheel, &timers[2], 60);
+
+    awaitCalls(&calls, 3);
+
+    /* before anything returns, the timers are on this stack */
+    for (i = 0; i < 3; i++) {
+        LDi_timerCancelAndWait(&wheel, &timers[i]);
+    }
+
+    ASSERT_EQ(records[1].position, 1);
+    ASSERT_EQ(records[2].position, 2);
+    ASSERT_EQ(records[0].position, 3);
+
+    ASSERT_GE(records[0].firedAt - started, 90);
+}
+
+TEST_F(TimerFixture, CascadesLongerDelays) {
+    ld_atomic_t calls = 0, order = 0;
+    struct TimerRecord record;
+    struct LDTimer timer;
+    double started;
+
+    record.calls = &calls;
+    record.order = &order;
+    LDi_timerInitialize(&timer, recordTimer, &record, NULL);
+
+    ASSERT_TRUE(LDi_getMonotonicMilliseconds(&started));
+
+    /* beyond the first level */
+    LDi_timerStart(&wheel, &timer, 750);
+
+    awaitCalls(&calls, 1);
+
+    LDi_timerCancelAndWait(&wheel, &timer);
+
+    ASSERT_GE(record.firedAt - started, 750);
+    ASSERT_LT(record.firedAt - started, 1000);
+}
+
+TEST_F(TimerFixture, CancelsAndReschedules) {
+    ld_atomic_t calls = 0, order = 0;
+    struct TimerRecord records[2];
+    struct LDTimer cancelled, rescheduled;
+
+    records[0].calls = records[1].calls = &calls;
+    records[0].order = records[1].order = &order;
+    LDi_timerInitialize(&cancelled, recordTimer, &records[0], NULL);
+    LDi_timerInitialize(&rescheduled, recordTimer, &records[1], NULL);
+
+    LDi_timerStart(&wheel, &cancelled, 20);
+    LDi_timerCancel(&wheel, &cancelled);
+
+    LDi_timerStart(&wheel, &rescheduled, 60000);
+    LDi_timerStart(&wheel, &rescheduled, 20);
+    /* already pending */
+    LDi_timerStartIfIdle(&wheel, &rescheduled, 60000);
+
+    awaitCalls(&calls, 1);
+
+    LDi_sleepMilliseconds(50);
+
+    EXPECT_FALSE(cancelled.pending);
+    EXPECT_FALSE(rescheduled.pending);
+
+    LDi_timerCancelAndWait(&wheel, &cancelled);
+    LDi_timerCancelAndWait(&wheel, &rescheduled);
+
+    ASSERT_EQ(LDi_atomicLoad(&calls), 1);
+    ASSERT_EQ(records[1].position, 1);
+}
+
+TEST_F(TimerFixture, CoalescesTimersWithTheSameKey) {
+    ld_atomic_t calls = 0, order = 0;
+    struct TimerRecord record;
+    struct LDTimer first, second, exact;
+
+    record.calls = &calls;
+    record.order = &order;
+    LDi_timerInitialize(&first, recordTimer, &record, "https://host");
+    LDi_timerInitialize(&second, recordTimer, &record, "https://host");
+    LDi_timerInitialize(&exact, recordTimer, &record, NULL);
+
+    /* a second of ticks has a slack of 62, aligned to 32 */
+    LDi_timerStart(&wheel, &exact, 10000);
+    LDi_timerStart(&wheel, &first, 10000);
+    LDi_timerStart(&wheel, &second, 10000);
+
+    if (first.deadline != second.deadline) {
+        /* the tick changed between them, they are one apart */
+        LDi_timerStart(&wheel, &first, 10000);
+    }
+
+    EXPECT_EQ(first.deadline, second.deadline);
+    EXPECT_GE(first.deadline, exact.deadline);
+    EXPECT_LE(first.deadline, exact.deadline + 32);
+
+    LDi_timerCancelAndWait(&wheel, &first);
+    LDi_timerCancelAndWait(&wheel, &second);
+    LDi_timerCancelAndWait(&wheel, &exact);
+}
+
+TEST_F(TimerFixture, StartBeforeNeverPostpones) {
+    ld_atomic_t calls = 0, order = 0;
+    struct TimerRecord record;
+    struct LDTimer timer;
+    double started;
+    int i;
+
+    record.calls = &calls;
+    record.order = &order;
+    LDi_timerInitialize(&timer, recordTimer, &record, NULL);
+
+    ASSERT_TRUE(LDi_getMonotonicMilliseconds(&started));
+
+    LDi_timerStartBefore(&wheel, &timer, 60000);
+    /* earlier, so moved */
+    LDi_timerStartBefore(&wheel, &timer, 200);
+
+    /* later, so ignored however often it is asked. well short of the
+    deadline, as once the timer has fired this would start it again */
+    for (i = 0; i < 10 && LDi_atomicLoad(&calls) == 0; i++) {
+        LDi_timerStartBefore(&wheel, &timer, 200);
+        LDi_sleepMilliseconds(10);
+    }
+
+    awaitCalls(&calls, 1);
+
+    LDi_timerCancelAndWait(&wheel, &timer);
+
+    ASSERT_GE(record.firedAt - started, 200);
+    ASSERT_LT(record.firedAt - started, 380);
+}
+
+static void
+sleepingTimer(void *const context)
+{
+    ld_atomic_t *const state = (ld_atomic_t *)context;
+
+    LDi_atomicStore(state, 1);
+    LDi_sleepMilliseconds(100);
+    LDi_atomicStore(state, 2);
+}
+
+TEST_F(TimerFixture, CancelAndWaitWaitsForCallback) {
+    ld_atomic_t state = 0;
+    struct LDTimer timer;
+    int i;
+
+    LDi_timerInitialize(&timer, sleepingTimer, &state, NULL);
+
+    LDi_timerStart(&wheel, &timer, 0);
+
+    for (i = 0; i < 500 && LDi_atomicLoad(&state) == 0; i++) {
+        LDi_sleepMilliseconds(1);
+    }
+
+    EXPECT_EQ(LDi_atomicLoad(&state), 1);
+
+    /* running, so not started again */
+    LDi_timerStartIfIdle(&wheel, &timer, 0);
+
+    LDi_timerCancelAndWait(&wheel, &timer);
+
+    ASSERT_EQ(LDi_atomicLoad(&state), 2);
+    ASSERT_FALSE(timer.pending);
+}
+
+struct RepeatingTimer {
+    struct LDTimerWheel *wheel;
+    struct LDTimer timer;
+    ld_atomic_t calls;
+};
+
+static void
+repeatingTimer(void *const context)
+{
+    struct RepeatingTimer *const repeating = (struct RepeatingTimer *)context;
+
+    if (LDi_atomicIncrement(&repeating->calls) < 3) {
+        LDi_timerStart(repeating->wheel, &repeating->timer, 10);
+    }
+}
+
+TEST_F(TimerFixture, CallbackMayScheduleItself) {
+    struct RepeatingTimer repeating;
+    long calls;
+
+    repeating.wheel = &wheel;
+    repeating.calls = 0;
+    LDi_timerInitialize(
+        &repeating.timer, repeatingTimer, &repeating, NULL);
+
+    LDi_timerStart(&wheel, &repeating.timer, 0);
+
+    awaitCalls(&repeating.calls, 3);
+
+    LDi_sleepMilliseconds(30);
+
+    calls = LDi_atomicLoad(&repeating.calls);
+
+    LDi_timerCancelAndWait(&wheel, &repeating.timer);
+
+    ASSERT_EQ(calls, 3);
+}
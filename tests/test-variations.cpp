@@ -101,6 +101,7 @@ TEST_F(VariationsWithClientFixture, JSONVariationDefault) {
 static LDFlag &fillFlag(LDJSON *const value, LDFlag &flag) {
     flag.key = LDStrDup("test");
     flag.value = value;
+    flag.valueText = NULL;
     flag.version = 2;
     flag.flagVersion = -1;
     flag.variation = 3;
@@ -176,6 +177,31 @@ TEST_F(VariationsWithClientFixture, JSONVariation) {
     LDJSONFree(result);
 }
 
+TEST_F(VariationsWithClientFixture, JSONVariationNestedIsModifiable) {
+    struct LDFlag flag;
+    fillFlag(LDJSONDeserialize("{\"a\": {\"b\": [1]}}"), flag);
+    ASSERT_TRUE(LDi_storeUpsert(&client->store, flag));
+
+    struct LDJSON *fallback, *result, *nested, *again;
+
+    ASSERT_TRUE(fallback = LDNewNull());
+
+    ASSERT_TRUE(result = LDJSONVariation(client, "test", fallback));
+
+    ASSERT_TRUE(nested = LDObjectLookup(result, "a"));
+    ASSERT_TRUE(LDObjectSetKey(nested, "c", LDNewNull()));
+    ASSERT_TRUE(LDArrayPush(LDObjectLookup(nested, "b"), LDNewNumber(2)));
+    ASSERT_TRUE(LDSetNumber(LDArrayLookup(LDObjectLookup(nested, "b"), 0), 3));
+
+    /* the stored value is untouched */
+    ASSERT_TRUE(again = LDJSONVariation(client, "test", fallback));
+    ASSERT_EQ(LDCollectionGetSize(LDObjectLookup(again, "a")), 1);
+
+    LDJSONFree(fallback);
+    LDJSONFree(result);
+    LDJSONFree(again);
+}
+
 TEST_F(VariationsWithClientAndDetail, BoolVariationDetailDefault) {
     ASSERT_FALSE(LDBoolVariationDetail(client, "test", LDBooleanFalse, &details));
 }